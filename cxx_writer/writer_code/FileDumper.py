@@ -151,6 +151,7 @@ class Folder:
         self.subfolders = []
         self.mainFile = ''
         self.uselib_local = []
+        self.translatedCode = False
 
     def addHeader(self, header):
         self.headers.append(header)
@@ -161,6 +162,11 @@ class Folder:
     def setMain(self, mainFile):
         self.mainFile = mainFile
 
+    def setTranslatedCode(self):
+        """The main program is compiled together with the code translated
+        ahead of time from the application, when it is configured"""
+        self.translatedCode = True
+
     def addCode(self, codeFile):
         self.codeFiles.append(codeFile)
 
@@ -230,6 +236,9 @@ class Folder:
                 printOnFile('    \"\"\"', wscriptFile)
                 if tests:
                     printOnFile('    uselib = \'TRAP BOOST BOOST_TEST ELF_LIB SYSTEMC TLM\'', wscriptFile)
+                elif self.uselib_local:
+                    # Programs linked with the objects of another folder
+                    printOnFile('    uselib = \'TRAP BOOST ELF_LIB SYSTEMC TLM\'', wscriptFile)
                 else:
                     printOnFile('    uselib = \'BOOST SYSTEMC TLM TRAP\'', wscriptFile)
                 if self.uselib_local:
@@ -251,6 +260,9 @@ class Folder:
 
             if self.mainFile:
                 printOnFile('    sources = \'' + self.mainFile + '\'', wscriptFile)
+                if self.translatedCode and not tests:
+                    printOnFile('    if bld.env[\'TRANSLATED_CODE\']:', wscriptFile)
+                    printOnFile('        sources = [sources, bld.root.find_node(bld.env[\'TRANSLATED_CODE\'])]', wscriptFile)
                 printOnFile('    includes = \'.\'', wscriptFile)
                 if tests:
                     printOnFile('    uselib = \'TRAP BOOST BOOST_TEST ELF_LIB SYSTEMC TLM\'', wscriptFile)
@@ -484,6 +496,16 @@ class Folder:
         ctx.env['FULLSTATIC'] = True
     if ctx.options.enable_history:
         ctx.env.append_unique('DEFINES', 'ENABLE_HISTORY')
+    if ctx.options.enable_perf_counters:
+        ctx.env.append_unique('DEFINES', 'ENABLE_PERF_COUNTERS')
+    if ctx.options.enable_native_memory:
+        ctx.env.append_unique('DEFINES', 'TRAP_NATIVE_MEMORY')
+    if ctx.options.translated_code:
+        translatedCode = os.path.abspath(os.path.expanduser(ctx.options.translated_code))
+        if not os.path.exists(translatedCode):
+            ctx.fatal('Translated code ' + translatedCode + ' does not exist')
+        ctx.env['TRANSLATED_CODE'] = translatedCode
+        ctx.env.append_unique('DEFINES', 'TRAP_TRANSLATED_CODE')
 
     ########################################
     # Adding the custom preprocessor macros
@@ -928,6 +950,31 @@ class Folder:
             int sc_main(int argc, char ** argv){return 0;}
 ''', msg='Check for TRAP version', use='TRAP ELF_LIB BOOST SYSTEMC', mandatory=1, errmsg='Error, at least revision ' + str(trapRevisionNum) + ' required')
 
+    ##################################################
+    # Check for zlib, used to compress the binary
+    # instruction traces
+    ##################################################
+    if ctx.check_cxx(lib='z', header_name='zlib.h', uselib_store='TRAP', mandatory=0):
+        ctx.env.append_unique('DEFINES', 'HAVE_ZLIB')
+
+    ##################################################
+    # Compilation at run time of the code executed
+    # most often: the host compiler is called with the
+    # same flags used for the simulator
+    ##################################################
+    if ctx.options.enable_jit:
+        ctx.check_cxx(lib='dl', uselib_store='TRAP', mandatory=1)
+        jitCommand = [ctx.env['CXX'][0], '-O2', '-fPIC', '-shared'] + ctx.env['CXXFLAGS']
+        jitFlags = ['-D' + define for define in ctx.env['DEFINES']]
+        for uselib in ['TRAP', 'ELF_LIB', 'BOOST', 'SYSTEMC', 'TLM']:
+            jitFlags += ['-D' + define for define in ctx.env['DEFINES_' + uselib]]
+            jitFlags += ['-I' + include for include in ctx.env['INCLUDES_' + uselib]]
+        jitCommand += ["'" + flag + "'" for flag in jitFlags]
+        ctx.define('TRAP_JIT_COMPILER', ' '.join(jitCommand))
+        ctx.define('TRAP_JIT_SOURCE_DIR', ctx.path.abspath())
+        ctx.env.append_unique('DEFINES', 'TRAP_JIT')
+        ctx.env.append_unique('LINKFLAGS', '-rdynamic')
+
 """, wscriptFile)
             # Finally now I can add the options
             printOnFile('def options(ctx):', wscriptFile)
@@ -956,6 +1003,14 @@ class Folder:
     ctx.add_option('-T', '--disable-tools', default=True, action="store_false", help='Disables support for support tools (debuger, os-emulator, etc.) (switch)', dest='enable_tools')
     # Specify if instruction history has to be kept
     ctx.add_option('-s', '--enable-history', default=False, action='store_true', help='Enables the history of executed instructions', dest='enable_history')
+    # Specify if the performance counters of the simulator have to be collected
+    ctx.add_option('--enable-perf-counters', default=False, action='store_true', help='Enables the collection of simulator performance counters and phase timing', dest='enable_perf_counters')
+    # Specify if the local memory of big endian processors keeps the words in host order (only aligned accesses are allowed)
+    ctx.add_option('--enable-native-memory', default=False, action='store_true', help='Keeps the words of the local memory in host order, avoiding the endianess conversions of big endian processors (aligned accesses only)', dest='enable_native_memory')
+    # Specify the code translated ahead of time from the application (see the translator program)
+    ctx.add_option('--with-translated-code', type='string', help='Compiles the simulator with the specified translated application', dest='translated_code')
+    # Specify if the code executed most often has to be compiled at run time
+    ctx.add_option('--enable-jit', default=False, action='store_true', help='Enables the compilation at run time of the code executed most often', dest='enable_jit')
     # Specify support for the profilers: gprof, vprof
     ctx.add_option('-P', '--gprof', default=False, action='store_true', help='Enables profiling with gprof profiler', dest='enable_gprof')
     ctx.add_option('-V', '--vprof', default=False, action='store_true', help='Enables profiling with vprof profiler', dest='enable_vprof')
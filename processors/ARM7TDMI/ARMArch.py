@@ -88,6 +88,26 @@ processor.addRegBank(spsrBank)
 cpsrBitMask = {'N': (31, 31), 'Z': (30, 30), 'C': (29, 29), 'V': (28, 28), 'I': (7, 7), 'F': (6, 6), 'mode': (0, 3)}
 cpsr = trap.Register('CPSR', 32, cpsrBitMask)
 cpsr.setDefaultValue(0x000000D3)
+# The condition codes are computed only when they are read, from the
+# last operation updating them and its operands
+cpsr.setLazyFields(['N', 'Z', 'C', 'V'])
+cpsr.addLazyOperation('ADD', """long long resultSign = (long long)((long long)((int)operand1) + (long long)((int)operand2)) + (long long)((int)operand3);
+N = ((resultSign & 0x0000000080000000LL) != 0);
+Z = (resultSign == 0);
+C = (((operand1 ^ operand2 ^ ((unsigned int)(resultSign >> 1))) & 0x80000000) != 0);
+V = ((((unsigned int)(resultSign >> 1)) ^ ((unsigned int)resultSign)) & 0x80000000) != 0;
+""")
+cpsr.addLazyOperation('SUB', """long long resultSign = (long long)((long long)((int)operand1) - (long long)((int)operand2)) - (long long)((int)operand3);
+N = ((resultSign & 0x0000000080000000LL) != 0);
+Z = (resultSign == 0);
+C = (((operand1 ^ operand2 ^ ((unsigned int)(resultSign >> 1))) & 0x80000000) == 0);
+V = ((((unsigned int)(resultSign >> 1)) ^ ((unsigned int)resultSign)) & 0x80000000) != 0;
+""")
+# Logical operations do not update the V flag
+cpsr.addLazyOperation('LOGIC', """N = ((operand1 & 0x80000000) != 0);
+Z = (operand1 == 0);
+C = (operand2 != 0);
+""", ['N', 'Z', 'C'])
 processor.addRegister(cpsr)
 # Fake register (not presented in the architecture) indicating
 # the processor ID: it is necessary in a multi-processor
@@ -100,6 +120,10 @@ processor.addRegister(mp_id)
 # responsibility of the programmer keeping the alias updated
 regs = trap.AliasRegBank('REGS', 16, 'RB[0-15]')
 regs.setOffset(15, 4)
+# The banked registers are reached through two windows on RB: the mode
+# switches simply move the base of the windows
+regs.addWindow(8, 12, 'RB')
+regs.addWindow(13, 14, 'RB')
 processor.addAliasRegBank(regs)
 FP = trap.AliasRegister('FP', 'REGS[11]')
 processor.addAliasReg(FP)
@@ -145,8 +169,12 @@ LR_IRQ = PC;
 SPSR[1] = CPSR;
 //I switch the register bank (i.e. I update the
 //alias)
+#ifndef ACC_MODEL
+REGS[13].updateWindow(21);
+#else
 REGS[13].updateAlias(RB[21]);
 REGS[14].updateAlias(RB[22]);
+#endif
 //Create the new PSR
 CPSR = (CPSR & 0xFFFFFFD0) | 0x00000092;
 //Finally I update the PC
@@ -160,6 +188,10 @@ LR_FIQ = PC;
 SPSR[0] = CPSR;
 //I switch the register bank (i.e. I update the
 //alias)
+#ifndef ACC_MODEL
+REGS[8].updateWindow(23);
+REGS[13].updateWindow(28);
+#else
 REGS[8].updateAlias(RB[23]);
 REGS[9].updateAlias(RB[24]);
 REGS[10].updateAlias(RB[25]);
@@ -167,6 +199,7 @@ REGS[11].updateAlias(RB[26]);
 REGS[12].updateAlias(RB[27]);
 REGS[13].updateAlias(RB[28]);
 REGS[14].updateAlias(RB[29]);
+#endif
 //Create the new PSR
 CPSR = (CPSR & 0xFFFFFFD0) | 0x000000D1;
 //Finally I update the PC
@@ -82,47 +82,23 @@ RotateRight_method.addVariable(('rotated', 'BIT<32>'))
 RotateRight_method.addVariable(('toGlue', 'BIT<32>'))
 
 opCode = cxx_writer.writer_code.Code("""
-long long resultSign = (long long)((long long)((int)operand1) + (long long)((int)operand2)) + (long long)((int)carry);
-
-// N flag if the results is negative
-CPSR[key_N] = ((resultSign & 0x0000000080000000LL) != 0);
-
-//Update flag Z if the result is 0
-CPSR[key_Z] = (resultSign == 0);
-
-//Update the C resultUnSign if a carry occurred in the operation
-CPSR[key_C] = (((operand1 ^ operand2 ^ ((unsigned int)(resultSign >> 1))) & 0x80000000) != 0);
-
-//Update the V flag if an overflow occurred in the operation
-CPSR[key_V] = ((((unsigned int)(resultSign >> 1)) ^ ((unsigned int)resultSign)) & 0x80000000) != 0;
+// The flags are computed when the CPSR is read
+CPSR.setLazy(lazy_ADD, operand1, operand2, carry);
 """)
 UpdatePSRAdd_method = trap.HelperMethod('UpdatePSRAddInner', opCode, 'execute')
 UpdatePSRAdd_method.setSignature(parameters = [('operand1', 'BIT<32>'), ('operand2', 'BIT<32>'), ('carry', 'BIT<1>')])
 
 opCode = cxx_writer.writer_code.Code("""
-long long resultSign = (long long)((long long)((int)operand1) - (long long)((int)operand2)) - (long long)((int)carry);
-//unsigned long long resultUnSign = (unsigned long long)((unsigned long long)operand1 - (unsigned long long)operand2);
-// N flag if the results is negative
-CPSR[key_N] = ((resultSign & 0x0000000080000000LL) != 0);
-//Update flag Z if the result is 0
-CPSR[key_Z] = (resultSign == 0);
-//Update the C flag if a borrow didn't occurr in the operation
-//operand2 = (int)-operand2;
-CPSR[key_C] = (((operand1 ^ operand2 ^ ((unsigned int)(resultSign >> 1))) & 0x80000000) == 0);
-//Update the V flag if an overflow occurred in the operation
-CPSR[key_V] = ((((unsigned int)(resultSign >> 1)) ^ ((unsigned int)resultSign)) & 0x80000000) != 0;
+// The flags are computed when the CPSR is read
+CPSR.setLazy(lazy_SUB, operand1, operand2, carry);
 """)
 UpdatePSRSub_method = trap.HelperMethod('UpdatePSRSubInner', opCode, 'execute')
 UpdatePSRSub_method.setSignature(parameters = [('operand1', 'BIT<32>'), ('operand2', 'BIT<32>'), ('carry', 'BIT<1>')])
 
 opCode = cxx_writer.writer_code.Code("""
-// N flag if the results is negative
-CPSR[key_N] = ((result & 0x80000000) != 0);
-//Update flag Z if the result is 0
-CPSR[key_Z] = (result == 0);
-//Update the C flag if a carry occurred in the operation
-CPSR[key_C] = (carry != 0);
-//No updates performed to the V flag.
+// N, Z and C flags are computed when the CPSR is read; no updates
+// performed to the V flag.
+CPSR.setLazy(lazy_LOGIC, result, carry, 0);
 """)
 UpdatePSRBitM_method = trap.HelperMethod('UpdatePSRBitM', opCode, 'execute')
 UpdatePSRBitM_method.setSignature(parameters = [('result', 'BIT<32>'), ('carry', 'BIT<1>')])
@@ -211,6 +187,45 @@ updateAliases(curMode, CPSR[key_mode]);
 """)
 restoreSPSR_method = trap.HelperMethod('restoreSPSR', opCode, 'execute')
 opCode = cxx_writer.writer_code.Code("""
+#ifndef ACC_MODEL
+//The banked registers are reached through the windows on RB
+//starting at REGS[8] and REGS[13]: we simply move them
+switch(toMode){
+    case 0x0:
+    case 0xF:{
+        //User or System mode
+        REGS[13].updateWindow(13);
+    break;}
+    case 0x2:{
+        //IRQ mode
+        REGS[13].updateWindow(21);
+    break;}
+    case 0x1:{
+        //FIQ mode
+        REGS[8].updateWindow(23);
+        REGS[13].updateWindow(28);
+    break;}
+    case 0x3:{
+        //SVC mode
+        REGS[13].updateWindow(15);
+    break;}
+    case 0x7:{
+        //ABT mode
+        REGS[13].updateWindow(17);
+    break;}
+    case 0xB:{
+        //UND mode
+        REGS[13].updateWindow(19);
+    break;}
+    default:{
+        THROW_EXCEPTION("Not valid toMode " << toMode << " when changing the registers");
+    break;}
+}
+
+if(fromMode == 0x1 && toMode != 0x1){
+    REGS[8].updateWindow(8);
+}
+#else
 switch(toMode){
     case 0x0:
     case 0xF:{
@@ -260,6 +275,7 @@ if(fromMode == 0x1 && toMode != 0x1){
     REGS[11].updateAlias(RB[11]);
     REGS[12].updateAlias(RB[12]);
 }
+#endif
 """)
 updateAlias_method = trap.HelperMethod('updateAliases', opCode, 'execute')
 updateAlias_method.setSignature(parameters = [cxx_writer.writer_code.Parameter('fromMode', cxx_writer.writer_code.uintType), cxx_writer.writer_code.Parameter('toMode', cxx_writer.writer_code.uintType)])
@@ -95,6 +95,25 @@ psrBitMask = {'IMPL': (28, 31), 'VER': (24, 27), 'ICC_n': (23, 23), 'ICC_z': (22
 psrReg = trap.Register('PSR', 32, psrBitMask)
 psrReg.setDefaultValue(0xF3000080)
 #psrReg.setDelay(3)
+# The integer condition codes are computed only when they are read, from
+# the last operation updating them and its operands (operand1 and operand2
+# are the source operands, operand3 the result)
+psrReg.setLazyFields(['ICC_n', 'ICC_z', 'ICC_v', 'ICC_c'])
+psrReg.addLazyOperation('ICC_LOGIC', """ICC_n = ((operand3 & 0x80000000) >> 31);
+ICC_z = (operand3 == 0);
+ICC_v = 0;
+ICC_c = 0;
+""")
+psrReg.addLazyOperation('ICC_ADD', """ICC_n = ((operand3 & 0x80000000) >> 31);
+ICC_z = (operand3 == 0);
+ICC_v = ((unsigned int)((operand1 & operand2 & (~operand3)) | ((~operand1) & (~operand2) & operand3))) >> 31;
+ICC_c = ((unsigned int)((operand1 & operand2) | ((operand1 | operand2) & (~operand3)))) >> 31;
+""")
+psrReg.addLazyOperation('ICC_SUB', """ICC_n = ((operand3 & 0x80000000) >> 31);
+ICC_z = (operand3 == 0);
+ICC_v = ((unsigned int)((operand1 & (~operand2) & (~operand3)) | ((~operand1) & operand2 & operand3))) >> 31;
+ICC_c = ((unsigned int)(((~operand1) & operand2) | (((~operand1) | operand2) & operand3))) >> 31;
+""")
 processor.addRegister(psrReg)
 # Window Invalid Mask Register
 wimBitMask = {}
@@ -140,6 +159,9 @@ processor.addRegBank(asrRegs)
 regs = trap.AliasRegBank('REGS', 32, ('GLOBAL[0-7]', 'WINREGS[0-23]'))
 regs.setFixed([0, 1, 2, 3, 4, 5, 6, 7])
 regs.setCheckGroup()
+# The windowed registers are reached through a window on WINREGS: changing
+# the current window simply moves its base
+regs.addWindow(8, 31, 'WINREGS')
 processor.addAliasRegBank(regs)
 FP = trap.AliasRegister('FP', 'REGS[30]')
 FP.setFixed()
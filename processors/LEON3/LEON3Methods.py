@@ -16,10 +16,15 @@ from LEONDefs import *
 
 def updateAliasCode_abi():
     return """
+    #ifndef ACC_MODEL
+    //ABI model: we simply immediately move the register window
+    REGS[8].updateWindow((newCwp*16) % (""" + str(16*numRegWindows) + """));
+    #else
     //ABI model: we simply immediately update the alias
     for(int i = 8; i < 32; i++){
         REGS[i].updateAlias(WINREGS[(newCwp*16 + i - 8) % (""" + str(16*numRegWindows) + """)]);
     }
+    #endif
     """
 
 def updateAliasCode_decode():
@@ -30,10 +35,8 @@ def updateAliasCode_decode():
         modCode = '% ' + str(16*numRegWindows)
 
     code = """#ifndef ACC_MODEL
-    //Functional model: we simply immediately update the alias
-    for(int i = 8; i < 32; i++){
-        REGS[i].updateAlias(WINREGS[(newCwp*16 + i - 8) """ + modCode + """]);
-    }
+    //Functional model: we simply immediately move the register window
+    REGS[8].updateWindow((newCwp*16) """ + modCode + """);
     #else
     //Cycle accurate model: we have to update the alias using the pipeline register
     //We update the aliases for this stage and for all the preceding ones (we are in the
@@ -54,10 +57,8 @@ def updateAliasCode_exception():
         modCode = '% ' + str(16*numRegWindows)
 
     code = """#ifndef ACC_MODEL
-    //Functional model: we simply immediately update the alias
-    for(int i = 8; i < 32; i++){
-        REGS[i].updateAlias(WINREGS[(newCwp*16 + i - 8) """ + modCode + """]);
-    }
+    //Functional model: we simply immediately move the register window
+    REGS[8].updateWindow((newCwp*16) """ + modCode + """);
     #else
     //Cycle accurate model: we have to update the alias using the pipeline register
     //We update the aliases for this stage and for all the preceding ones (we are in the
@@ -350,10 +351,7 @@ WB_tv.addUserInstructionElement('rd')
 # Modification of the Integer Condition Codes of the Processor Status Register
 # after an logical operation or after the multiply operation
 opCode = cxx_writer.writer_code.Code("""
-PSR[key_ICC_n] = ((result & 0x80000000) >> 31);
-PSR[key_ICC_z] = (result == 0);
-PSR[key_ICC_v] = 0;
-PSR[key_ICC_c] = 0;
+PSR.setLazy(lazy_ICC_LOGIC, 0, 0, result);
 """)
 ICC_writeLogic = trap.HelperOperation('ICC_writeLogic', opCode, exception = False)
 ICC_writeLogic.addInstuctionVar(('result', 'BIT<32>'))
@@ -361,10 +359,7 @@ ICC_writeLogic.addInstuctionVar(('result', 'BIT<32>'))
 # Modification of the Integer Condition Codes of the Processor Status Register
 # after an addition operation
 opCode = cxx_writer.writer_code.Code("""
-PSR[key_ICC_n] = ((result & 0x80000000) >> 31);
-PSR[key_ICC_z] = (result == 0);
-PSR[key_ICC_v] = ((unsigned int)((rs1_op & rs2_op & (~result)) | ((~rs1_op) & (~rs2_op) & result))) >> 31;
-PSR[key_ICC_c] = ((unsigned int)((rs1_op & rs2_op) | ((rs1_op | rs2_op) & (~result)))) >> 31;
+PSR.setLazy(lazy_ICC_ADD, rs1_op, rs2_op, result);
 """)
 ICC_writeAdd = trap.HelperOperation('ICC_writeAdd', opCode, exception = False)
 ICC_writeAdd.addInstuctionVar(('result', 'BIT<32>'))
@@ -419,10 +414,7 @@ ICC_writeTVAdd.addInstuctionVar(('rs2_op', 'BIT<32>'))
 # Modification of the Integer Condition Codes of the Processor Status Register
 # after a subtraction operation
 opCode = cxx_writer.writer_code.Code("""
-PSR[key_ICC_n] = ((result & 0x80000000) >> 31);
-PSR[key_ICC_z] = (result == 0);
-PSR[key_ICC_v] = ((unsigned int)((rs1_op & (~rs2_op) & (~result)) | ((~rs1_op) & rs2_op & result))) >> 31;
-PSR[key_ICC_c] = ((unsigned int)(((~rs1_op) & rs2_op) | (((~rs1_op) | rs2_op) & result))) >> 31;
+PSR.setLazy(lazy_ICC_SUB, rs1_op, rs2_op, result);
 """)
 ICC_writeSub = trap.HelperOperation('ICC_writeSub', opCode, exception = False)
 ICC_writeSub.addInstuctionVar(('result', 'BIT<32>'))
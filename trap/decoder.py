@@ -433,7 +433,7 @@ class decoderCreator:
         code += ';\n}\n}\n'
         return code
 
-    def getCPPClass(self, fetchSizeType, instructionCache, namespace = ''):
+    def getCPPClass(self, fetchSizeType, instructionCache, namespace = '', fusedInstructions = False):
         """Creates the representation of the decoder as a C++ class"""
         import cxx_writer
         from isa import resolveBitType
@@ -454,12 +454,21 @@ class decoderCreator:
             instrAttr = cxx_writer.writer_code.Attribute('instr', IntructionTypePtr, 'pu')
             countAttr = cxx_writer.writer_code.Attribute('count', cxx_writer.writer_code.uintType, 'pu')
             cacheTypeElements = [instrAttr, countAttr]
+            instrInit = ['instr(instr)', 'count(count)']
+            emptyInit = ['instr(NULL)', 'count(1)']
+            if fusedInstructions:
+                # Superinstruction starting with the cached instruction, if any
+                FusedTypePtr = cxx_writer.writer_code.Type('FusedInstruction', 'instructions.hpp').makePointer()
+                fusedAttr = cxx_writer.writer_code.Attribute('fused', FusedTypePtr, 'pu')
+                cacheTypeElements.append(fusedAttr)
+                instrInit.append('fused(NULL)')
+                emptyInit.append('fused(NULL)')
             cacheType = cxx_writer.writer_code.ClassDeclaration('CacheElem', cacheTypeElements, namespaces = [namespace])
             instrParam = cxx_writer.writer_code.Parameter('instr', IntructionTypePtr)
             countParam = cxx_writer.writer_code.Parameter('count', cxx_writer.writer_code.uintType)
-            cacheTypeConstr = cxx_writer.writer_code.Constructor(emptyBody, 'pu', [instrParam, countParam], ['instr(instr)', 'count(count)'])
+            cacheTypeConstr = cxx_writer.writer_code.Constructor(emptyBody, 'pu', [instrParam, countParam], instrInit)
             cacheType.addConstructor(cacheTypeConstr)
-            emptyCacheTypeConstr = cxx_writer.writer_code.Constructor(emptyBody, 'pu', [], ['instr(NULL)', 'count(1)'])
+            emptyCacheTypeConstr = cxx_writer.writer_code.Constructor(emptyBody, 'pu', [], emptyInit)
             cacheType.addConstructor(emptyCacheTypeConstr)
 
         if instructionCache:
@@ -467,6 +476,28 @@ class decoderCreator:
         else:
             return [decodeClass]
 
+    def getBenchmarkWords(self):
+        """Returns one instruction word for each of the instructions
+        recognized by the decoder, used for benchmarking it; the
+        non-care bits are set to 0, so that the words do not change
+        among different generations of the simulator"""
+        words = []
+        for instrId in sorted(self.instrId.keys()):
+            if instrId == -1:
+                continue
+            pattern = self.instrId[instrId][0]
+            if isinstance(pattern[0], list):
+                pattern = pattern[0]
+            bits = []
+            for bit in pattern:
+                if bit == None:
+                    bits.append('0')
+                else:
+                    bits.append(str(bit))
+            bits.reverse()
+            words.append(int(''.join(bits), 2))
+        return words
+
     def getCPPTests(self, namespace = ''):
         """Creates the tests for the decoder; I normally create the
         tests with boost_test_framework.
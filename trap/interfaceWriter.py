@@ -386,7 +386,7 @@ def getCPPIf(self, model, namespace):
         else:
             for memName, mem_range in self.abi.memories.items():
                 readMemBody += 'if(address >= ' + hex(mem_range[0]) + ' && address <= ' + hex(mem_range[1]) + '){\n'
-                readMemBody += 'return this->' + self.abi.memories.keys()[0] + '.read_word_dbg(address);\n}\nelse '
+                readMemBody += 'return this->' + memName + '.read_word_dbg(address);\n}\nelse '
             readMemBody += '{\nTHROW_EXCEPTION(\"Address \" << std::hex << address << \" out of range\");\n}'
     readMemCode = cxx_writer.writer_code.Code(readMemBody)
     readMemParam1 = cxx_writer.writer_code.Parameter('address', wordType.makeRef().makeConst())
@@ -402,7 +402,7 @@ def getCPPIf(self, model, namespace):
         else:
             for memName, mem_range in self.abi.memories.items():
                 readByteMemBody += 'if(address >= ' + hex(mem_range[0]) + ' && address <= ' + hex(mem_range[1]) + '){\n'
-                readByteMemBody += 'return this->' + self.abi.memories.keys()[0] + '.read_byte_dbg(address);\n}\nelse '
+                readByteMemBody += 'return this->' + memName + '.read_byte_dbg(address);\n}\nelse '
             readByteMemBody += '{\nTHROW_EXCEPTION(\"Address \" << std::hex << address << \" out of range\");\n}'
     readByteMemCode = cxx_writer.writer_code.Code(readByteMemBody)
     readByteMemParam = cxx_writer.writer_code.Parameter('address', wordType.makeRef().makeConst())
@@ -418,7 +418,7 @@ def getCPPIf(self, model, namespace):
         else:
             for memName, mem_range in self.abi.memories.items():
                 writeMemBody += 'if(address >= ' + hex(mem_range[0]) + ' && address <= ' + hex(mem_range[1]) + '){\n'
-                writeMemBody += 'this->' + self.abi.memories.keys()[0] + '.write_word_dbg(address, datum);\n}\nelse '
+                writeMemBody += 'this->' + memName + '.write_word_dbg(address, datum);\n}\nelse '
             writeMemBody += '{\nTHROW_EXCEPTION(\"Address \" << std::hex << address << \" out of range\");\n}'
     writeMemCode = cxx_writer.writer_code.Code(writeMemBody)
     writeMemCode.addInclude('trap_utils.hpp')
@@ -435,7 +435,7 @@ def getCPPIf(self, model, namespace):
         else:
             for memName, mem_range in self.abi.memories.items():
                 writeMemBody += 'if(address >= ' + hex(mem_range[0]) + ' && address <= ' + hex(mem_range[1]) + '){\n'
-                writeMemBody += 'this->' + self.abi.memories.keys()[0] + '.write_byte_dbg(address, datum);\n}\nelse '
+                writeMemBody += 'this->' + memName + '.write_byte_dbg(address, datum);\n}\nelse '
             writeMemBody += '{\nTHROW_EXCEPTION(\"Address \" << std::hex << address << \" out of range\");\n}'
     writeMemCode = cxx_writer.writer_code.Code(writeMemBody)
     writeMemParam1 = cxx_writer.writer_code.Parameter('address', wordType.makeRef().makeConst())
@@ -443,6 +443,48 @@ def getCPPIf(self, model, namespace):
     writeMemMethod = cxx_writer.writer_code.Method('writeCharMem', writeMemCode, cxx_writer.writer_code.voidType, 'pu', [writeMemParam1, writeMemParam2])
     ifClassElements.append(writeMemMethod)
 
+    # Block accesses are forwarded to the memory in a single call; blocks
+    # crossing the boundary between two memories are transferred byte by byte
+    if self.abi.memories:
+        readBlockBody = ''
+        writeBlockBody = ''
+        if len(self.abi.memories) == 1:
+            readBlockBody += 'this->' + self.abi.memories.keys()[0] + '.read_block_dbg(address, buffer, length);'
+            writeBlockBody += 'this->' + self.abi.memories.keys()[0] + '.write_block_dbg(address, buffer, length);'
+        else:
+            for memName, mem_range in self.abi.memories.items():
+                readBlockBody += 'if(address >= ' + hex(mem_range[0]) + ' && length > 0 && address + length - 1 <= ' + hex(mem_range[1]) + '){\n'
+                readBlockBody += 'this->' + memName + '.read_block_dbg(address, buffer, length);\n}\nelse '
+                writeBlockBody += 'if(address >= ' + hex(mem_range[0]) + ' && length > 0 && address + length - 1 <= ' + hex(mem_range[1]) + '){\n'
+                writeBlockBody += 'this->' + memName + '.write_block_dbg(address, buffer, length);\n}\nelse '
+            readBlockBody += '{\nfor(unsigned int i = 0; i < length; i++){\nbuffer[i] = this->readCharMem(address + i);\n}\n}'
+            writeBlockBody += '{\nfor(unsigned int i = 0; i < length; i++){\nthis->writeCharMem(address + i, buffer[i]);\n}\n}'
+        addressParam = cxx_writer.writer_code.Parameter('address', wordType.makeRef().makeConst())
+        lengthParam = cxx_writer.writer_code.Parameter('length', cxx_writer.writer_code.uintType)
+        bufferParam = cxx_writer.writer_code.Parameter('buffer', cxx_writer.writer_code.ucharPtrType)
+        readBlockMethod = cxx_writer.writer_code.Method('readMemBlock', cxx_writer.writer_code.Code(readBlockBody), cxx_writer.writer_code.voidType, 'pu', [addressParam, bufferParam, lengthParam])
+        ifClassElements.append(readBlockMethod)
+        bufferParam = cxx_writer.writer_code.Parameter('buffer', cxx_writer.writer_code.ucharPtrType.makeConst())
+        writeBlockMethod = cxx_writer.writer_code.Method('writeMemBlock', cxx_writer.writer_code.Code(writeBlockBody), cxx_writer.writer_code.voidType, 'pu', [addressParam, bufferParam, lengthParam])
+        ifClassElements.append(writeBlockMethod)
+        # End of the memories whose size is known: the local memory and the
+        # ones with an address range; the others are read byte by byte
+        memoryLimitBody = ''
+        if len(self.abi.memories) == 1:
+            memName, mem_range = self.abi.memories.items()[0]
+            if mem_range:
+                memoryLimitBody = 'return ' + hex(mem_range[1]) + ';'
+            elif self.memory and self.memory[0] == memName:
+                memoryLimitBody = 'return ' + hex(self.memory[1] - 1) + ';'
+        else:
+            for memName, mem_range in self.abi.memories.items():
+                memoryLimitBody += 'if(address >= ' + hex(mem_range[0]) + ' && address <= ' + hex(mem_range[1]) + '){\n'
+                memoryLimitBody += 'return ' + hex(mem_range[1]) + ';\n}\n'
+            memoryLimitBody += 'return address;'
+        if memoryLimitBody:
+            memoryLimitMethod = cxx_writer.writer_code.Method('getMemoryLimit', cxx_writer.writer_code.Code(memoryLimitBody), wordType, 'pu', [addressParam])
+            ifClassElements.append(memoryLimitMethod)
+
     getInstructionHistoryCode = cxx_writer.writer_code.Code('return this->instHistoryQueue;')
     getInstructionHistoryMethod = cxx_writer.writer_code.Method('getInstructionHistory', getInstructionHistoryCode, histQueueType.makeRef(), 'pu')
     ifClassElements.append(getInstructionHistoryMethod)
@@ -72,8 +72,8 @@ def getGetIRQInstr(self, model, trace, namespace):
                         behaviorCode += '#undef ' + reg.name + '\n'
             if model.startswith('acc'):
                 behaviorCode += 'return this->stageCycles;\n\n'
-                registerType = cxx_writer.writer_code.Type('Register')
-                unlockQueueType = cxx_writer.writer_code.TemplateType('std::map', ['unsigned int', cxx_writer.writer_code.TemplateType('std::vector', [registerType.makePointer()], 'vector')], 'map')
+                from pipelineWriter import getUnlockQueueType
+                unlockQueueType = getUnlockQueueType(self)
                 unlockQueueParam = cxx_writer.writer_code.Parameter('unlockQueue', unlockQueueType.makeRef())
                 behaviorBody = cxx_writer.writer_code.Code(behaviorCode)
                 behaviorDecl = cxx_writer.writer_code.Method('behavior_' + pipeStage.name, behaviorBody, cxx_writer.writer_code.uintType, 'pu', [unlockQueueParam])
@@ -86,8 +86,10 @@ def getGetIRQInstr(self, model, trace, namespace):
 
         # Standard Instruction methods, there is not much to do since the IRQ instruction does nothing special
         from procWriter import baseInstrInitElement
-        replicateBody = cxx_writer.writer_code.Code('return new IRQ_' + irq.name + '_Instruction(' + baseInstrInitElement + ', this->' + irq.name + ');')
-        replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', noException = True, const = True)
+        from isaWriter import getReplicateParams
+        (replicateParams, replicateNew) = getReplicateParams(self, model)
+        replicateBody = cxx_writer.writer_code.Code('return ' + replicateNew + 'IRQ_' + irq.name + '_Instruction(' + baseInstrInitElement + ', this->' + irq.name + ');')
+        replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', replicateParams, noException = True, const = True)
         IRQInstrElements.append(replicateDecl)
         setparamsParam = cxx_writer.writer_code.Parameter('bitString', self.bitSizes[1].makeRef().makeConst())
         setparamsDecl = cxx_writer.writer_code.Method('setParams', emptyBody, cxx_writer.writer_code.voidType, 'pu', [setparamsParam], noException = True)
@@ -97,6 +97,9 @@ class ISA:
         self.traceRegs = []
         # Behavior of the NOP operation; used only in the cycle accurate processor
         self.nopBeh = {}
+        # Sequences of instructions (lists of names) which are executed fused
+        # together in a single superinstruction by the functional processors
+        self.superInstructions = []
 
     def setNOPBehavior(self, behavior, stage):
         self.nopBeh[stage] = behavior
@@ -151,6 +154,37 @@ class ISA:
                 raise Exception('Operation ' + operation.name + ' already added to the ISA')
         self.endOp = operation
 
+    def addSuperInstruction(self, instructions):
+        """Declares a sequence of instructions, identified by their names, which
+        often follows one another at consecutive addresses: the functional
+        processors execute such sequences back to back in a single superinstruction,
+        whose components are decoded only once"""
+        if len(instructions) < 2:
+            raise Exception('A superinstruction must be composed of at least two instructions')
+        if list(instructions) in self.superInstructions:
+            raise Exception('Superinstruction ' + '_'.join(instructions) + ' already added to the ISA')
+        self.superInstructions.append(list(instructions))
+
+    def loadSuperInstructions(self, pairsFileName, maxNumber = 16, minShare = 1.0):
+        """Reads the statistics on the pairs of instructions executed one after the
+        other which are dumped by the profiler (the _pairs.csv file) and declares
+        a superinstruction for each of the most frequent pairs: at most maxNumber
+        pairs are chosen, among the ones covering at least minShare percent of
+        the executed instructions"""
+        pairsFile = open(pairsFileName, 'r')
+        pairs = []
+        for line in pairsFile.readlines()[1:]:
+            fields = line.strip().split(';')
+            if len(fields) < 4:
+                continue
+            if float(fields[3]) >= minShare:
+                pairs.append((long(fields[2]), fields[0], fields[1]))
+        pairsFile.close()
+        pairs.sort(reverse = True)
+        for numCalls, first, second in pairs[:maxNumber]:
+            if self.instructions.has_key(first) and self.instructions.has_key(second) and not [first, second] in self.superInstructions:
+                self.addSuperInstruction([first, second])
+
     def computeCoding(self):
         """for each instruction it puts together the machine code
         and the identifier bits to create the instruction bitstring"""
@@ -45,6 +45,16 @@ archWordType = None
 alreadyDeclared = []
 baseInstrConstrParams = []
 
+def getReplicateParams(processor, model):
+    """Returns the parameters of the replicate method and the new expression
+    used by it: in the functional processors the instructions kept in the
+    instruction cache are allocated in an arena (see InstructionArena)"""
+    from procWriter import hasInstructionArena
+    if hasInstructionArena(processor, model):
+        arenaType = cxx_writer.writer_code.Type('InstructionArena', 'instructionArena.hpp')
+        return ([cxx_writer.writer_code.Parameter('arena', arenaType.makePointer(), initValue = 'NULL')], 'new (arena) ')
+    return ([], 'new ')
+
 def getToUnlockRegs(self, processor, pipeStage, getAll, delayedUnlock):
     code = ''
     regsToUnlock = []
@@ -469,8 +479,8 @@ def getCPPInstr(self, model, processor, trace, combinedTrace, namespace):
                     behaviorCode += '#undef ' + instrFieldName + '\n'
 
             behaviorCode += 'return this->stageCycles;\n\n'
-            registerType = cxx_writer.writer_code.Type('Register')
-            unlockQueueType = cxx_writer.writer_code.TemplateType('std::map', ['unsigned int', cxx_writer.writer_code.TemplateType('std::vector', [registerType.makePointer()], 'vector')], 'map')
+            from pipelineWriter import getUnlockQueueType
+            unlockQueueType = getUnlockQueueType(processor)
             unlockQueueParam = cxx_writer.writer_code.Parameter('unlockQueue', unlockQueueType.makeRef())
             behaviorBody = cxx_writer.writer_code.Code(behaviorCode)
             behaviorDecl = cxx_writer.writer_code.Method('behavior_' + pipeStage.name, behaviorBody, cxx_writer.writer_code.uintType, 'pu', [unlockQueueParam])
@@ -561,11 +571,12 @@ def getCPPInstr(self, model, processor, trace, combinedTrace, namespace):
                             else:
                                 regsToCheck.append(regToCheck + '_' + pipeName)
 
+                # Since isLocked has no side effects, the check stops at the first locked register
                 for regToCheck in regsToCheck:
-                    checkHazardCode += 'regLocked = this->' + regToCheck + '.isLocked() || regLocked;\n'
+                    checkHazardCode += 'regLocked = regLocked || this->' + regToCheck + '.isLocked();\n'
 
                 if self.customCheckHazardOp.has_key(pipeStage.name):
-                    checkHazardCode += 'regLocked = ' + self.customCheckHazardOp[pipeStage.name] + ' || regLocked;\n'
+                    checkHazardCode += 'regLocked = regLocked || ' + self.customCheckHazardOp[pipeStage.name] + ';\n'
 
                 checkHazardCode += 'return !regLocked;\n'
                 checkHazardBody = cxx_writer.writer_code.Code(checkHazardCode)
@@ -616,8 +627,9 @@ def getCPPInstr(self, model, processor, trace, combinedTrace, namespace):
                     getUnlockDecl = cxx_writer.writer_code.Method('getUnlock_' + pipeStage.name, getUnlockBody, cxx_writer.writer_code.voidType, 'pu', [unlockQueueParam])
                     classElements.append(getUnlockDecl)
 
-    replicateBody = cxx_writer.writer_code.Code('return new ' + self.name + '(' + baseInstrInitElement + ');')
-    replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', noException = True, const = True)
+    (replicateParams, replicateNew) = getReplicateParams(processor, model)
+    replicateBody = cxx_writer.writer_code.Code('return ' + replicateNew + self.name + '(' + baseInstrInitElement + ');')
+    replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', replicateParams, noException = True, const = True)
     classElements.append(replicateDecl)
     getIstructionNameBody = cxx_writer.writer_code.Code('return \"' + self.name + '\";')
     getIstructionNameDecl = cxx_writer.writer_code.Method('getInstructionName', getIstructionNameBody, cxx_writer.writer_code.stringType, 'pu', noException = True, const = True)
@@ -733,40 +745,22 @@ def getCPPInstr(self, model, processor, trace, combinedTrace, namespace):
         if not var.name in behVars:
             classElements.append(cxx_writer.writer_code.Attribute(var.name, var.varType, 'pro',  var.static))
 
-    # Finally now I have to override the basic new operator in
-    # order to speed up memory allocation (***** Commented since it does not give any speedup ******)
-    #num_allocated = processor.alloc_buffer_size*self.frequency
-    #poolDecl = cxx_writer.writer_code.Variable(self.name + '_pool[' + str(num_allocated) + '*sizeof(' + self.name + ')]', cxx_writer.writer_code.ucharType, namespaces = [namespace])
-    #operatorNewCode = """
-    #if(""" + self.name + """::allocated < """ + str(num_allocated) + """){
-        #""" + self.name + """::allocated++;
-        #return """ + self.name + """_pool + (""" + self.name + """::allocated - 1)*sizeof(""" + self.name + """);
-    #}
-    #else{
-        #void * newMem = ::malloc(bytesToAlloc);
-        #if(newMem == NULL)
-            #throw std::bad_alloc();
-        #return newMem;
-    #}
-    #"""
-    #operatorNewBody =  cxx_writer.writer_code.Code(operatorNewCode)
-    #operatorNewBody.addInclude('cstddef')
-    #operatorNewBody.addInclude('cstdlib')
-    #operatorNewBody.addInclude('new')
-    #operatorNewParams = [cxx_writer.writer_code.Parameter('bytesToAlloc', cxx_writer.writer_code.Type('std::size_t'))]
-    #operatorNewDecl = cxx_writer.writer_code.MemberOperator('new', operatorNewBody, cxx_writer.writer_code.voidPtrType, 'pu', operatorNewParams)
-    #classElements.append(operatorNewDecl)
-    #operatorDelCode = """
-        #if(m != NULL && (m < """ + self.name + """_pool || m > (""" + self.name + """_pool + """ + str(num_allocated - 1) + """*sizeof(""" + self.name + """)))){
-            #::free(m);
-        #}
-    #"""
-    #operatorDelBody =  cxx_writer.writer_code.Code(operatorDelCode)
-    #operatorDelParams = [cxx_writer.writer_code.Parameter('m', cxx_writer.writer_code.voidPtrType)]
-    #operatorDelDecl = cxx_writer.writer_code.MemberOperator('delete', operatorDelBody, cxx_writer.writer_code.voidType, 'pu', operatorDelParams)
-    #classElements.append(operatorDelDecl)
-    #num_allocatedAttribute = cxx_writer.writer_code.Attribute('allocated', cxx_writer.writer_code.uintType, 'pri', initValue = '0', static = True)
-    #classElements.append(num_allocatedAttribute)
+    # Finally now I have to override the basic new operator in order to speed up memory
+    # allocation: in the cycle accurate processors the instructions already in the pipeline
+    # are replicated at every fetch and destroyed when they leave the pipeline; their
+    # memory is recycled through a free list, instead of going through the heap every time
+    if model.startswith('acc'):
+        operatorNewBody = cxx_writer.writer_code.Code('return ' + self.name + '::pool.allocate(bytesToAlloc);')
+        operatorNewParams = [cxx_writer.writer_code.Parameter('bytesToAlloc', cxx_writer.writer_code.Type('std::size_t', 'cstddef'))]
+        operatorNewDecl = cxx_writer.writer_code.MemberOperator('new', operatorNewBody, cxx_writer.writer_code.voidPtrType, 'pu', operatorNewParams, static = True)
+        classElements.append(operatorNewDecl)
+        operatorDelBody = cxx_writer.writer_code.Code(self.name + '::pool.release(m, bytesToFree);')
+        operatorDelParams = [cxx_writer.writer_code.Parameter('m', cxx_writer.writer_code.voidPtrType), cxx_writer.writer_code.Parameter('bytesToFree', cxx_writer.writer_code.Type('std::size_t', 'cstddef'))]
+        operatorDelDecl = cxx_writer.writer_code.MemberOperator('delete', operatorDelBody, cxx_writer.writer_code.voidType, 'pu', operatorDelParams, static = True, noException = True)
+        classElements.append(operatorDelDecl)
+        freeListType = cxx_writer.writer_code.TemplateType('FreeList', [self.name], 'freeList.hpp')
+        poolAttribute = cxx_writer.writer_code.Attribute('pool', freeListType, 'pri', static = True)
+        classElements.append(poolAttribute)
 
     ########################## TODO: to eliminate, only for statistics ####################
     #out_poolAttribute = cxx_writer.writer_code.Attribute('allocatedOut', cxx_writer.writer_code.uintType, 'pri', static = True)
@@ -897,6 +891,18 @@ def getCPPInstrTest(self, processor, model, trace, combinedTrace, namespace = ''
                 else:
                     aliasInit += alias.name + '[' + str(curIndex) + '].updateAlias(' + curAlias + ');\n'
                     curIndex += 1
+        try:
+            windows = alias.windows
+        except AttributeError:
+            windows = []
+        if windows:
+            from procWriter import getAliasWindowsCode
+            tables, bases, windowsCode = getAliasWindowsCode(processor, alias, '')
+            for tableName, tableSize in tables:
+                aliasInit += namespace + '::Register * ' + tableName + '[' + str(tableSize) + '];\n'
+            for baseName, initBase in bases:
+                aliasInit += 'unsigned int ' + baseName + ';\n'
+            aliasInit += windowsCode
     tests = []
     for test in self.tests:
         # First of all I create the instance of the instruction and of all the
@@ -967,8 +973,9 @@ def getCPPInstrTest(self, processor, model, trace, combinedTrace, namespace = ''
 def getCPPClasses(self, processor, model, trace, combinedTrace, namespace):
     """I go over each instruction and print the class representing it"""
     memoryType = cxx_writer.writer_code.Type('MemoryInterface', 'memory.hpp')
-    registerType = cxx_writer.writer_code.Type('Register')
-    unlockQueueType = cxx_writer.writer_code.TemplateType('std::map', ['unsigned int', cxx_writer.writer_code.TemplateType('std::vector', [registerType.makePointer()], 'vector')], 'map')
+    if model.startswith('acc'):
+        from pipelineWriter import getUnlockQueueType
+        unlockQueueType = getUnlockQueueType(processor)
 
     classes = []
     # Now I add the custon definitions
@@ -988,8 +995,24 @@ def getCPPClasses(self, processor, model, trace, combinedTrace, namespace):
         for pipeStage in processor.pipes:
             behaviorDecl = cxx_writer.writer_code.Method('behavior_' + pipeStage.name, emptyBody, cxx_writer.writer_code.uintType, 'pu', [unlockQueueParam], pure = True)
             instructionElements.append(behaviorDecl)
-    replicateDecl = cxx_writer.writer_code.Method('replicate', emptyBody, instructionType.makePointer(), 'pu', pure = True, noException = True, const = True)
+    (replicateParams, replicateNew) = getReplicateParams(processor, model)
+    replicateDecl = cxx_writer.writer_code.Method('replicate', emptyBody, instructionType.makePointer(), 'pu', replicateParams, pure = True, noException = True, const = True)
     instructionElements.append(replicateDecl)
+    from procWriter import hasInstructionArena
+    if hasInstructionArena(processor, model):
+        # The instructions are allocated either on the heap or, when they are added to
+        # the instruction cache, in the arena of the processor: the arena keeps track
+        # of where each of them is, so that they are all deleted in the same way
+        sizeParam = cxx_writer.writer_code.Parameter('bytesToAlloc', cxx_writer.writer_code.Type('std::size_t', 'cstddef'))
+        arenaParam = cxx_writer.writer_code.Parameter('arena', cxx_writer.writer_code.Type('InstructionArena', 'instructionArena.hpp').makePointer())
+        voidParam = cxx_writer.writer_code.Parameter('m', cxx_writer.writer_code.voidPtrType)
+        operatorNewBody = cxx_writer.writer_code.Code('return InstructionArena::allocate(bytesToAlloc, NULL);')
+        instructionElements.append(cxx_writer.writer_code.MemberOperator('new', operatorNewBody, cxx_writer.writer_code.voidPtrType, 'pu', [sizeParam], static = True))
+        operatorNewBody = cxx_writer.writer_code.Code('return InstructionArena::allocate(bytesToAlloc, arena);')
+        instructionElements.append(cxx_writer.writer_code.MemberOperator('new', operatorNewBody, cxx_writer.writer_code.voidPtrType, 'pu', [sizeParam, arenaParam], static = True))
+        operatorDelBody = cxx_writer.writer_code.Code('InstructionArena::release(m);')
+        instructionElements.append(cxx_writer.writer_code.MemberOperator('delete', operatorDelBody, cxx_writer.writer_code.voidType, 'pu', [voidParam], static = True, noException = True))
+        instructionElements.append(cxx_writer.writer_code.MemberOperator('delete', operatorDelBody, cxx_writer.writer_code.voidType, 'pu', [voidParam, arenaParam], static = True, noException = True))
     setparamsParam = cxx_writer.writer_code.Parameter('bitString', processor.bitSizes[1].makeRef().makeConst())
     setparamsDecl = cxx_writer.writer_code.Method('setParams', emptyBody, cxx_writer.writer_code.voidType, 'pu', [setparamsParam], pure = True, noException = True)
     instructionElements.append(setparamsDecl)
@@ -1093,6 +1116,35 @@ def getCPPClasses(self, processor, model, trace, combinedTrace, namespace):
         printTraceBody = cxx_writer.writer_code.Code(printTraceCode)
         printTraceDecl = cxx_writer.writer_code.Method('printTrace', printTraceBody, cxx_writer.writer_code.voidType, 'pu')
         instructionElements.append(printTraceDecl)
+        if not model.startswith('acc'):
+            # Binary version of the trace: the same registers are stored through
+            # a BinaryTraceWriter, which only records the ones which changed
+            if self.traceRegs:
+                bankNames = [i.name for i in processor.regBanks + processor.aliasRegBanks]
+                tracedRegs = [(reg.name, reg.name in bankNames and reg.numRegs or 0) for reg in self.traceRegs]
+            else:
+                tracedRegs = [(reg.name, 0) for reg in processor.regs] + [(regB.name, regB.numRegs) for regB in processor.regBanks]
+            traceRegistersCode = ''
+            traceNamesCode = 'std::vector<std::string> regNames;\n'
+            regIndex = 0
+            for regName, numRegs in tracedRegs:
+                if numRegs > 0:
+                    traceRegistersCode += 'for(int regNum = 0; regNum < ' + str(numRegs) + '; regNum++){\n'
+                    traceRegistersCode += 'writer.traceRegister(' + str(regIndex) + ' + regNum, this->' + regName + '[regNum]);\n}\n'
+                    traceNamesCode += 'for(int regNum = 0; regNum < ' + str(numRegs) + '; regNum++){\n'
+                    traceNamesCode += 'regNames.push_back("' + regName + '[" + boost::lexical_cast<std::string>(regNum) + "]");\n}\n'
+                    regIndex += numRegs
+                else:
+                    traceRegistersCode += 'writer.traceRegister(' + str(regIndex) + ', this->' + regName + ');\n'
+                    traceNamesCode += 'regNames.push_back("' + regName + '");\n'
+                    regIndex += 1
+            traceNamesCode += 'return regNames;\n'
+            traceWriterParam = cxx_writer.writer_code.Parameter('writer', cxx_writer.writer_code.Type('BinaryTraceWriter', 'binaryTrace.hpp').makeRef())
+            traceRegistersDecl = cxx_writer.writer_code.Method('traceRegisters', cxx_writer.writer_code.Code(traceRegistersCode), cxx_writer.writer_code.voidType, 'pu', [traceWriterParam])
+            instructionElements.append(traceRegistersDecl)
+            traceNamesType = cxx_writer.writer_code.TemplateType('std::vector', [cxx_writer.writer_code.stringType], 'vector')
+            traceNamesDecl = cxx_writer.writer_code.Method('getTraceRegisterNames', cxx_writer.writer_code.Code(traceNamesCode), traceNamesType, 'pu', const = True)
+            instructionElements.append(traceNamesDecl)
         # Now we have to print the method for creating the data hazards
         if model.startswith('acc'):
             printBusyRegsDecl = cxx_writer.writer_code.Method('printBusyRegs', emptyBody, cxx_writer.writer_code.stringType, 'pu', pure = True)
@@ -1325,8 +1377,8 @@ def getCPPClasses(self, processor, model, trace, combinedTrace, namespace):
         behaviorDecl = cxx_writer.writer_code.Method('behavior', behaviorBody, cxx_writer.writer_code.uintType, 'pu')
         invalidInstrElements.append(behaviorDecl)
     from procWriter import baseInstrInitElement
-    replicateBody = cxx_writer.writer_code.Code('return new InvalidInstr(' + baseInstrInitElement + ');')
-    replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', noException = True, const = True)
+    replicateBody = cxx_writer.writer_code.Code('return ' + replicateNew + 'InvalidInstr(' + baseInstrInitElement + ');')
+    replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', replicateParams, noException = True, const = True)
     invalidInstrElements.append(replicateDecl)
     setparamsParam = cxx_writer.writer_code.Parameter('bitString', processor.bitSizes[1].makeRef().makeConst())
     setparamsDecl = cxx_writer.writer_code.Method('setParams', emptyBody, cxx_writer.writer_code.voidType, 'pu', [setparamsParam], noException = True)
@@ -1365,6 +1417,53 @@ def getCPPClasses(self, processor, model, trace, combinedTrace, namespace):
     invalidInstrDecl.addDestructor(publicDestr)
     classes.append(invalidInstrDecl)
 
+    #########################################################################
+    ############### Now I print the EMULATED CALL instruction ###############
+
+    if not model.startswith('acc') and processor.instructionCache and processor.fastFetch:
+        # Wrapper of the instruction found at the address of a routine emulated by the
+        # OS emulator: it is created when that address is decoded and it permanently stays
+        # in the instruction cache, so that the emulator is called only there
+        fetchWordType = processor.bitSizes[1]
+        handlerType = cxx_writer.writer_code.TemplateType('ToolsIf', [fetchWordType], 'ToolsIf.hpp')
+        emulatedCallElements = []
+        behaviorBody = cxx_writer.writer_code.Code("""if(this->handler.newIssue(this->address, this->original)){
+            return 0;
+        }
+        return this->original->behavior();""")
+        behaviorDecl = cxx_writer.writer_code.Method('behavior', behaviorBody, cxx_writer.writer_code.uintType, 'pu')
+        emulatedCallElements.append(behaviorDecl)
+        replicateBody = cxx_writer.writer_code.Code('return ' + replicateNew + 'EmulatedCallInstr(' + baseInstrInitElement + ', this->original->replicate(), this->handler, this->address);')
+        replicateDecl = cxx_writer.writer_code.Method('replicate', replicateBody, instructionType.makePointer(), 'pu', replicateParams, noException = True, const = True)
+        emulatedCallElements.append(replicateDecl)
+        setparamsBody = cxx_writer.writer_code.Code('this->original->setParams(bitString);')
+        setparamsDecl = cxx_writer.writer_code.Method('setParams', setparamsBody, cxx_writer.writer_code.voidType, 'pu', [setparamsParam], noException = True)
+        emulatedCallElements.append(setparamsDecl)
+        getIstructionNameBody = cxx_writer.writer_code.Code('return this->original->getInstructionName();')
+        getIstructionNameDecl = cxx_writer.writer_code.Method('getInstructionName', getIstructionNameBody, cxx_writer.writer_code.stringType, 'pu', noException = True, const = True)
+        emulatedCallElements.append(getIstructionNameDecl)
+        getMnemonicBody = cxx_writer.writer_code.Code('return this->original->getMnemonic();')
+        getMnemonicDecl = cxx_writer.writer_code.Method('getMnemonic', getMnemonicBody, cxx_writer.writer_code.stringType, 'pu', noException = True, const = True)
+        emulatedCallElements.append(getMnemonicDecl)
+        getIdBody = cxx_writer.writer_code.Code('return this->original->getId();')
+        getIdDecl = cxx_writer.writer_code.Method('getId', getIdBody, cxx_writer.writer_code.uintType, 'pu', noException = True, const = True)
+        emulatedCallElements.append(getIdDecl)
+        originalAttr = cxx_writer.writer_code.Attribute('original', instructionType.makePointer(), 'pri')
+        emulatedCallElements.append(originalAttr)
+        handlerAttr = cxx_writer.writer_code.Attribute('handler', handlerType.makeRef(), 'pri')
+        emulatedCallElements.append(handlerAttr)
+        addressAttr = cxx_writer.writer_code.Attribute('address', fetchWordType, 'pri')
+        emulatedCallElements.append(addressAttr)
+        emulatedCallParams = baseInstrConstrParams + [cxx_writer.writer_code.Parameter('original', instructionType.makePointer()),
+                    cxx_writer.writer_code.Parameter('handler', handlerType.makeRef()),
+                    cxx_writer.writer_code.Parameter('address', fetchWordType.makeRef().makeConst())]
+        publicConstr = cxx_writer.writer_code.Constructor(emptyBody, 'pu', emulatedCallParams, ['Instruction(' + baseInstrInitElement + ')', 'original(original)', 'handler(handler)', 'address(address)'])
+        emulatedCallDecl = cxx_writer.writer_code.ClassDeclaration('EmulatedCallInstr', emulatedCallElements, [instructionDecl.getType()], namespaces = [namespace])
+        emulatedCallDecl.addConstructor(publicConstr)
+        publicDestr = cxx_writer.writer_code.Destructor(cxx_writer.writer_code.Code('delete this->original;'), 'pu', True)
+        emulatedCallDecl.addDestructor(publicDestr)
+        classes.append(emulatedCallDecl)
+
     #########################################################################
     ############### Now I print the NOP instruction #####################
 
@@ -1440,6 +1539,81 @@ def getCPPClasses(self, processor, model, trace, combinedTrace, namespace):
     # Now I go over all the other instructions and I declare them
     for instr in self.instructions.values():
         classes += instr.getCPPClass(model, processor, trace, combinedTrace, namespace)
+    # Finally the superinstructions, which execute sequences of instructions fused together
+    from procWriter import hasFusedInstructions
+    if hasFusedInstructions(processor, model, trace):
+        classes += getCPPFusedClasses(self, processor, instructionDecl.getType(), namespace)
+    return classes
+
+def getCPPFusedClasses(self, processor, instructionType, namespace):
+    """Creates the classes of the superinstructions: each of them contains
+    its own copy of the instructions composing the sequence, already decoded,
+    and it executes their behaviors back to back, stopping as soon as the
+    control flow does not reach the next instruction of the sequence"""
+    from procWriter import resourceType
+    emptyBody = cxx_writer.writer_code.Code('')
+    fetchWordType = processor.bitSizes[1]
+    fetchRegType = resourceType[processor.fetchReg[0]].makeRef()
+    fetchAddress = 'this->' + processor.fetchReg[0]
+    if processor.fetchReg[1] < 0:
+        fetchAddress += str(processor.fetchReg[1])
+    elif processor.fetchReg[1] > 0:
+        fetchAddress += ' + ' + str(processor.fetchReg[1])
+    classes = []
+
+    # Base class of all the superinstructions: the execution stops after the instruction
+    # which moves the control flow out of the sequence or as soon as an event (interrupt,
+    # tool) is pending, and the number of instructions actually executed is reported back
+    curPCParam = cxx_writer.writer_code.Parameter('curPC', fetchWordType.makeRef().makeConst())
+    pendingEventsParam = cxx_writer.writer_code.Parameter('pendingEvents', cxx_writer.writer_code.uintType.makeRef().makeConst())
+    numExecutedParam = cxx_writer.writer_code.Parameter('numExecuted', cxx_writer.writer_code.uintType.makeRef())
+    behaviorParams = [curPCParam, pendingEventsParam, numExecutedParam]
+    fusedElements = []
+    fetchRegAttr = cxx_writer.writer_code.Attribute(processor.fetchReg[0], fetchRegType, 'pro')
+    fusedElements.append(fetchRegAttr)
+    behaviorDecl = cxx_writer.writer_code.Method('behavior', emptyBody, cxx_writer.writer_code.uintType, 'pu', behaviorParams, pure = True)
+    fusedElements.append(behaviorDecl)
+    fetchRegParam = cxx_writer.writer_code.Parameter(processor.fetchReg[0], fetchRegType)
+    publicConstr = cxx_writer.writer_code.Constructor(emptyBody, 'pu', [fetchRegParam], [processor.fetchReg[0] + '(' + processor.fetchReg[0] + ')'])
+    fusedDecl = cxx_writer.writer_code.ClassDeclaration('FusedInstruction', fusedElements, namespaces = [namespace])
+    fusedDecl.addConstructor(publicConstr)
+    publicDestr = cxx_writer.writer_code.Destructor(emptyBody, 'pu', True)
+    fusedDecl.addDestructor(publicDestr)
+    classes.append(fusedDecl)
+
+    for sequence in self.superInstructions:
+        for instrName in sequence:
+            if not self.instructions.has_key(instrName):
+                raise Exception('Instruction ' + instrName + ' used in superinstruction ' + '_'.join(sequence) + ' does not exist in the ISA')
+        sequenceElements = []
+        # The components are called through their class, so that their behavior can be inlined
+        behaviorCode = 'unsigned int numCycles = 0;\n'
+        constrCode = ''
+        destrCode = ''
+        for i in range(0, len(sequence)):
+            componentName = 'instr_' + str(i)
+            componentType = cxx_writer.writer_code.Type(sequence[i]).makePointer()
+            sequenceElements.append(cxx_writer.writer_code.Attribute(componentName, componentType, 'pri'))
+            constrCode += 'this->' + componentName + ' = dynamic_cast< ' + sequence[i] + ' * >(components[' + str(i) + ']);\n'
+            destrCode += 'delete this->' + componentName + ';\n'
+            if i > 0:
+                behaviorCode += 'if(pendingEvents != 0 || ' + fetchAddress + ' != curPC + ' + str(i*processor.wordSize) + '){\n'
+                behaviorCode += 'return numCycles;\n}\n'
+            behaviorCode += 'try{\nnumCycles += this->' + componentName + '->' + sequence[i] + '::behavior();\n}\n'
+            behaviorCode += 'catch(annull_exception &etc){\n}\n'
+            behaviorCode += 'numExecuted = ' + str(i + 1) + ';\n'
+        behaviorCode += 'return numCycles;\n'
+        behaviorBody = cxx_writer.writer_code.Code(behaviorCode)
+        behaviorBody.addInclude('customExceptions.hpp')
+        behaviorDecl = cxx_writer.writer_code.Method('behavior', behaviorBody, cxx_writer.writer_code.uintType, 'pu', behaviorParams)
+        sequenceElements.append(behaviorDecl)
+        componentsParam = cxx_writer.writer_code.Parameter('components', instructionType.makePointer().makePointer())
+        publicConstr = cxx_writer.writer_code.Constructor(cxx_writer.writer_code.Code(constrCode), 'pu', [fetchRegParam, componentsParam], ['FusedInstruction(' + processor.fetchReg[0] + ')'])
+        sequenceDecl = cxx_writer.writer_code.ClassDeclaration('Fused_' + '_'.join(sequence), sequenceElements, [fusedDecl.getType()], namespaces = [namespace])
+        sequenceDecl.addConstructor(publicConstr)
+        publicDestr = cxx_writer.writer_code.Destructor(cxx_writer.writer_code.Code(destrCode), 'pu', True)
+        sequenceDecl.addDestructor(publicDestr)
+        classes.append(sequenceDecl)
     return classes
 
 def getCPPTests(self, processor, modelType, trace, combinedTrace, namespace):
@@ -45,6 +45,10 @@ genericMethodNames = ['lock', 'unlock']
 methodTypes = None
 methodTypeLen = None
 
+# Size (log2 of the number of bytes) of the pages of the local memory which are
+# flagged as containing memory aliases or memory mapped devices
+memPageBits = 12
+
 def addMemoryMethods(self, memoryElements, methodsCode, methodsAttrs):
     archDWordType = self.bitSizes[0]
     archWordType = self.bitSizes[1]
@@ -67,11 +71,26 @@ def addMemoryMethods(self, memoryElements, methodsCode, methodsAttrs):
             lockDecl = cxx_writer.writer_code.Method(methName, methodsCode[methName], cxx_writer.writer_code.voidType, 'pu', inline = 'inline' in methodsAttrs[methName], pure = 'pure' in methodsAttrs[methName], virtual = 'virtual'  in methodsAttrs[methName], noException = 'noexc'  in methodsAttrs[methName])
             memoryElements.append(lockDecl)
 
+def addBlockMethods(self, memoryElements, readCode, writeCode, virtual = False):
+    # Adds the methods used to transfer a whole buffer from/to memory; they
+    # are used by the ABI (e.g. by the system calls) to avoid one call per byte
+    archWordType = self.bitSizes[1]
+    addressParam = cxx_writer.writer_code.Parameter('address', archWordType.makeRef().makeConst())
+    lengthParam = cxx_writer.writer_code.Parameter('length', cxx_writer.writer_code.uintType)
+    if readCode:
+        bufferParam = cxx_writer.writer_code.Parameter('buffer', cxx_writer.writer_code.ucharPtrType)
+        readDecl = cxx_writer.writer_code.Method('read_block_dbg', readCode, cxx_writer.writer_code.voidType, 'pu', [addressParam, bufferParam, lengthParam], virtual = virtual, const = len(self.tlmPorts) == 0)
+        memoryElements.append(readDecl)
+    if writeCode:
+        bufferParam = cxx_writer.writer_code.Parameter('buffer', cxx_writer.writer_code.ucharPtrType.makeConst())
+        writeDecl = cxx_writer.writer_code.Method('write_block_dbg', writeCode, cxx_writer.writer_code.voidType, 'pu', [addressParam, bufferParam, lengthParam], virtual = virtual)
+        memoryElements.append(writeDecl)
+
 def getCPPMemoryIf(self, model, namespace):
     """Creates the necessary structures for communicating with the memory; an
     array in case of an internal memory, the TLM port for the use with TLM
     etc."""
-    from procWriter import resourceType
+    from procWriter import resourceType, hasCodePages
 
     archDWordType = self.bitSizes[0]
     archWordType = self.bitSizes[1]
@@ -110,6 +129,15 @@ def getCPPMemoryIf(self, model, namespace):
         methodsAttrs[methName] = ['pure']
         methodsCode[methName] = emptyBody
     addMemoryMethods(self, memoryIfElements, methodsCode, methodsAttrs)
+    readBlockCode = cxx_writer.writer_code.Code("""for(unsigned int i = 0; i < length; i++){
+        buffer[i] = this->read_byte_dbg(address + i);
+    }
+    """)
+    writeBlockCode = cxx_writer.writer_code.Code("""for(unsigned int i = 0; i < length; i++){
+        this->write_byte_dbg(address + i, buffer[i]);
+    }
+    """)
+    addBlockMethods(self, memoryIfElements, readBlockCode, writeBlockCode, True)
 
     for curType in [archWordType, archHWordType]:
         swapEndianessCode = str(archByteType) + """ helperByte = 0;
@@ -171,10 +199,63 @@ def getCPPMemoryIf(self, model, namespace):
         this->debugger->notifyAddress(address, sizeof(datum));
     }
     """
+    # Writes to the pages holding cached instructions are notified to the
+    # processor, which drops these instructions (self modifying code)
+    checkCodePagesBlockCode = ''
+    codePagesInitCode = ''
+    if hasCodePages(self, model):
+        CodePagesType = cxx_writer.writer_code.TemplateType('CodePages', [str(archWordType)], 'codePages.hpp')
+        memoryElements.append(cxx_writer.writer_code.Attribute('codePages', CodePagesType.makePointer(), 'pri'))
+        setCodePagesBody = cxx_writer.writer_code.Code('this->codePages = codePages;')
+        memoryElements.append(cxx_writer.writer_code.Method('setCodePages', setCodePagesBody, cxx_writer.writer_code.voidType, 'pu', [cxx_writer.writer_code.Parameter('codePages', CodePagesType.makePointer())]))
+        checkWatchPointCode += 'if(this->codePages != NULL){\nthis->codePages->notifyWrite(address, sizeof(datum));\n}\n'
+        checkCodePagesBlockCode = 'if(this->codePages != NULL){\nthis->codePages->notifyWrite(address, length);\n}\n'
+        codePagesInitCode = 'this->codePages = NULL;\n'
+    # Big endian processors on little endian hosts can keep the memory with
+    # the words in host order, so that word accesses (and fetches) need no
+    # swap: bytes and half words are found by swizzling their address. This
+    # holds as long as the accesses are aligned, so it has to be enabled
+    # when compiling the simulator
+    nativeMemory = self.isBigEndian and self.wordSize == 4
+    nativeMemoryDefine = '#if defined(TRAP_NATIVE_MEMORY) && defined(LITTLE_ENDIAN_BO)\n'
+    swizzleCode = {'dword': '(unsigned long)address', 'word': '(unsigned long)address',
+                'half': '((unsigned long)address ^ 2)', 'byte': '((unsigned long)address ^ 3)'}
+    # Block transfers are a single copy from the memory array; with memory
+    # aliases they keep the byte-wise implementation of the base class so
+    # that the aliased addresses are honored
+    checkBlockCode = 'if(length > this->size || address > this->size - length){\nTHROW_ERROR("Block of " << length << " bytes at address " << std::hex << std::showbase << address << " out of memory");\n}\n'
+    readBlockCode = None
+    writeBlockCode = None
+    if not self.memAlias:
+        checkBlockIOCode = 'if(!this->ioRanges.empty()){\n'
+        readCopyCode = 'memcpy(buffer, this->memory + (unsigned long)address, length);\n'
+        writeCopyCode = 'memcpy(this->memory + (unsigned long)address, buffer, length);\n'
+        if nativeMemory:
+            readCopyCode = nativeMemoryDefine + 'for(unsigned int i = 0; i < length; i++){\nbuffer[i] = this->memory[((unsigned long)address + i) ^ 3];\n}\n#else\n' + readCopyCode + '#endif\n'
+            writeCopyCode = nativeMemoryDefine + 'for(unsigned int i = 0; i < length; i++){\nthis->memory[((unsigned long)address + i) ^ 3] = buffer[i];\n}\n#else\n' + writeCopyCode + '#endif\n'
+        readBlockCode = cxx_writer.writer_code.Code(checkBlockIOCode + 'MemoryInterface::read_block_dbg(address, buffer, length);\nreturn;\n}\n' + checkBlockCode + readCopyCode)
+        readBlockCode.addInclude('cstring')
+        writeBlockCode = cxx_writer.writer_code.Code(checkBlockIOCode + 'MemoryInterface::write_block_dbg(address, buffer, length);\nreturn;\n}\n' + checkBlockCode + 'if(this->debugger != NULL){\nthis->debugger->notifyAddress(address, length);\n}\n' + checkCodePagesBlockCode + writeCopyCode)
+        writeBlockCode.addInclude('cstring')
     endianessCode = {'read_dword': swapDEndianessCode, 'read_word': swapEndianessCode, 'read_half': swapEndianessCode, 'read_byte': '',
                 'read_dword_dbg': swapDEndianessCode, 'read_word_dbg': swapEndianessCode, 'read_half_dbg': swapEndianessCode, 'read_byte_dbg': '',
                 'write_dword': swapDEndianessCode, 'write_word': swapEndianessCode, 'write_half': swapEndianessCode, 'write_byte': '',
                 'write_dword_dbg': swapDEndianessCode, 'write_word_dbg': swapEndianessCode, 'write_half_dbg': swapEndianessCode, 'write_byte_dbg': ''}
+    readAccessCode = {}
+    writeAccessCode = {}
+    dumpAddressCode = {}
+    for methName in readMethodNames + readMethodNames_dbg:
+        accessType = str(methodTypes[methName])
+        readAccessCode[methName] = accessType + ' datum = *(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address);\n' + endianessCode[methName]
+        if nativeMemory:
+            readAccessCode[methName] = nativeMemoryDefine + accessType + ' datum = *(' + str(methodTypes[methName].makePointer()) + ')(this->memory + ' + swizzleCode[methName.split('_')[1]] + ');\n#else\n' + readAccessCode[methName] + '#endif\n'
+    for methName in writeMethodNames + writeMethodNames_dbg:
+        writeAccessCode[methName] = endianessCode[methName] + '\n*(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address) = datum;\n'
+        dumpAddressCode[methName] = 'dumpInfo.address = address + i;\n'
+        if nativeMemory:
+            writeAccessCode[methName] = nativeMemoryDefine + '*(' + str(methodTypes[methName].makePointer()) + ')(this->memory + ' + swizzleCode[methName.split('_')[1]] + ') = datum;\n#else\n' + writeAccessCode[methName] + '#endif\n'
+            # The bytes of datum are in host order
+            dumpAddressCode[methName] = nativeMemoryDefine + 'dumpInfo.address = (' + swizzleCode[methName.split('_')[1]] + ' + i) ^ 3;\n#else\n' + dumpAddressCode[methName] + '#endif\n'
     readAliasCode = {}
     readMemAliasCode = ''
     for alias in self.memAlias:
@@ -232,6 +313,49 @@ def getCPPMemoryIf(self, model, namespace):
     writeAliasCode['write_byte'] = writeMemAliasCode
     writeAliasCode['write_byte_dbg'] = writeMemAliasCode
 
+    # The memory aliases, the memory mapped devices and the out of memory
+    # addresses are checked only for the accesses to the flagged pages or
+    # beyond the memory size, so that the normal accesses pay a single check
+    ioRangeType = cxx_writer.writer_code.TemplateType('MemoryIORange', [str(archWordType)], 'MemoryIOIf.hpp')
+    ioRangesType = cxx_writer.writer_code.TemplateType('std::vector', [ioRangeType], 'vector')
+    ioLoopCode = 'for(' + str(ioRangesType) + '::const_iterator ioIter = this->ioRanges.begin(), ioEnd = this->ioRanges.end(); ioIter != ioEnd; ioIter++){\n'
+    ioLoopCode += 'if(address >= ioIter->start && address <= ioIter->end){\n'
+    slowPathStart = 'if(address >= this->size || this->pageFlags[address >> ' + str(memPageBits) + '] != 0){\n'
+    readSlowPathCode = {}
+    readSlowPathCodeException = {}
+    for methName in readMethodNames + readMethodNames_dbg:
+        ioCode = ioLoopCode + 'return (' + str(methodTypes[methName]) + ')ioIter->device->read(address, sizeof(' + str(methodTypes[methName]) + '));\n}\n}\n'
+        readSlowPathCode[methName] = slowPathStart + readAliasCode[methName] + ioCode + checkAddressCode + '}\n'
+        readSlowPathCodeException[methName] = slowPathStart + readAliasCode[methName] + ioCode + checkAddressCodeException + '}\n'
+    writeSlowPathCode = {}
+    writeSlowPathCodeException = {}
+    for methName in writeMethodNames + writeMethodNames_dbg:
+        ioCode = ioLoopCode + 'ioIter->device->write(address, sizeof(datum), datum);\nreturn;\n}\n}\n'
+        writeSlowPathCode[methName] = slowPathStart + writeAliasCode[methName] + ioCode + checkAddressCode + '}\n'
+        writeSlowPathCodeException[methName] = slowPathStart + writeAliasCode[methName] + ioCode + checkAddressCodeException + '}\n'
+
+    # Pages flagged for the memory aliases: only the ones inside the memory
+    # need it, the others are beyond the memory size
+    pageFlagsCode = 'this->pageFlags = new unsigned char[(size >> ' + str(memPageBits) + ') + 1];\n'
+    pageFlagsCode += 'memset(this->pageFlags, 0, (size >> ' + str(memPageBits) + ') + 1);\n'
+    for alias in self.memAlias:
+        pageFlagsCode += 'if(' + hex(long(alias.address)).rstrip('L') + ' < size){\n'
+        pageFlagsCode += 'this->pageFlags[' + hex(long(alias.address)).rstrip('L') + ' >> ' + str(memPageBits) + '] = 1;\n}\n'
+
+    # Method used to attach a memory mapped device to an address range
+    addIOCode = str(ioRangeType) + ' newRange;\n'
+    addIOCode += 'newRange.start = start;\nnewRange.end = end;\nnewRange.device = &device;\n'
+    addIOCode += 'this->ioRanges.push_back(newRange);\n'
+    addIOCode += 'for(unsigned long page = start >> ' + str(memPageBits) + '; page <= (unsigned long)(end >> ' + str(memPageBits) + ') && page <= (this->size >> ' + str(memPageBits) + '); page++){\n'
+    addIOCode += 'this->pageFlags[page] = 1;\n}\n'
+    addIOBody = cxx_writer.writer_code.Code(addIOCode)
+    addIOParams = [cxx_writer.writer_code.Parameter('start', archWordType.makeRef().makeConst()), cxx_writer.writer_code.Parameter('end', archWordType.makeRef().makeConst())]
+    addIOParams.append(cxx_writer.writer_code.Parameter('device', cxx_writer.writer_code.TemplateType('MemoryIOIf', [str(archWordType)], 'MemoryIOIf.hpp').makeRef()))
+    addIODecl = cxx_writer.writer_code.Method('addIODevice', addIOBody, cxx_writer.writer_code.voidType, 'pu', addIOParams)
+    memoryElements.append(addIODecl)
+    ioRangesAttribute = cxx_writer.writer_code.Attribute('ioRanges', ioRangesType, 'pri')
+    pageFlagsAttribute = cxx_writer.writer_code.Attribute('pageFlags', cxx_writer.writer_code.ucharPtrType, 'pri')
+
     # If there is no memory or there is a memory and this has debugging disabled
     if not self.memory or not self.memory[2]:
         methodsCode = {}
@@ -239,10 +363,10 @@ def getCPPMemoryIf(self, model, namespace):
         for methName in readMethodNames + readMethodNames_dbg:
             methodsAttrs[methName] = []
             if methName.endswith('_gdb'):
-                readBody = cxx_writer.writer_code.Code(readAliasCode[methName] + checkAddressCodeException + '\n' + str(methodTypes[methName]) + ' datum = *(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address);\n' + endianessCode[methName] + '\nreturn datum;')
+                readBody = cxx_writer.writer_code.Code(readSlowPathCodeException[methName] + '\n' + readAccessCode[methName] + '\nreturn datum;')
             else:
                 methodsAttrs[methName].append('noexc')
-                readBody = cxx_writer.writer_code.Code(readAliasCode[methName] + checkAddressCode + '\n' + str(methodTypes[methName]) + ' datum = *(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address);\n' + endianessCode[methName] + '\nreturn datum;')
+                readBody = cxx_writer.writer_code.Code(readSlowPathCode[methName] + '\n' + readAccessCode[methName] + '\nreturn datum;')
                 if methName == 'read_word':
                     methodsAttrs[methName].append('inline')
             readBody.addInclude('trap_utils.hpp')
@@ -250,28 +374,32 @@ def getCPPMemoryIf(self, model, namespace):
         for methName in writeMethodNames + writeMethodNames_dbg:
             methodsAttrs[methName] = []
             if methName.endswith('_gdb'):
-                methodsCode[methName] = cxx_writer.writer_code.Code(writeAliasCode[methName] + checkAddressCodeException + checkWatchPointCode + '\n' + endianessCode[methName] + '\n*(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address) = datum;')
+                methodsCode[methName] = cxx_writer.writer_code.Code(writeSlowPathCodeException[methName] + checkWatchPointCode + '\n' + writeAccessCode[methName])
             else:
                 methodsAttrs[methName].append('noexc')
-                methodsCode[methName] = cxx_writer.writer_code.Code(writeAliasCode[methName] + checkAddressCode + checkWatchPointCode + '\n' + endianessCode[methName] + '\n*(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address) = datum;')
+                methodsCode[methName] = cxx_writer.writer_code.Code(writeSlowPathCode[methName] + checkWatchPointCode + '\n' + writeAccessCode[methName])
                 if methName == 'write_word':
                     methodsAttrs[methName].append('inline')
         for methName in genericMethodNames:
             methodsAttrs[methName] = []
             methodsCode[methName] = emptyBody
         addMemoryMethods(self, memoryElements, methodsCode, methodsAttrs)
+        addBlockMethods(self, memoryElements, readBlockCode, writeBlockCode)
 
         arrayAttribute = cxx_writer.writer_code.Attribute('memory', cxx_writer.writer_code.charPtrType, 'pri')
         memoryElements.append(arrayAttribute)
         sizeAttribute = cxx_writer.writer_code.Attribute('size', cxx_writer.writer_code.uintType, 'pri')
         memoryElements.append(sizeAttribute)
         memoryElements += aliasAttrs
+        memoryElements.append(ioRangesAttribute)
+        memoryElements.append(pageFlagsAttribute)
         localMemDecl = cxx_writer.writer_code.ClassDeclaration('LocalMemory', memoryElements, [memoryIfDecl.getType()], namespaces = [namespace])
-        constructorBody = cxx_writer.writer_code.Code('this->memory = new char[size];\nthis->debugger = NULL;')
+        constructorBody = cxx_writer.writer_code.Code('this->memory = new char[size];\nthis->debugger = NULL;\n' + codePagesInitCode + pageFlagsCode)
+        constructorBody.addInclude('cstring')
         constructorParams = [cxx_writer.writer_code.Parameter('size', cxx_writer.writer_code.uintType)]
         publicMemConstr = cxx_writer.writer_code.Constructor(constructorBody, 'pu', constructorParams + aliasParams, ['size(size)'] + aliasInit)
         localMemDecl.addConstructor(publicMemConstr)
-        destructorBody = cxx_writer.writer_code.Code('delete [] this->memory;')
+        destructorBody = cxx_writer.writer_code.Code('delete [] this->memory;\ndelete [] this->pageFlags;')
         publicMemDestr = cxx_writer.writer_code.Destructor(destructorBody, 'pu', True)
         localMemDecl.addDestructor(publicMemDestr)
         classes.append(localMemDecl)
@@ -287,9 +415,7 @@ def getCPPMemoryIf(self, model, namespace):
         else:
             dumpCode1 += 'dumpInfo.programCounter = 0;\n'
         dumpCode1 += 'for(unsigned int i = 0; i < '
-        dumpCode2 = """; i++){
-    dumpInfo.address = address + i;
-    dumpInfo.val = (char)((datum & (0xFF << i*8)) >> i*8);
+        dumpCode2 = """dumpInfo.val = (char)((datum & (0xFF << i*8)) >> i*8);
     this->dumpFile.write((char *)&dumpInfo, sizeof(MemAccessType));
 }
 """
@@ -299,9 +425,9 @@ def getCPPMemoryIf(self, model, namespace):
         for methName in readMethodNames + readMethodNames_dbg:
             methodsAttrs[methName] = ['noexc']
             if methName.endswith('_gdb'):
-                readBody = cxx_writer.writer_code.Code(readAliasCode[methName] + checkAddressCodeException + '\n' + str(methodTypes[methName]) + ' datum = *(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address);\n' + endianessCode[methName] + '\nreturn datum;')
+                readBody = cxx_writer.writer_code.Code(readSlowPathCodeException[methName] + '\n' + readAccessCode[methName] + '\nreturn datum;')
             else:
-                readBody = cxx_writer.writer_code.Code(readAliasCode[methName] + checkAddressCode + '\n' + str(methodTypes[methName]) + ' datum = *(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address);\n' + endianessCode[methName] + '\nreturn datum;')
+                readBody = cxx_writer.writer_code.Code(readSlowPathCode[methName] + '\n' + readAccessCode[methName] + '\nreturn datum;')
                 if methName == 'read_word':
                     methodsAttrs[methName].append('inline')
             readBody.addInclude('trap_utils.hpp')
@@ -310,16 +436,18 @@ def getCPPMemoryIf(self, model, namespace):
         for methName in writeMethodNames + writeMethodNames_dbg:
             methodsAttrs[methName] = []
             if methName.endswith('_gdb'):
-                methodsCode[methName] = cxx_writer.writer_code.Code(writeAliasCode[methName] + checkAddressCodeException + checkWatchPointCode + '\n' + endianessCode[methName] + '\n*(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address) = datum;' + dumpCode1 + str(methodTypeLen[methName]) + dumpCode2)
+                methodsCode[methName] = cxx_writer.writer_code.Code(writeSlowPathCodeException[methName] + checkWatchPointCode + '\n' + writeAccessCode[methName] + dumpCode1 + str(methodTypeLen[methName]) + '; i++){\n' + dumpAddressCode[methName] + dumpCode2)
             else:
                 methodsAttrs[methName].append('noexc')
-                methodsCode[methName] = cxx_writer.writer_code.Code(writeAliasCode[methName] + checkAddressCode + checkWatchPointCode + '\n' + endianessCode[methName] + '\n*(' + str(methodTypes[methName].makePointer()) + ')(this->memory + (unsigned long)address) = datum;' + dumpCode1 + str(methodTypeLen[methName]) + dumpCode2)
+                methodsCode[methName] = cxx_writer.writer_code.Code(writeSlowPathCode[methName] + checkWatchPointCode + '\n' + writeAccessCode[methName] + dumpCode1 + str(methodTypeLen[methName]) + '; i++){\n' + dumpAddressCode[methName] + dumpCode2)
                 if methName == 'write_word':
                     methodsAttrs[methName].append('inline')
         for methName in genericMethodNames:
             methodsAttrs[methName] = []
             methodsCode[methName] = emptyBody
         addMemoryMethods(self, memoryElements, methodsCode, methodsAttrs)
+        # Writes go through the base class so that each byte is dumped
+        addBlockMethods(self, memoryElements, readBlockCode, None)
 
         endOfSimBody = cxx_writer.writer_code.Code("""if(this->dumpFile){
            this->dumpFile.flush();
@@ -346,6 +474,8 @@ def getCPPMemoryIf(self, model, namespace):
         dumpFileAttribute = cxx_writer.writer_code.Attribute('dumpFile', cxx_writer.writer_code.ofstreamType, 'pri')
         memoryElements.append(dumpFileAttribute)
         memoryElements += aliasAttrs
+        memoryElements.append(ioRangesAttribute)
+        memoryElements.append(pageFlagsAttribute)
         if self.memory[3]:
             memoryElements.append(cxx_writer.writer_code.Attribute(self.memory[3], resourceType[self.memory[3]].makeRef(), 'pri'))
             pcRegParam = [cxx_writer.writer_code.Parameter(self.memory[3], resourceType[self.memory[3]].makeRef())]
@@ -357,10 +487,12 @@ def getCPPMemoryIf(self, model, namespace):
             if(!this->dumpFile){
                 THROW_EXCEPTION("Error in opening file memoryDump.dmp for writing");
             }
-        """)
+        """ + codePagesInitCode + pageFlagsCode)
+        constructorBody.addInclude('cstring')
         publicMemConstr = cxx_writer.writer_code.Constructor(constructorBody, 'pu', constructorParams + aliasParams + pcRegParam, constructorInit + aliasInit + pcRegInit)
         localMemDecl.addConstructor(publicMemConstr)
         destructorBody = cxx_writer.writer_code.Code("""delete [] this->memory;
+        delete [] this->pageFlags;
         if(this->dumpFile){
            this->dumpFile.flush();
            this->dumpFile.close();
@@ -44,6 +44,216 @@ hasCheckHazard = False
 wbStage = None
 chStage = None
 
+def getUnlockQueueType(processor):
+    """Returns the type of the queue containing the registers to be unlocked:
+    it is a timing wheel, whose slots are indexed by the number of cycles
+    after which the registers will be unlocked; its size is the smallest
+    power of 2 able to contain the longest write back delay of the instructions"""
+    maxDelay = 0
+    for instr in processor.isa.instructions.values():
+        for delay in instr.delayedWb.values():
+            if delay > maxDelay:
+                maxDelay = delay
+    wheelSize = 1
+    while wheelSize <= maxDelay:
+        wheelSize *= 2
+    registerType = cxx_writer.writer_code.Type('Register', includes = ['registers.hpp'])
+    return cxx_writer.writer_code.TemplateType('TimingWheel', [registerType.makePointer(), str(wheelSize)], 'timingWheel.hpp')
+
+def getCycleStageMethods(self, trace, combinedTrace, model, pipeStage, hasCheckHazard):
+    """Returns the cycle and endCycle methods of a pipeline stage for the
+    cycle driven scheduler: instead of having one thread per stage synchronized
+    through events, the processor calls, in reverse order, cycle for all
+    the stages (executing the stage behavior of the current instruction) and,
+    after the cycle latency elapsed, endCycle (propagating the instructions
+    to the following stages). Stalls and flushes are simply state flags
+    checked by endCycle"""
+    # Stages up to (and including) the first one checking for hazards
+    # are stalled when the instruction entering the check stage is blocked
+    canStall = False
+    if hasCheckHazard:
+        canStall = True
+        for pipeStageTemp in self.pipes[:self.pipes.index(pipeStage)]:
+            if pipeStageTemp.checkHazard:
+                canStall = False
+                break
+    discardCode = """if(this->hasToFlush){
+        if(this->curInstruction->toDestroy){
+            delete this->curInstruction;
+        }
+        else{
+            this->curInstruction->inPipeline = false;
+        }
+        this->curInstruction = this->NOPInstrInstance;
+        this->nextInstruction = this->NOPInstrInstance;
+        this->hasToFlush = false;
+    }
+    """
+    cycleCode = 'unsigned int numCycles = 0;\n'
+    endCycleCode = ''
+    if pipeStage == self.pipes[0]:
+        cycleCode += 'this->instrExecuting = true;\n'
+        if self.instructionCache:
+            cycleCode += 'template_map< ' + str(self.bitSizes[1]) + ', CacheElem >::iterator instrCacheEnd = this->instrCache.end();\n'
+        if canStall:
+            cycleCode += 'if(!this->chStalled){\n'
+        cycleCode += getInterruptCode(self, trace, pipeStage)
+        fetchCode = computeFetchCode(self, model)
+        cycleCode += str(self.bitSizes[1]) + ' curPC = ' + computeCurrentPC(self, model) + ';\n'
+        cycleCode += """if(!this->startMet && curPC == this->profStartAddr){
+            this->profTimeStart = sc_time_stamp();
+        }
+        if(this->startMet && curPC == this->profEndAddr){
+            this->profTimeEnd = sc_time_stamp();
+        }
+        #ifndef DISABLE_TOOLS
+        // code necessary to check the tools, to see if they need
+        // the pipeline to be empty before being able to procede with execution
+        if(this->toolManager.emptyPipeline(curPC)){
+            this->numNOPS++;
+        }
+        else{
+            this->numNOPS = 0;
+        }
+        if(this->numNOPS > 0 && this->numNOPS < """ + str(len(self.pipes)) + """){
+            this->curInstruction = this->NOPInstrInstance;
+        """
+        if trace and not combinedTrace:
+            cycleCode += 'std::cerr << \"PC: \" << std::hex << std::showbase << curPC << " propagating NOP because tools need it" << std::endl;\n'
+        cycleCode += """}
+        else{
+            this->numNOPS = 0;
+        #endif
+        #ifdef ENABLE_HISTORY
+        HistoryInstrType instrQueueElem;
+        if(this->historyEnabled){
+            instrQueueElem.cycle = (unsigned int)(sc_time_stamp()/this->latency);
+            instrQueueElem.address = curPC;
+        }
+        #endif
+        """
+        if not (self.instructionCache and self.fastFetch):
+            cycleCode += fetchCode
+        if trace and not combinedTrace:
+            cycleCode += 'std::cerr << \"Fetching PC: \" << std::hex << std::showbase << curPC << std::endl;\n'
+        if self.instructionCache:
+            cycleCode += fetchWithCacheCode(self, fetchCode, trace, combinedTrace, getInstrIssueCodePipe, hasCheckHazard, pipeStage)
+        else:
+            cycleCode += standardInstrFetch(self, trace, combinedTrace, getInstrIssueCodePipe, hasCheckHazard, pipeStage)
+        cycleCode += """#ifdef ENABLE_HISTORY
+        if(this->historyEnabled){
+            this->instHistoryQueue.push_back(instrQueueElem);
+            if(this->histFile){
+                this->undumpedHistElems++;
+                if(undumpedHistElems == this->instHistoryQueue.capacity()){
+                    boost::circular_buffer<HistoryInstrType>::const_iterator beg, end;
+                    for(beg = this->instHistoryQueue.begin(), end = this->instHistoryQueue.end(); beg != end; beg++){
+                        this->histFile << beg->toStr() << std::endl;
+                    }
+                    this->undumpedHistElems = 0;
+                }
+            }
+        }
+        #endif
+        this->numInstructions++;
+        #ifndef DISABLE_TOOLS
+        }
+        #endif
+        """
+        if self.irqs:
+            cycleCode += '}\n'
+        if canStall:
+            cycleCode += '}\n'
+
+        # At the end of the cycle the fetched instruction enters the pipeline, unless
+        # it is stalled, and the pipeline registers are updated
+        endCycleCode += discardCode
+        if canStall:
+            endCycleCode += 'if(!this->chStalled){\n'
+        endCycleCode += 'this->succStage->nextInstruction = this->curInstruction;\n'
+        if canStall:
+            endCycleCode += '}\n'
+        endCycleCode += """this->refreshRegisters();
+        this->instrExecuting = false;
+        this->instrEndEvent.notify();
+        """
+        # Finally the hazards are checked on the instruction which will enter
+        # the check stage in the next cycle
+        if hasCheckHazard:
+            endCycleCode += 'Instruction * succToCheck = this->'
+            for pipeStageTemp in self.pipes:
+                if pipeStageTemp.checkHazard:
+                    break
+                else:
+                    endCycleCode += 'succStage->'
+            endCycleCode += 'nextInstruction;\n'
+            endCycleCode += 'bool stallPipe = !succToCheck->checkHazard_' + pipeStageTemp.name + '();\n'
+            codeTemp = 'this->'
+            for pipeStageTemp in self.pipes:
+                endCycleCode += codeTemp + 'chStalled = stallPipe;\n'
+                codeTemp += 'succStage->'
+                if pipeStageTemp.checkHazard:
+                    break
+        if trace and not combinedTrace:
+            endCycleCode += 'std::cerr << \"---------------------------------------------------------------\" << std::endl << std::endl;\n'
+    else:
+        cycleCode += 'bool flushAnnulled = false;\n'
+        cycleCode += 'this->curInstruction = this->nextInstruction;\n'
+        if canStall:
+            cycleCode += 'if(!this->chStalled){\n'
+        if trace and not combinedTrace:
+            cycleCode += 'std::cerr << \"Stage ' + pipeStage.name + ' instruction at PC = \" << std::hex << std::showbase << this->curInstruction->fetchPC << std::endl;\n'
+        if hasCheckHazard and pipeStage.checkHazard:
+            cycleCode += 'this->curInstruction->lockRegs_' + pipeStage.name + '();\n'
+        if trace and combinedTrace and pipeStage == self.pipes[-1]:
+            cycleCode += 'if(this->curInstruction != this->NOPInstrInstance){\n'
+            cycleCode += 'std::cerr << \"Current PC: \" << std::hex << std::showbase << this->curInstruction->fetchPC << std::endl;\n'
+            cycleCode += '}\n'
+        cycleCode += getInstrIssueCodePipe(self, trace, combinedTrace, 'this->curInstruction', hasCheckHazard, pipeStage)
+        cycleCode += """// flushing the preceding stages: they will discard their instructions at the end of the cycle
+        if(this->curInstruction->flushPipeline || flushAnnulled){
+            this->curInstruction->flushPipeline = false;
+            this->prevStage->flush();
+        }
+        """
+        if canStall:
+            cycleCode += '}\n'
+            if trace and pipeStage.checkHazard and not combinedTrace:
+                cycleCode += """else{
+                    std::cerr << "Stage: """ + pipeStage.name + """ - Instruction " << this->curInstruction->getInstructionName() << " Mnemonic = " << this->curInstruction->getMnemonic() << " at PC = " << std::hex << std::showbase << this->curInstruction->fetchPC << " stalled on a data hazard" << std::endl;
+                    std::cerr << "Stalled registers: " << this->curInstruction->printBusyRegs() << std::endl << std::endl;
+                }
+                """
+
+        if pipeStage == self.pipes[-1]:
+            endCycleCode += """if(this->curInstruction->toDestroy){
+                delete this->curInstruction;
+            }
+            else{
+                this->curInstruction->inPipeline = false;
+            }
+            """
+        else:
+            endCycleCode += discardCode
+            if canStall:
+                # A stalled stage inserts a bubble in the following one
+                endCycleCode += """if(this->chStalled){
+                    this->succStage->nextInstruction = this->NOPInstrInstance;
+                }
+                else{
+                    this->succStage->nextInstruction = this->curInstruction;
+                }
+                """
+            else:
+                endCycleCode += 'this->succStage->nextInstruction = this->curInstruction;\n'
+    cycleCode += 'return numCycles;\n'
+
+    cycleBody = cxx_writer.writer_code.Code(cycleCode)
+    cycleDecl = cxx_writer.writer_code.Method('cycle', cycleBody, cxx_writer.writer_code.uintType, 'pu')
+    endCycleBody = cxx_writer.writer_code.Code(endCycleCode)
+    endCycleDecl = cxx_writer.writer_code.Method('endCycle', endCycleBody, cxx_writer.writer_code.voidType, 'pu')
+    return [cycleDecl, endCycleDecl]
+
 def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
     global hasCheckHazard
     global wbStage
@@ -60,21 +270,26 @@ def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
     IntructionType = cxx_writer.writer_code.Type('Instruction', includes = ['instructions.hpp'])
     registerType = cxx_writer.writer_code.Type('Register', includes = ['registers.hpp'])
 
-    stageEndedFlag = cxx_writer.writer_code.Attribute('stageEnded', cxx_writer.writer_code.boolType, 'pu')
-    pipelineElements.append(stageEndedFlag)
+    # With the cycle driven scheduler the stages are not separate threads, so
+    # there is no need for the events synchronizing them
+    if not self.cycleDriven:
+        stageEndedFlag = cxx_writer.writer_code.Attribute('stageEnded', cxx_writer.writer_code.boolType, 'pu')
+        pipelineElements.append(stageEndedFlag)
     constructorCode += 'this->chStalled = false;\n'
     constructorCode += 'this->stalled = false;\n'
-    constructorCode += 'this->stageEnded = false;\n'
-    stageBeginningFlag = cxx_writer.writer_code.Attribute('stageBeginning', cxx_writer.writer_code.boolType, 'pu')
-    pipelineElements.append(stageBeginningFlag)
-    constructorCode += 'this->stageBeginning = false;\n'
+    if not self.cycleDriven:
+        constructorCode += 'this->stageEnded = false;\n'
+        stageBeginningFlag = cxx_writer.writer_code.Attribute('stageBeginning', cxx_writer.writer_code.boolType, 'pu')
+        pipelineElements.append(stageBeginningFlag)
+        constructorCode += 'this->stageBeginning = false;\n'
     hasToFlush = cxx_writer.writer_code.Attribute('hasToFlush', cxx_writer.writer_code.boolType, 'pu')
     pipelineElements.append(hasToFlush)
     constructorCode += 'this->hasToFlush = false;\n'
-    stageEndedEvent = cxx_writer.writer_code.Attribute('stageEndedEv', cxx_writer.writer_code.sc_eventType, 'pu')
-    pipelineElements.append(stageEndedEvent)
-    stageBeginningEvent = cxx_writer.writer_code.Attribute('stageBeginningEv', cxx_writer.writer_code.sc_eventType, 'pu')
-    pipelineElements.append(stageBeginningEvent)
+    if not self.cycleDriven:
+        stageEndedEvent = cxx_writer.writer_code.Attribute('stageEndedEv', cxx_writer.writer_code.sc_eventType, 'pu')
+        pipelineElements.append(stageEndedEvent)
+        stageBeginningEvent = cxx_writer.writer_code.Attribute('stageBeginningEv', cxx_writer.writer_code.sc_eventType, 'pu')
+        pipelineElements.append(stageBeginningEvent)
 
     NOPIntructionType = cxx_writer.writer_code.Type('NOPInstruction', 'instructions.hpp')
     NOPinstructionsAttribute = cxx_writer.writer_code.Attribute('NOPInstrInstance', NOPIntructionType.makePointer(), 'pu')
@@ -127,7 +342,7 @@ def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
     pipelineElements.append(stageAttr)
     stageAttr = cxx_writer.writer_code.Attribute('succStage', pipeType.makePointer(), 'pu')
     pipelineElements.append(stageAttr)
-    unlockQueueType = cxx_writer.writer_code.TemplateType('std::map', ['unsigned int', cxx_writer.writer_code.TemplateType('std::vector', [registerType.makePointer()], 'vector')], 'map')
+    unlockQueueType = getUnlockQueueType(self)
     unlockQueueAttr = cxx_writer.writer_code.Attribute('unlockQueue', unlockQueueType, 'pro', static = True)
     pipelineElements.append(unlockQueueAttr)
     prevStageParam = cxx_writer.writer_code.Parameter('prevStage', pipeType.makePointer(), initValue = 'NULL')
@@ -211,7 +426,7 @@ def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
             # stage and dealing with it properly.
             codeString += getInterruptCode(self, trace, pipeStage)
             # computes the correct memory and/or memory port from which fetching the instruction stream
-            fetchCode = computeFetchCode(self)
+            fetchCode = computeFetchCode(self, model)
             # computes the address from which the next instruction shall be fetched
             fetchAddress = computeCurrentPC(self, model)
             codeString += str(self.bitSizes[1]) + ' curPC = ' + fetchAddress + ';\n'
@@ -500,38 +715,41 @@ def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
         if pipeStage.checkHazard:
             checkHazardsMet = True
 
-        behaviorMethodBody = cxx_writer.writer_code.Code(codeString)
-        behaviorMethodDecl = cxx_writer.writer_code.Method('behavior', behaviorMethodBody, cxx_writer.writer_code.voidType, 'pu')
-        curPipeElements.append(behaviorMethodDecl)
-        constructorCode += 'SC_THREAD(behavior);\n'
+        if self.cycleDriven:
+            curPipeElements += getCycleStageMethods(self, trace, combinedTrace, model, pipeStage, hasCheckHazard)
+        else:
+            behaviorMethodBody = cxx_writer.writer_code.Code(codeString)
+            behaviorMethodDecl = cxx_writer.writer_code.Method('behavior', behaviorMethodBody, cxx_writer.writer_code.voidType, 'pu')
+            curPipeElements.append(behaviorMethodDecl)
+            constructorCode += 'SC_THREAD(behavior);\n'
 
-        waitPipeBeginCode = """this->stageBeginning = true;
-        this->stageBeginningEv.notify();
-        """
-        for pipeStageInner in self.pipes:
-            if pipeStageInner != pipeStage:
-                waitPipeBeginCode += """if(!this->stage_""" + pipeStageInner.name + """->stageBeginning){
-                    wait(this->stage_""" + pipeStageInner.name + """->stageBeginningEv);
-                }
-                """
-        waitPipeBeginCode += 'this->stageEnded = false;'
-        waitPipeBeginBody = cxx_writer.writer_code.Code(waitPipeBeginCode)
-        waitPipeBeginDecl = cxx_writer.writer_code.Method('waitPipeBegin', waitPipeBeginBody, cxx_writer.writer_code.voidType, 'pri', noException = True)
-        curPipeElements.append(waitPipeBeginDecl)
-
-        waitPipeEndCode = """this->stageBeginning = false;
-        this->stageEnded = true;
-        this->stageEndedEv.notify();
-        """
-        for pipeStageInner in self.pipes:
-            if pipeStageInner != pipeStage:
-                waitPipeEndCode += """if(!this->stage_""" + pipeStageInner.name + """->stageEnded){
-                    wait(this->stage_""" + pipeStageInner.name + """->stageEndedEv);
-                }
-                """
-        waitPipeEndBody = cxx_writer.writer_code.Code(waitPipeEndCode)
-        waitPipeEndDecl = cxx_writer.writer_code.Method('waitPipeEnd', waitPipeEndBody, cxx_writer.writer_code.voidType, 'pri', noException = True)
-        curPipeElements.append(waitPipeEndDecl)
+            waitPipeBeginCode = """this->stageBeginning = true;
+            this->stageBeginningEv.notify();
+            """
+            for pipeStageInner in self.pipes:
+                if pipeStageInner != pipeStage:
+                    waitPipeBeginCode += """if(!this->stage_""" + pipeStageInner.name + """->stageBeginning){
+                        wait(this->stage_""" + pipeStageInner.name + """->stageBeginningEv);
+                    }
+                    """
+            waitPipeBeginCode += 'this->stageEnded = false;'
+            waitPipeBeginBody = cxx_writer.writer_code.Code(waitPipeBeginCode)
+            waitPipeBeginDecl = cxx_writer.writer_code.Method('waitPipeBegin', waitPipeBeginBody, cxx_writer.writer_code.voidType, 'pri', noException = True)
+            curPipeElements.append(waitPipeBeginDecl)
+
+            waitPipeEndCode = """this->stageBeginning = false;
+            this->stageEnded = true;
+            this->stageEndedEv.notify();
+            """
+            for pipeStageInner in self.pipes:
+                if pipeStageInner != pipeStage:
+                    waitPipeEndCode += """if(!this->stage_""" + pipeStageInner.name + """->stageEnded){
+                        wait(this->stage_""" + pipeStageInner.name + """->stageEndedEv);
+                    }
+                    """
+            waitPipeEndBody = cxx_writer.writer_code.Code(waitPipeEndCode)
+            waitPipeEndDecl = cxx_writer.writer_code.Method('waitPipeEnd', waitPipeEndBody, cxx_writer.writer_code.voidType, 'pri', noException = True)
+            curPipeElements.append(waitPipeEndDecl)
 
         IntructionType = cxx_writer.writer_code.Type('Instruction', 'instructions.hpp')
         IntructionTypePtr = IntructionType.makePointer()
@@ -617,24 +835,17 @@ def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
                                     codeString += 'std::cerr << "Updating alias ' + aliasB.name + '_' + self.pipes[i + 1].name + '[" << ' + str(i) + ' << "]" << std::endl;\n'
                                 codeString += 'this->' + aliasB.name + '_' + self.pipes[i + 1].name + '[' + str(j) + '].propagateAlias(*(this->' + aliasB.name + '_' + self.pipes[i].name + '[' + str(j) + '].getPipeReg()));\n'
                                 codeString += '}\n'
-            # Now I have to produce the code for unlocking the registers in the unlockQueue
+            # Now I have to produce the code for unlocking the registers in the unlockQueue: only
+            # the current slot of the wheel is scanned, the registers with a delayed write back
+            # are in the following ones
             codeString += """
             // Finally registers are unlocked, so that stalls due to data hazards can be resolved
-            std::map<unsigned int, std::vector<Register *> >::iterator unlockQueueIter, unlockQueueEnd;
-            for(unlockQueueIter = BasePipeStage::unlockQueue.begin(), unlockQueueEnd = BasePipeStage::unlockQueue.end(); unlockQueueIter != unlockQueueEnd; unlockQueueIter++){
-                std::vector<Register *>::iterator regToUnlockIter, regToUnlockEnd;
-                if(unlockQueueIter->first == 0){
-                    for(regToUnlockIter = unlockQueueIter->second.begin(), regToUnlockEnd = unlockQueueIter->second.end(); regToUnlockIter != regToUnlockEnd; regToUnlockIter++){
-                        (*regToUnlockIter)->unlock();
-                    }
-                }
-                else{
-                    for(regToUnlockIter = unlockQueueIter->second.begin(), regToUnlockEnd = unlockQueueIter->second.end(); regToUnlockIter != regToUnlockEnd; regToUnlockIter++){
-                        (*regToUnlockIter)->unlock(unlockQueueIter->first);
-                    }
-                }
-                unlockQueueIter->second.clear();
+            std::vector<Register *> & regsToUnlock = BasePipeStage::unlockQueue.front();
+            std::vector<Register *>::iterator regToUnlockIter, regToUnlockEnd;
+            for(regToUnlockIter = regsToUnlock.begin(), regToUnlockEnd = regsToUnlock.end(); regToUnlockIter != regToUnlockEnd; regToUnlockIter++){
+                (*regToUnlockIter)->unlock();
             }
+            BasePipeStage::unlockQueue.advance();
             """
             refreshRegistersBody = cxx_writer.writer_code.Code(codeString)
             refreshRegistersDecl = cxx_writer.writer_code.Method('refreshRegisters', refreshRegistersBody, cxx_writer.writer_code.voidType, 'pri', noException = True)
@@ -757,6 +968,15 @@ def getGetPipelineStages(self, trace, combinedTrace, model, namespace):
             undumpedHistElemsAttribute = cxx_writer.writer_code.Attribute('undumpedHistElems', cxx_writer.writer_code.uintType, 'pu')
             curPipeElements.append(undumpedHistElemsAttribute)
             constructorCode += 'this->undumpedHistElems = 0;\n'
+            if self.cycleDriven:
+                # The state kept by the fetch thread across cycles has to be saved
+                # in the stage since cycle is called once per clock cycle
+                numNOPSAttribute = cxx_writer.writer_code.Attribute('numNOPS', cxx_writer.writer_code.uintType, 'pri')
+                curPipeElements.append(numNOPSAttribute)
+                constructorCode += 'this->numNOPS = 0;\n'
+                startMetAttribute = cxx_writer.writer_code.Attribute('startMet', cxx_writer.writer_code.boolType, 'pri')
+                curPipeElements.append(startMetAttribute)
+                constructorCode += 'this->startMet = false;\n'
             # Now, before the processor elements is destructed I have to make sure that the history dump file is correctly closed
             destrCode = """#ifdef ENABLE_HISTORY
             if(this->historyEnabled){
@@ -46,7 +46,7 @@ def getCPPExternalPorts(self, model, namespace):
     archHWordType = self.bitSizes[2]
     archByteType = self.bitSizes[3]
 
-    from procWriter import resourceType
+    from procWriter import resourceType, hasCodePages
 
     if self.isBigEndian:
         swapDEndianessCode = '#ifdef LITTLE_ENDIAN_BO\n'
@@ -85,6 +85,18 @@ def getCPPExternalPorts(self, model, namespace):
         this->debugger->notifyAddress(address, sizeof(datum));
     }
     """
+    # Writes to the pages holding cached instructions are notified to the
+    # processor, which drops these instructions (self modifying code)
+    checkCodePagesCode = ''
+    checkCodePagesBlockCode = ''
+    if hasCodePages(self, model):
+        CodePagesType = cxx_writer.writer_code.TemplateType('CodePages', [str(archWordType)], 'codePages.hpp')
+        tlmPortElements.append(cxx_writer.writer_code.Attribute('codePages', CodePagesType.makePointer(), 'pri'))
+        setCodePagesBody = cxx_writer.writer_code.Code('this->codePages = codePages;')
+        tlmPortElements.append(cxx_writer.writer_code.Method('setCodePages', setCodePagesBody, cxx_writer.writer_code.voidType, 'pu', [cxx_writer.writer_code.Parameter('codePages', CodePagesType.makePointer())]))
+        checkCodePagesCode = 'if(this->codePages != NULL){\nthis->codePages->notifyWrite(address, sizeof(datum));\n}\n'
+        checkCodePagesBlockCode = 'if(this->codePages != NULL){\nthis->codePages->notifyWrite(address, length);\n}\n'
+        checkWatchPointCode += checkCodePagesCode
 
     memIfType = cxx_writer.writer_code.Type('MemoryInterface', 'memory.hpp')
     tlm_dmiType = cxx_writer.writer_code.Type('tlm::tlm_dmi', 'tlm.h')
@@ -150,15 +162,20 @@ def getCPPExternalPorts(self, model, namespace):
 
     if model.endswith('LT'):
         readCode = """ datum = 0;
-            if (this->dmi_ptr_valid){
-                if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-                    SC_REPORT_ERROR("TLM-2", "Error in reading memory data through DMI: address out of bounds");
-                }
+            // The DMI region might not cover the whole address space (e.g. when
+            // the port is connected to a router): outside of it b_transport is used
+            if (this->dmi_ptr_valid && address >= this->dmi_data.get_start_address() && address + sizeof(datum) - 1 <= this->dmi_data.get_end_address()){
                 memcpy(&datum, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, sizeof(datum));
+            #ifdef ENABLE_PERF_COUNTERS
+            this->perfCounters.dmiHits++;
+            #endif
             """
         if not model.startswith('acc'):
             readCode += """this->quantKeeper.inc(this->dmi_data.get_read_latency());
             if(this->quantKeeper.need_sync()){
+                #ifdef ENABLE_PERF_COUNTERS
+                this->perfCounters.quantumSyncs++;
+                #endif
                 this->quantKeeper.sync();
             }
             """
@@ -182,6 +199,9 @@ def getCPPExternalPorts(self, model, namespace):
                 trans.set_byte_enable_ptr(0);
                 trans.set_dmi_allowed(false);
                 trans.set_response_status( tlm::TLM_INCOMPLETE_RESPONSE );
+                #ifdef ENABLE_PERF_COUNTERS
+                this->perfCounters.transportCalls++;
+                #endif
                 this->initSocket->b_transport(trans, delay);
 
                 if(trans.is_response_error()){
@@ -197,6 +217,9 @@ def getCPPExternalPorts(self, model, namespace):
         if not model.startswith('acc'):
             readCode += """this->quantKeeper.set(delay);
                 if(this->quantKeeper.need_sync()){
+                    #ifdef ENABLE_PERF_COUNTERS
+                    this->perfCounters.quantumSyncs++;
+                    #endif
                     this->quantKeeper.sync();
                 }
             }
@@ -224,6 +247,9 @@ def getCPPExternalPorts(self, model, namespace):
         sc_time delay = SC_ZERO_TIME;
         tlm::tlm_phase phase = tlm::BEGIN_REQ;
         tlm::tlm_sync_enum status;
+        #ifdef ENABLE_PERF_COUNTERS
+        this->perfCounters.transportCalls++;
+        #endif
         status = initSocket->nb_transport_fw(trans, phase, delay);
 
         if(trans.is_response_error()){
@@ -260,6 +286,100 @@ def getCPPExternalPorts(self, model, namespace):
     readBody = cxx_writer.writer_code.Code(readMemAliasCode + str(archWordType) + readCode + swapEndianessCode + '\nreturn datum;')
     readDecl = cxx_writer.writer_code.Method('read_word', readBody, archWordType, 'pu', [addressParam], inline = True, noException = True)
     tlmPortElements.append(readDecl)
+    if model.endswith('AT') and self.fetchBuffer:
+        # Instruction fetch through the fetch buffer: a whole line is read with
+        # a single transaction and the sequential fetches are then served
+        # from the buffer. Non sequential fetches (i.e. taken branches) and writes
+        # to the buffered line invalidate the buffer
+        lineSize = self.fetchBuffer[0]
+        lineMask = hex(lineSize - 1)
+        fetchCode = 'if((address & ' + lineMask + ') + sizeof(' + str(archWordType) + ') > ' + str(lineSize) + '){\n'
+        fetchCode += """// The instruction crosses the line boundary
+            return this->read_word(address);
+        }
+        """
+        fetchCode += 'if(!this->fetchBufferValid || address != this->fetchNextAddress || (address & ~' + lineMask + ') != this->fetchBufferAddress){\n'
+        fetchCode += 'this->fetch_line(address & ~' + lineMask + ');\n}\n'
+        fetchCode += str(archWordType) + ' datum;\nmemcpy(&datum, this->fetchBuffer + (address & ' + lineMask + '), sizeof(datum));\n'
+        fetchCode += 'this->fetchNextAddress = address + sizeof(datum);\n'
+        fetchBody = cxx_writer.writer_code.Code(readMemAliasCode + fetchCode + swapEndianessCode + '\nreturn datum;')
+        fetchDecl = cxx_writer.writer_code.Method('fetch_word', fetchBody, archWordType, 'pu', [addressParam], inline = True, noException = True)
+        tlmPortElements.append(fetchDecl)
+
+        fetchLineCode = """tlm::tlm_generic_payload trans;
+        trans.set_address(lineAddress);
+        trans.set_read();
+        trans.set_data_ptr(this->fetchBuffer);
+        """
+        fetchLineCode += 'trans.set_data_length(' + str(lineSize) + ');\ntrans.set_streaming_width(' + str(lineSize) + ');\n'
+        fetchLineCode += """trans.set_byte_enable_ptr(0);
+        trans.set_dmi_allowed(false);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        if(this->request_in_progress != NULL){
+            wait(this->end_request_event);
+        }
+        request_in_progress = &trans;
+
+        // Non-blocking transport call on the forward path
+        sc_time delay = SC_ZERO_TIME;
+        tlm::tlm_phase phase = tlm::BEGIN_REQ;
+        tlm::tlm_sync_enum status;
+        #ifdef ENABLE_PERF_COUNTERS
+        this->perfCounters.transportCalls++;
+        #endif
+        status = initSocket->nb_transport_fw(trans, phase, delay);
+
+        if(trans.is_response_error()){
+            std::string errorStr("Error from nb_transport_fw, response status = " + trans.get_response_string());
+            SC_REPORT_ERROR("TLM-2", errorStr.c_str());
+        }
+
+        // Check value returned from nb_transport_fw
+        if(status == tlm::TLM_UPDATED){
+            // The timing annotation must be honored
+            m_peq.notify(trans, phase, delay);
+            wait(this->end_response_event);
+        }
+        else if(status == tlm::TLM_COMPLETED){
+            // The completion of the transaction necessarily ends the BEGIN_REQ phase
+            this->request_in_progress = NULL;
+            // The target has terminated the transaction, I check the correctness
+            if(trans.is_response_error()){
+                SC_REPORT_ERROR("TLM-2", ("Transaction returned with error, response status = " + trans.get_response_string()).c_str());
+            }
+        }
+        else{
+            wait(this->end_response_event);
+        }
+        """
+        if self.fetchBuffer[1] > 0 and lineSize > self.wordSize:
+            fetchLineCode += '// The target latency accounts for the first word, the others are transferred in burst\n'
+            fetchLineCode += 'wait(' + str(self.fetchBuffer[1]*(lineSize/self.wordSize - 1)) + ', SC_NS);\n'
+        fetchLineCode += 'this->fetchBufferAddress = lineAddress;\nthis->fetchBufferValid = true;\n'
+        fetchLineBody = cxx_writer.writer_code.Code(fetchLineCode)
+        lineAddressParam = cxx_writer.writer_code.Parameter('lineAddress', archWordType.makeRef().makeConst())
+        fetchLineDecl = cxx_writer.writer_code.Method('fetch_line', fetchLineBody, cxx_writer.writer_code.voidType, 'pri', [lineAddressParam], noException = True)
+        tlmPortElements.append(fetchLineDecl)
+
+        snoopCode = 'if(this->fetchBufferPort->fetchBufferValid && (((address & ~' + lineMask + ') == this->fetchBufferPort->fetchBufferAddress) ||\n'
+        snoopCode += '(((address + size - 1) & ~' + lineMask + ') == this->fetchBufferPort->fetchBufferAddress))){\n'
+        snoopCode += 'this->fetchBufferPort->fetchBufferValid = false;\n}\n'
+        snoopBody = cxx_writer.writer_code.Code(snoopCode)
+        sizeParam = cxx_writer.writer_code.Parameter('size', cxx_writer.writer_code.uintType)
+        snoopDecl = cxx_writer.writer_code.Method('snoop_fetch_buffer', snoopBody, cxx_writer.writer_code.voidType, 'pri', [addressParam, sizeParam], inline = True, noException = True)
+        tlmPortElements.append(snoopDecl)
+        # Writes performed through the data ports also have to invalidate the
+        # buffer of the fetch port
+        setFetchBufferPortBody = cxx_writer.writer_code.Code('this->fetchBufferPort = fetchBufferPort;')
+        setFetchBufferPortDecl = cxx_writer.writer_code.Method('setFetchBufferPort', setFetchBufferPortBody, cxx_writer.writer_code.voidType, 'pu', [cxx_writer.writer_code.Parameter('fetchBufferPort', TLMMemoryType.makePointer())])
+        tlmPortElements.append(setFetchBufferPortDecl)
+        tlmPortElements.append(cxx_writer.writer_code.Attribute('fetchBuffer[' + str(lineSize) + ']', cxx_writer.writer_code.ucharType, 'pri'))
+        tlmPortElements.append(cxx_writer.writer_code.Attribute('fetchBufferAddress', archWordType, 'pri'))
+        tlmPortElements.append(cxx_writer.writer_code.Attribute('fetchNextAddress', archWordType, 'pri'))
+        tlmPortElements.append(cxx_writer.writer_code.Attribute('fetchBufferValid', cxx_writer.writer_code.boolType, 'pri'))
+        tlmPortElements.append(cxx_writer.writer_code.Attribute('fetchBufferPort', TLMMemoryType.makePointer(), 'pri'))
+        checkWatchPointCode += 'this->snoop_fetch_buffer(address, sizeof(datum));\n'
     readMemAliasCode = ''
     for alias in self.memAlias:
         readMemAliasCode += 'if(address == ' + hex(long(alias.address)) + '){\n' + str(archWordType) + ' ' + alias.alias + '_temp = this->' + alias.alias + ';\n' + swapEndianessDefine + 'this->swapEndianess(' + alias.alias + '_temp);\n#endif\nreturn (' + str(archHWordType) + ')' + alias.alias + '_temp;\n}\n'
@@ -278,15 +398,18 @@ def getCPPExternalPorts(self, model, namespace):
     tlmPortElements.append(readDecl)
     writeCode = ''
     if model.endswith('LT'):
-        writeCode += """if(this->dmi_ptr_valid){
-                if(address + this->dmi_data.get_start_address() > this->dmi_data.get_end_address()){
-                    SC_REPORT_ERROR("TLM-2", "Error in writing memory data through DMI: address out of bounds");
-                }
+        writeCode += """if(this->dmi_ptr_valid && address >= this->dmi_data.get_start_address() && address + sizeof(datum) - 1 <= this->dmi_data.get_end_address()){
                 memcpy(this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, &datum, sizeof(datum));
+            #ifdef ENABLE_PERF_COUNTERS
+            this->perfCounters.dmiHits++;
+            #endif
             """
         if not model.startswith('acc'):
             writeCode += """this->quantKeeper.inc(this->dmi_data.get_write_latency());
             if(this->quantKeeper.need_sync()){
+                #ifdef ENABLE_PERF_COUNTERS
+                this->perfCounters.quantumSyncs++;
+                #endif
                 this->quantKeeper.sync();
             }"""
         else:
@@ -309,6 +432,9 @@ def getCPPExternalPorts(self, model, namespace):
                 trans.set_byte_enable_ptr(0);
                 trans.set_dmi_allowed(false);
                 trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+                #ifdef ENABLE_PERF_COUNTERS
+                this->perfCounters.transportCalls++;
+                #endif
                 this->initSocket->b_transport(trans, delay);
 
                 if(trans.is_response_error()){
@@ -324,6 +450,9 @@ def getCPPExternalPorts(self, model, namespace):
         if not model.startswith('acc'):
             writeCode += """this->quantKeeper.set(delay);
                 if(this->quantKeeper.need_sync()){
+                    #ifdef ENABLE_PERF_COUNTERS
+                    this->perfCounters.quantumSyncs++;
+                    #endif
                     this->quantKeeper.sync();
                 }
             }
@@ -350,6 +479,9 @@ def getCPPExternalPorts(self, model, namespace):
         sc_time delay = SC_ZERO_TIME;
         tlm::tlm_phase phase = tlm::BEGIN_REQ;
         tlm::tlm_sync_enum status;
+        #ifdef ENABLE_PERF_COUNTERS
+        this->perfCounters.transportCalls++;
+        #endif
         status = initSocket->nb_transport_fw(trans, phase, delay);
 
         if(trans.is_response_error()){
@@ -454,6 +586,9 @@ def getCPPExternalPorts(self, model, namespace):
         trans.set_address(address);
         trans.set_write();
         """
+    if model.endswith('AT') and self.fetchBuffer:
+        writeCode1 = 'this->snoop_fetch_buffer(address, sizeof(datum));\n' + writeCode1
+    writeCode1 = checkCodePagesCode + writeCode1
     writeCode2 = """trans.set_data_ptr((unsigned char *)&datum);
         this->initSocket->transport_dbg(trans);
         """
@@ -499,6 +634,49 @@ def getCPPExternalPorts(self, model, namespace):
     writeDecl = cxx_writer.writer_code.Method('write_byte_dbg', writeBody, cxx_writer.writer_code.voidType, 'pu', [addressParam, datumParam], noException = True)
     tlmPortElements.append(writeDecl)
 
+    # Block transfers: a single memcpy when the whole block lies inside the
+    # DMI region, otherwise a single debug transaction for the whole block.
+    # With memory aliases the byte-wise implementation of the base class is
+    # used, so that the aliased addresses are honored
+    if not self.memAlias:
+        readBlockCode = ''
+        writeBlockCode = checkCodePagesBlockCode
+        if model.endswith('LT'):
+            readBlockCode += """if(this->dmi_ptr_valid && address >= this->dmi_data.get_start_address() && address + length - 1 <= this->dmi_data.get_end_address()){
+                memcpy(buffer, this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, length);
+                return;
+            }
+            """
+            writeBlockCode += """if(this->dmi_ptr_valid && address >= this->dmi_data.get_start_address() && address + length - 1 <= this->dmi_data.get_end_address()){
+                memcpy(this->dmi_data.get_dmi_ptr() - this->dmi_data.get_start_address() + address, buffer, length);
+                return;
+            }
+            """
+        elif self.fetchBuffer:
+            writeBlockCode += 'this->snoop_fetch_buffer(address, length);\n'
+        writeBlockCode += """tlm::tlm_generic_payload trans;
+            trans.set_address(address);
+            trans.set_write();
+            """
+        blockTransCode = """trans.set_data_length(length);
+            trans.set_streaming_width(length);
+            if(this->initSocket->transport_dbg(trans) < length){
+                THROW_ERROR("Debug transaction of " << length << " bytes at address " << std::hex << std::showbase << address << " not completed");
+            }
+            """
+        readBlockCode += readCode1 + 'trans.set_data_ptr(buffer);\n' + blockTransCode
+        writeBlockCode += 'trans.set_data_ptr(const_cast<unsigned char *>(buffer));\n' + blockTransCode
+        lengthParam = cxx_writer.writer_code.Parameter('length', cxx_writer.writer_code.uintType)
+        readBlockBody = cxx_writer.writer_code.Code(readBlockCode)
+        readBlockBody.addInclude('cstring')
+        bufferParam = cxx_writer.writer_code.Parameter('buffer', cxx_writer.writer_code.ucharPtrType)
+        readBlockDecl = cxx_writer.writer_code.Method('read_block_dbg', readBlockBody, cxx_writer.writer_code.voidType, 'pu', [addressParam, bufferParam, lengthParam])
+        tlmPortElements.append(readBlockDecl)
+        writeBlockBody = cxx_writer.writer_code.Code(writeBlockCode)
+        bufferParam = cxx_writer.writer_code.Parameter('buffer', cxx_writer.writer_code.ucharPtrType.makeConst())
+        writeBlockDecl = cxx_writer.writer_code.Method('write_block_dbg', writeBlockBody, cxx_writer.writer_code.voidType, 'pu', [addressParam, bufferParam, lengthParam])
+        tlmPortElements.append(writeBlockDecl)
+
     lockDecl = cxx_writer.writer_code.Method('lock', emptyBody, cxx_writer.writer_code.voidType, 'pu')
     tlmPortElements.append(lockDecl)
     unlockDecl = cxx_writer.writer_code.Method('unlock', emptyBody, cxx_writer.writer_code.voidType, 'pu')
@@ -508,7 +686,13 @@ def getCPPExternalPorts(self, model, namespace):
     tlmPortInit.append('sc_module(portName)')
     initSockAttr = cxx_writer.writer_code.Attribute('initSocket', tlminitsocketType, 'pu')
     tlmPortElements.append(initSockAttr)
+    # Accesses served through DMI and through transport calls, updated only
+    # when the simulator is compiled with ENABLE_PERF_COUNTERS
+    perfCountersAttr = cxx_writer.writer_code.Attribute('perfCounters', cxx_writer.writer_code.Type('PortCounters', 'perfCounters.hpp'), 'pu')
+    tlmPortElements.append(perfCountersAttr)
     constructorCode = 'this->debugger = NULL;\n'
+    if hasCodePages(self, model):
+        constructorCode += 'this->codePages = NULL;\n'
     if model.endswith('LT'):
         if not model.startswith('acc'):
             quantumKeeperType = cxx_writer.writer_code.Type('tlm_utils::tlm_quantumkeeper', 'tlm_utils/tlm_quantumkeeper.h')
@@ -521,11 +705,27 @@ def getCPPExternalPorts(self, model, namespace):
         dmi_dataAttribute = cxx_writer.writer_code.Attribute('dmi_data', tlm_dmiType, 'pri')
         tlmPortElements.append(dmi_dataAttribute)
         constructorCode += 'this->dmi_ptr_valid = false;\n'
+        constructorCode += 'this->initSocket.register_invalidate_direct_mem_ptr(this, &TLMMemory::invalidate_direct_mem_ptr);\n'
+        # Method called by the targets (or by the routers) when the DMI region is not valid anymore
+        invalidateCode = """if(this->dmi_ptr_valid && start_range <= this->dmi_data.get_end_address() && end_range >= this->dmi_data.get_start_address()){
+            this->dmi_ptr_valid = false;
+        }
+        """
+        invalidateBody = cxx_writer.writer_code.Code(invalidateCode)
+        startRangeParam = cxx_writer.writer_code.Parameter('start_range', cxx_writer.writer_code.Type('sc_dt::uint64', 'systemc.h'))
+        endRangeParam = cxx_writer.writer_code.Parameter('end_range', cxx_writer.writer_code.Type('sc_dt::uint64', 'systemc.h'))
+        invalidateDecl = cxx_writer.writer_code.Method('invalidate_direct_mem_ptr', invalidateBody, cxx_writer.writer_code.voidType, 'pu', [startRangeParam, endRangeParam], noException = True)
+        tlmPortElements.append(invalidateDecl)
     else:
         peqType = cxx_writer.writer_code.TemplateType('tlm_utils::peq_with_cb_and_phase', [TLMMemoryType], 'tlm_utils/peq_with_cb_and_phase.h')
         tlmPortElements.append(cxx_writer.writer_code.Attribute('m_peq', peqType, 'pri'))
         tlmPortInit.append('m_peq(this, &TLMMemory::peq_cb)')
         tlmPortInit.append('request_in_progress(NULL)')
+        if self.fetchBuffer:
+            tlmPortInit.append('fetchBufferAddress(0)')
+            tlmPortInit.append('fetchNextAddress(0)')
+            tlmPortInit.append('fetchBufferValid(false)')
+            tlmPortInit.append('fetchBufferPort(this)')
         constructorCode += """// Register callbacks for incoming interface method calls
             this->initSocket.register_nb_transport_bw(this, &TLMMemory::nb_transport_bw);
             """
@@ -539,9 +739,11 @@ def getCPPExternalPorts(self, model, namespace):
 
     return extPortDecl
 
-def getGetIRQPorts(self, namespace):
+def getGetIRQPorts(self, model, namespace):
     """Returns the classes implementing the interrupt ports; there can
-    be two different kind of ports: systemc based or TLM based"""
+    be two different kind of ports: systemc based or TLM based.
+    In the functional models the ports also signal the raised interrupt
+    in the word of pending events of the processor"""
     TLMWidth = []
     SyscWidth = []
     for i in self.irqs:
@@ -571,10 +773,15 @@ def getGetIRQPorts(self, namespace):
             else{
                 //Raise the interrupt
                 this->irqSignal = adr;
-            }
+        """
+        if not model.startswith('acc'):
+            blockTransportCode += 'this->pendingEvents |= trap::PENDING_IRQ;\n'
+        blockTransportCode += """}
             trans.set_response_status(tlm::TLM_OK_RESPONSE);
         """
         blockTransportBody = cxx_writer.writer_code.Code(blockTransportCode)
+        if not model.startswith('acc'):
+            blockTransportBody.addInclude('pendingEvents.hpp')
         tagParam = cxx_writer.writer_code.Parameter('tag', cxx_writer.writer_code.intType)
         payloadParam = cxx_writer.writer_code.Parameter('trans', payloadType.makeRef())
         delayParam = cxx_writer.writer_code.Parameter('delay', cxx_writer.writer_code.sc_timeType.makeRef())
@@ -600,14 +807,21 @@ def getGetIRQPorts(self, namespace):
         widthType = resolveBitType('BIT<' + str(width) + '>')
         irqSignalAttr = cxx_writer.writer_code.Attribute('irqSignal', widthType.makeRef(), 'pu')
         tlmPortElements.append(irqSignalAttr)
+        if not model.startswith('acc'):
+            pendingEventsAttr = cxx_writer.writer_code.Attribute('pendingEvents', cxx_writer.writer_code.uintType.makeRef(), 'pu')
+            tlmPortElements.append(pendingEventsAttr)
         constructorCode = ''
         tlmPortInit = []
         constructorParams = []
         constructorParams.append(cxx_writer.writer_code.Parameter('portName', cxx_writer.writer_code.sc_module_nameType))
         constructorParams.append(cxx_writer.writer_code.Parameter('irqSignal', widthType.makeRef()))
+        # The members are initialized in the same order they are declared
         tlmPortInit.append('sc_module(portName)')
-        tlmPortInit.append('irqSignal(irqSignal)')
         tlmPortInit.append('socket(portName)')
+        tlmPortInit.append('irqSignal(irqSignal)')
+        if not model.startswith('acc'):
+            constructorParams.append(cxx_writer.writer_code.Parameter('pendingEvents', cxx_writer.writer_code.uintType.makeRef()))
+            tlmPortInit.append('pendingEvents(pendingEvents)')
         constructorCode += 'this->socket.register_b_transport(this, &IntrTLMPort_' + str(width) + '::b_transport);\n'
         constructorCode += 'this->socket.register_transport_dbg(this, &IntrTLMPort_' + str(width) + '::transport_dbg);\n'
         constructorCode += 'this->socket.register_nb_transport_fw(this, &IntrTLMPort_' + str(width) + '::nb_transport_fw);\n'
@@ -622,13 +836,20 @@ def getGetIRQPorts(self, namespace):
         widthSignalType = cxx_writer.writer_code.TemplateType('sc_signal', [widthType], 'systemc.h')
         systemcPortElements = []
         sensitiveMethodCode = 'this->irqSignal = this->recvIntr.read();'
+        if not model.startswith('acc'):
+            sensitiveMethodCode += '\nthis->pendingEvents |= trap::PENDING_IRQ;'
         sensitiveMethodBody = cxx_writer.writer_code.Code(sensitiveMethodCode)
+        if not model.startswith('acc'):
+            sensitiveMethodBody.addInclude('pendingEvents.hpp')
         sensitiveMethodDecl = cxx_writer.writer_code.Method('irqRecvMethod', sensitiveMethodBody, cxx_writer.writer_code.voidType, 'pu')
         systemcPortElements.append(sensitiveMethodDecl)
         signalAttr = cxx_writer.writer_code.Attribute('recvIntr', widthSignalType, 'pu')
         systemcPortElements.append(signalAttr)
         irqSignalAttr = cxx_writer.writer_code.Attribute('irqSignal', widthType.makeRef(), 'pu')
         tlmPortElements.append(irqSignalAttr)
+        if not model.startswith('acc'):
+            pendingEventsAttr = cxx_writer.writer_code.Attribute('pendingEvents', cxx_writer.writer_code.uintType.makeRef(), 'pu')
+            systemcPortElements.append(pendingEventsAttr)
         constructorCode = ''
         tlmPortInit = []
         constructorParams = []
@@ -636,6 +857,9 @@ def getGetIRQPorts(self, namespace):
         constructorParams.append(cxx_writer.writer_code.Parameter('irqSignal', widthType.makeRef()))
         tlmPortInit.append('sc_module(portName)')
         tlmPortInit.append('irqSignal(irqSignal)')
+        if not model.startswith('acc'):
+            constructorParams.append(cxx_writer.writer_code.Parameter('pendingEvents', cxx_writer.writer_code.uintType.makeRef()))
+            tlmPortInit.append('pendingEvents(pendingEvents)')
         constructorCode += 'SC_METHOD();\nsensitive << this->recvIntr;\n'
         irqPortDecl = cxx_writer.writer_code.ClassDeclaration('IntrSysCPort_' + str(width), systemcPortElements, [cxx_writer.writer_code.sc_moduleType], namespaces = [namespace])
         constructorBody = cxx_writer.writer_code.Code(constructorCode + 'end_module();')
@@ -838,6 +1062,18 @@ def getIRQTests(self, trace, combinedTrace, namespace):
                 else:
                     aliasInit += alias.name + '[' + str(curIndex) + '].updateAlias(' + curAlias + ');\n'
                     curIndex += 1
+        try:
+            windows = alias.windows
+        except AttributeError:
+            windows = []
+        if windows:
+            from procWriter import getAliasWindowsCode
+            tables, bases, windowsCode = getAliasWindowsCode(self, alias, '')
+            for tableName, tableSize in tables:
+                aliasInit += namespace + '::Register * ' + tableName + '[' + str(tableSize) + '];\n'
+            for baseName, initBase in bases:
+                aliasInit += 'unsigned int ' + baseName + ';\n'
+            aliasInit += windowsCode
 
     for irq in self.irqs:
         from isa import resolveBitType
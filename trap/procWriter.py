@@ -100,27 +100,45 @@ hash_map_include = """
 #endif
 """
 
+# Computes the code tracing an executed instruction: the binary trace
+# is used when its file is open, otherwise the textual one
+def getTraceCode(instrVarName, skipped):
+    return """if(this->traceWriter.isOpen()){
+            this->traceWriter.beginRecord(curPC, """ + instrVarName + """->getId(), """ + skipped + """);
+            """ + instrVarName + """->traceRegisters(this->traceWriter);
+            this->traceWriter.endRecord();
+        }
+        else{
+        """
+
 # Computes the code defining the execution of an instruction and
 # of the processor tools.
 def getInstrIssueCode(self, trace, combinedTrace, instrVarName, hasCheckHazard = False, pipeStage = None, checkDestroyCode = ''):
     codeString = """try{
+            #ifdef ENABLE_PERF_COUNTERS
+            this->perfCounters.enterPhase(PHASE_TOOLS);
+            #endif
             #ifndef DISABLE_TOOLS
-            if(!(this->toolManager.newIssue(curPC, """ + instrVarName + """))){
+            if((this->pendingEvents & PENDING_TOOLS) == 0 || !(this->toolManager.newIssue(curPC, """ + instrVarName + """))){
+            #endif
+            #ifdef ENABLE_PERF_COUNTERS
+            this->perfCounters.enterPhase(PHASE_BEHAVIOR);
             #endif
             numCycles = """ + instrVarName + """->behavior();
     """
     if trace:
-        codeString += instrVarName + '->printTrace();\n'
+        codeString += getTraceCode(instrVarName, 'false') + instrVarName + '->printTrace();\n}\n'
     codeString += '#ifndef DISABLE_TOOLS\n}\n'
     if trace:
-        codeString += """else{
-            std::cerr << "Not executed Instruction because Tools anulled it" << std::endl << std::endl;
+        codeString += 'else{\n' + getTraceCode(instrVarName, 'true') + """std::cerr << "Not executed Instruction because Tools anulled it" << std::endl << std::endl;
+            }
         }
         """
     codeString +='#endif\n}\ncatch(annull_exception &etc){\n'
     if trace:
-        codeString += instrVarName + """->printTrace();
+        codeString += getTraceCode(instrVarName, 'true') + instrVarName + """->printTrace();
                 std::cerr << "Skipped Instruction " << """ + instrVarName + """->getInstructionName() << std::endl << std::endl;
+            }
         """
     codeString += """numCycles = 0;
         }
@@ -195,7 +213,7 @@ def getInstrIssueCodePipe(self, trace, combinedTrace, instrVarName, hasCheckHaza
     return codeString
 
 # Computes the code for the fetch address
-def computeFetchCode(self):
+def computeFetchCode(self, model):
     fetchCode = str(self.bitSizes[1]) + ' bitString = this->'
     # Now I have to check what is the fetch: if there is a TLM port or
     # if I have to access local memory
@@ -208,7 +226,11 @@ def computeFetchCode(self):
                 fetchCode += name
         if fetchCode.endswith('this->'):
             raise Exception('No TLM port was chosen for the instruction fetch and not internal memory defined')
-    fetchCode += '.read_word(curPC);\n'
+    if model.endswith('AT') and self.fetchBuffer and not self.memory:
+        # The fetch port reads whole lines and buffers them
+        fetchCode += '.fetch_word(curPC);\n'
+    else:
+        fetchCode += '.read_word(curPC);\n'
     return fetchCode
 
 # Computes current program counter, in order to fetch
@@ -226,10 +248,16 @@ def computeCurrentPC(self, model):
 def getInterruptCode(self, trace, pipeStage = None):
     interruptCode = ''
     orderedIrqList = sorted(self.irqs, lambda x,y: cmp(y.priority, x.priority))
+    if self.irqs and not pipeStage:
+        # Functional processors: the interrupt lines are examined only if some
+        # port signalled a raised interrupt in the word of pending events
+        interruptCode += 'bool irqPending = (this->pendingEvents & PENDING_IRQ) != 0;\n'
     for irqPort in orderedIrqList:
         if irqPort != orderedIrqList[0]:
             interruptCode += 'else '
         interruptCode += 'if('
+        if not pipeStage:
+            interruptCode += 'irqPending && '
         if(irqPort.condition):
             interruptCode += '('
         interruptCode += irqPort.name + ' != -1'
@@ -244,6 +272,8 @@ def getInterruptCode(self, trace, pipeStage = None):
         if trace:
             interruptCode += 'std::cerr << "Received interrupt " << std::hex << std::showbase << IRQ << std::endl;'
         interruptCode += 'this->' + irqPort.name + '_irqInstr->setInterruptValue(' + irqPort.name + ');\n'
+        if not pipeStage:
+            interruptCode += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.interrupts++;\n#endif\n'
         interruptCode += 'try{\n'
         if pipeStage:
             interruptCode += 'numCycles = this->' + irqPort.name + '_irqInstr->behavior_' + pipeStage.name + '(BasePipeStage::unlockQueue);\n'
@@ -261,6 +291,11 @@ def getInterruptCode(self, trace, pipeStage = None):
         interruptCode += '\n}\n'
     if self.irqs:
         interruptCode += 'else{\n'
+        if not pipeStage:
+            # Once all the lines are found lowered there is no need to check them any more,
+            # until one of the ports raises an interrupt again
+            interruptCode += 'if(irqPending && ' + ' && '.join([irqPort.name + ' == -1' for irqPort in orderedIrqList]) + '){\n'
+            interruptCode += 'this->pendingEvents &= ~PENDING_IRQ;\n}\n'
     return interruptCode
 
 # Returns the code necessary for performing a standard instruction fetch: i.e.
@@ -291,7 +326,7 @@ def standardInstrFetch(self, trace, combinedTrace, issueCodeGenerator, hasCheckH
     codeString += issueCodeGenerator(self, trace, combinedTrace, 'instr', hasCheckHazard, pipeStage, checkDestroyCode)
     return codeString
 
-def fetchWithCacheCode(self, fetchCode, trace, combinedTrace, issueCodeGenerator, hasCheckHazard = False, pipeStage = None):
+def fetchWithCacheCode(self, fetchCode, trace, combinedTrace, issueCodeGenerator, hasCheckHazard = False, pipeStage = None, fused = False):
     codeString = ''
     if self.fastFetch:
         mapKey = 'curPC'
@@ -305,6 +340,33 @@ def fetchWithCacheCode(self, fetchCode, trace, combinedTrace, issueCodeGenerator
         // I can call the instruction, I have found it
         if(curInstrPtr != NULL){
     """
+    if not pipeStage:
+        codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.cacheHits++;\n#endif\n'
+    if fused:
+        # The sequence of instructions starting at the current address might have been
+        # fused into a superinstruction: it is used only when no event or tool needs to
+        # examine the single instructions
+        codeString += """FusedInstruction * curFusedPtr = cachedInstr->second.fused;
+        bool useFused = curFusedPtr != NULL && this->pendingEvents == 0;
+        #ifdef ENABLE_HISTORY
+        useFused = useFused && !this->historyEnabled;
+        #endif
+        if(useFused){
+            unsigned int numFused = 0;
+            #ifdef ENABLE_PERF_COUNTERS
+            this->perfCounters.enterPhase(PHASE_BEHAVIOR);
+            #endif
+            numCycles = curFusedPtr->behavior(curPC, this->pendingEvents, numFused);
+            // Each instruction of the sequence accounts for its cycles and for the
+            // one added to every instruction by the main loop
+            numCycles += numFused - 1;
+            this->numInstructions += numFused - 1;
+            #ifdef ENABLE_PERF_COUNTERS
+            this->perfCounters.instructions += numFused - 1;
+            #endif
+        }
+        else{
+        """
 
     # Here we add the details about the instruction to the current history element
     codeString += """#ifdef ENABLE_HISTORY
@@ -324,20 +386,33 @@ def fetchWithCacheCode(self, fetchCode, trace, combinedTrace, issueCodeGenerator
         codeString += 'curInstrPtr->inPipeline = true;\n'
         codeString += 'curInstrPtr->fetchPC = curPC;\n'
     codeString += issueCodeGenerator(self, trace, combinedTrace, 'curInstrPtr', hasCheckHazard, pipeStage)
+    if fused:
+        codeString += '}\n'
 
     # I have found the element in the cache, but not the instruction
     codeString += '}\nelse{\n'
     if self.fastFetch:
         codeString += fetchCode
     codeString += 'unsigned int & curCount = cachedInstr->second.count;\n'
+    if not pipeStage:
+        codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.cacheMisses++;\n#endif\n'
     codeString += standardInstrFetch(self, trace, combinedTrace, issueCodeGenerator, hasCheckHazard, pipeStage, ' && curCount < ' + str(self.cacheLimit))
     codeString += """if(curCount < """ + str(self.cacheLimit) + """){
             curCount++;
         }
         else{
             // ... and then add the instruction to the cache
-            cachedInstr->second.instr = instr;
     """
+    if not pipeStage:
+        # A copy of the instruction is kept in the cache, allocated in the arena
+        codeString += """Instruction * cachedInstrPtr = instr->replicate(&this->instrArena);
+            cachedInstrPtr->setParams(bitString);
+            cachedInstr->second.instr = cachedInstrPtr;
+        """
+    else:
+        codeString += 'cachedInstr->second.instr = instr;\n'
+    if not pipeStage:
+        codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.cachePromotions++;\n#endif\n'
     if pipeStage:
         codeString += """if(instr->toDestroy){
                 instr->toDestroy = false;
@@ -346,8 +421,18 @@ def fetchWithCacheCode(self, fetchCode, trace, combinedTrace, issueCodeGenerator
             """
         codeString += 'this->INSTRUCTIONS[instrId] = instr->replicate();\n'
         codeString += '}\n'
-    else:
-        codeString += 'this->INSTRUCTIONS[instrId] = instr->replicate();\n'
+    if self.fastFetch and not pipeStage:
+        codeString += 'this->codePages.addCachedInstr(curPC);\n'
+    if fused:
+        codeString += 'this->fuseInstructions(curPC, bitString, cachedInstr->second);\n'
+    if not pipeStage:
+        # Once the arena is full the whole cache is dropped, the instructions
+        # executed from now on being cached again
+        codeString += """if(this->instrArena.isFull()){
+                this->flushInstrCache();
+                instrCacheEnd = this->instrCache.end();
+            }
+        """
     codeString += '}\n'
 
     # and now finally I have found nothing and I have to add everything
@@ -357,13 +442,31 @@ def fetchWithCacheCode(self, fetchCode, trace, combinedTrace, issueCodeGenerator
         // The current instruction is not present in the cache:
         // I have to perform the normal decoding phase ...
     """
+    if not pipeStage:
+        codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.cacheMisses++;\n#endif\n'
     if self.fastFetch:
         codeString += fetchCode
+    if self.fastFetch and not pipeStage:
+        # The cache is indexed by address: the routines emulated by the OS emulator are bound to the
+        # instruction found at their address when it is decoded, so that no other address pays for them
+        fetchWordType = str(self.bitSizes[1])
+        codeString += 'template_map< ' + fetchWordType + ', ToolsIf< ' + fetchWordType + ' > * >::const_iterator emulatedCall = this->emulatedCalls.find(curPC);\n'
+        codeString += 'if(emulatedCall != this->emulatedCalls.end()){\n'
+        codeString += 'Instruction * curInstrPtr = this->INSTRUCTIONS[this->decoder.decode(bitString)]->replicate();\n'
+        codeString += 'curInstrPtr->setParams(bitString);\n'
+        codeString += 'curInstrPtr = new EmulatedCallInstr(' + baseInstrInitElement + ', curInstrPtr, *(emulatedCall->second), curPC);\n'
+        codeString += 'this->instrCache.insert(std::pair< ' + fetchWordType + ', CacheElem >(curPC, CacheElem(curInstrPtr, ' + str(self.cacheLimit) + ')));\n'
+        codeString += 'instrCacheEnd = this->instrCache.end();\n'
+        codeString += 'this->codePages.addCachedInstr(curPC);\n'
+        codeString += issueCodeGenerator(self, trace, combinedTrace, 'curInstrPtr', hasCheckHazard, pipeStage)
+        codeString += '}\nelse{\n'
     codeString += standardInstrFetch(self, trace, combinedTrace, issueCodeGenerator, hasCheckHazard, pipeStage)
-    codeString += """this->instrCache.insert(std::pair< unsigned int, CacheElem >(bitString, CacheElem()));
+    codeString += """this->instrCache.insert(std::pair< unsigned int, CacheElem >(""" + mapKey + """, CacheElem()));
         instrCacheEnd = this->instrCache.end();
         }
     """
+    if self.fastFetch and not pipeStage:
+        codeString += '}\n'
     return codeString
 
 def createPipeStage(self, processorElements, initElements):
@@ -551,6 +654,57 @@ def procInitCode(self, model):
         initString += 'this->' + irqPort.name + ' = -1;\n'
     return initString
 
+def getAliasWindowsCode(self, aliasB, prefix):
+    """Returns the tables of register pointers and the window bases (as pairs
+    of name and size, and of name and initial value) used by the windows of
+    alias bank aliasB together with the code initializing them and connecting
+    the aliases of each window; prefix is prepended to the names of the
+    processor elements"""
+    from processor import extractRegInterval
+    # Register initially referred by each alias of the bank
+    initRegs = []
+    initAliases = aliasB.initAlias
+    if isinstance(initAliases, type('')):
+        initAliases = [initAliases]
+    for curAlias in initAliases:
+        index = extractRegInterval(curAlias)
+        if index:
+            for curRange in range(index[0], index[1] + 1):
+                initRegs.append((curAlias[:curAlias.find('[')], curRange))
+        else:
+            initRegs.append((curAlias, None))
+    tables = []
+    bases = []
+    code = ''
+    for firstIndex, lastIndex, bankName in aliasB.windows:
+        bankSize = None
+        for regB in self.regBanks:
+            if regB.name == bankName:
+                bankSize = regB.numRegs
+        if bankSize is None:
+            raise Exception('Window ' + str(firstIndex) + '-' + str(lastIndex) + ' of alias bank ' + aliasB.name + ' refers to ' + bankName + ' which is not a register bank')
+        windowLen = lastIndex - firstIndex + 1
+        if windowLen > bankSize:
+            raise Exception('Window ' + str(firstIndex) + '-' + str(lastIndex) + ' of alias bank ' + aliasB.name + ' is larger than register bank ' + bankName)
+        initBase = initRegs[firstIndex][1]
+        for i in range(0, windowLen):
+            if initRegs[firstIndex + i][0] != bankName or initBase is None or initRegs[firstIndex + i][1] != (initBase + i) % bankSize:
+                raise Exception('Alias ' + aliasB.name + '[' + str(firstIndex + i) + '] must initially refer to ' + bankName + '[' + str((initBase + i) % bankSize) + '] to be part of a window')
+        # The table repeats the first registers of the bank, so that the window
+        # never needs to wrap around
+        tableName = aliasB.name + '_window' + str(firstIndex)
+        baseName = aliasB.name + '_windowBase' + str(firstIndex)
+        tables.append((tableName, bankSize + windowLen - 1))
+        bases.append((baseName, initBase))
+        code += 'for(int i = 0; i < ' + str(bankSize + windowLen - 1) + '; i++){\n'
+        code += prefix + tableName + '[i] = &' + prefix + bankName + '[i % ' + str(bankSize) + '];\n'
+        code += '}\n'
+        code += prefix + baseName + ' = ' + str(initBase) + ';\n'
+        code += 'for(int i = 0; i < ' + str(windowLen) + '; i++){\n'
+        code += prefix + aliasB.name + '[i + ' + str(firstIndex) + '].setWindow(&' + prefix + tableName + '[i], &' + prefix + baseName + ', &' + prefix + aliasB.name + '[' + str(firstIndex) + '], ' + str(windowLen) + ');\n'
+        code += '}\n'
+    return (tables, bases, code)
+
 def createRegsAttributes(self, model, processorElements, initElements, bodyAliasInit, aliasInit, bodyInits):
     """Creates the code for the processor attributes (registers, aliases, etc) and the code to initialize them in the
     processor constructor"""
@@ -640,6 +794,19 @@ def createRegsAttributes(self, model, processorElements, initElements, bodyAlias
             if model.startswith('acc'):
                 abiIfInit += '_pipe'
             abiIfInit += ', '
+    if not model.startswith('acc') and (len([i for i in self.regs if i.delay]) > 0 or len([i for i in self.regBanks if i.delay]) > 0):
+        # Delayed registers add themselves to the list of pending updates when written,
+        # so that only the ones with an outstanding write are clocked after each instruction
+        registerPtrType = cxx_writer.writer_code.Type('Register', 'registers.hpp').makePointer()
+        attribute = cxx_writer.writer_code.Attribute('pendingUpdates', cxx_writer.writer_code.TemplateType('std::vector', [registerPtrType], 'vector'), 'pri')
+        processorElements.append(attribute)
+        bodyInits += '// Registration of the delayed registers\n'
+        for reg in self.regs:
+            if reg.delay:
+                bodyInits += 'this->' + reg.name + '.setPendingUpdates(&this->pendingUpdates);\n'
+        for regB in self.regBanks:
+            for regNum in regB.delay.keys():
+                bodyInits += 'this->' + regB.name + '[' + str(regNum) + '].setPendingUpdates(&this->pendingUpdates);\n'
     bodyInits += '// Initialization of the aliases (plain and banks)\n'
     for alias in self.aliasRegs:
         if model.startswith('acc'):
@@ -798,6 +965,18 @@ def createRegsAttributes(self, model, processorElements, initElements, bodyAlias
                             bodyAliasInit[aliasB.name] += ', ' + str(aliasB.offsets[curIndex])
                         bodyAliasInit[aliasB.name] += ');\n'
                         curIndex += 1
+        if aliasB.windows and not model.startswith('acc'):
+            # The aliases of the windows refer to the registers through the window
+            # tables, so that a window is moved by simply changing its base
+            registerType = cxx_writer.writer_code.Type('Register', 'registers.hpp')
+            tables, bases, windowsCode = getAliasWindowsCode(self, aliasB, 'this->')
+            for tableName, tableSize in tables:
+                attribute = cxx_writer.writer_code.Attribute(tableName + '[' + str(tableSize) + ']', registerType.makePointer(), 'pri')
+                processorElements.append(attribute)
+            for baseName, initBase in bases:
+                attribute = cxx_writer.writer_code.Attribute(baseName, cxx_writer.writer_code.uintType, 'pri')
+                processorElements.append(attribute)
+            bodyAliasInit[aliasB.name] += windowsCode
         if self.abi:
             abiIfInit += 'this->' + aliasB.name
             if model.startswith('acc'):
@@ -911,6 +1090,41 @@ def createInstrInitCode(self, model, trace):
         baseInstrInitElement += 'totalCycles, '
     return baseInstrInitElement[:-2]
 
+def hasTranslatedCode(self, model):
+    """Returns true if the application can be translated ahead of time
+    for the model: the translated code executes the instructions one
+    after the other, so it is not used when registers are updated with
+    a delay"""
+    if model != 'funcLT':
+        return False
+    return len([i for i in self.regs if i.delay]) == 0 and len([i for i in self.regBanks if i.delay]) == 0
+
+def hasCodePages(self, model):
+    """Returns true if the writes to memory are tracked in order to detect
+    self modifying code: when the instruction cache is indexed by address
+    the cached instructions are not fetched again, so they have to be
+    dropped once the memory holding them is overwritten"""
+    return self.instructionCache and self.fastFetch and model.startswith('func')
+
+def hasInstructionArena(self, model):
+    """Returns true if the instructions kept in the instruction cache are
+    allocated in an arena, flushing the cache when the arena is full: the
+    cycle accurate processors recycle the instructions replicated at every
+    fetch through a free list instead"""
+    return self.instructionCache and not model.startswith('acc')
+
+def hasFusedInstructions(self, model, trace):
+    """Returns true if the superinstructions declared in the ISA are used
+    by the model: the instruction cache has to be indexed by address, so
+    that a cached instruction is always followed by the same ones and no
+    fetch is performed for them, and the instructions must be executed
+    one at a time, without tracing them or updating registers with a delay"""
+    if not self.isa.superInstructions or not model.startswith('func') or trace:
+        return False
+    if not self.instructionCache or not self.fastFetch:
+        return False
+    return len([i for i in self.regs if i.delay]) == 0 and len([i for i in self.regBanks if i.delay]) == 0
+
 def getCPPProc(self, model, trace, combinedTrace, namespace):
     """creates the class describing the processor"""
     fetchWordType = self.bitSizes[1]
@@ -925,6 +1139,10 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
     processorElements = []
     codeString = ''
 
+    # The parameters used to build the instructions, which are also employed by the main loop
+    global baseInstrInitElement
+    baseInstrInitElement = createInstrInitCode(self, model, trace)
+
     ################################################
     # Start declaration of the main processor loop
     ###############################################
@@ -938,14 +1156,22 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
 
         codeString += 'while(true){\n'
         codeString += 'unsigned int numCycles = 0;\n'
+        codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.startInstruction();\n#endif\n'
 
         # Here is the code to notify start of the instruction execution
         codeString += 'this->instrExecuting = true;\n'
 
         # Here is the code to deal with interrupts
         codeString += getInterruptCode(self, trace)
+        if hasCodePages(self, model):
+            # Some cached instructions were overwritten: they are dropped before the next fetch
+            codeString += """if((this->pendingEvents & PENDING_CODE_WRITE) != 0){
+                this->invalidateModifiedCode();
+                instrCacheEnd = this->instrCache.end();
+            }
+            """
         # computes the correct memory and/or memory port from which fetching the instruction stream
-        fetchCode = computeFetchCode(self)
+        fetchCode = computeFetchCode(self, model)
         # computes the address from which the next instruction shall be fetched
         fetchAddress = computeCurrentPC(self, model)
         codeString += str(fetchWordType) + ' curPC = ' + fetchAddress + ';\n'
@@ -973,6 +1199,35 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         #endif
         """
 
+        # When the application was translated ahead of time the instructions are
+        # executed by the translated code, falling back to the interpreter for the
+        # ones which were not translated
+        if hasTranslatedCode(self, model):
+            codeString += """#if defined(TRAP_TRANSLATED_CODE) || defined(TRAP_JIT)
+            unsigned int numTranslated = 0;
+            #ifdef ENABLE_HISTORY
+            if(!this->historyEnabled){
+            #endif
+            numCycles = this->translatedCode.execute(curPC, numTranslated);
+            #ifdef ENABLE_HISTORY
+            }
+            #endif
+            if(numTranslated > 0){
+                numCycles += numTranslated - 1;
+                this->numInstructions += numTranslated - 1;
+                #ifdef ENABLE_PERF_COUNTERS
+                this->perfCounters.instructions += numTranslated - 1;
+                #endif
+            }
+            else{
+            #endif
+            #ifdef TRAP_JIT
+            if(this->jit.profile(curPC)){
+                this->compileHotRegion(curPC);
+            }
+            #endif
+            """
+
         # We need to fetch the instruction ... only if the cache is not used or if
         # the index of the cache is the current instruction
         if not (self.instructionCache and self.fastFetch):
@@ -983,9 +1238,11 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         # Finally I declare the fetch, decode, execute loop, where the instruction is actually executed;
         # Note the possibility of performing it with the instruction fetch
         if self.instructionCache:
-            codeString += fetchWithCacheCode(self, fetchCode, trace, combinedTrace, getInstrIssueCode)
+            codeString += fetchWithCacheCode(self, fetchCode, trace, combinedTrace, getInstrIssueCode, fused = hasFusedInstructions(self, model, trace))
         else:
             codeString += standardInstrFetch(self, trace, combinedTrace, getInstrIssueCode)
+        if hasTranslatedCode(self, model):
+            codeString += '#if defined(TRAP_TRANSLATED_CODE) || defined(TRAP_JIT)\n}\n#endif\n'
 
         # Lets finish with the code for the instruction queue: I just still have to
         # check if it is time to save to file the instruction queue
@@ -1011,7 +1268,9 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         if self.irqs:
             codeString += '}\n'
         if len(self.tlmPorts) > 0 and model.endswith('LT'):
-            codeString += 'this->quantKeeper.inc((numCycles + 1)*this->latency);\nif(this->quantKeeper.need_sync()){\nthis->quantKeeper.sync();\n}\n'
+            codeString += 'this->quantKeeper.inc((numCycles + 1)*this->latency);\nif(this->quantKeeper.need_sync()){\n'
+            codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.quantumSyncs++;\n#endif\n'
+            codeString += 'this->quantKeeper.sync();\n}\n'
         elif model.startswith('acc') or self.systemc or model.endswith('AT'):
             codeString += 'wait((numCycles + 1)*this->latency);\n'
         else:
@@ -1022,18 +1281,51 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         if self.systemc:
             codeString += 'this->instrEndEvent.notify();\n'
 
-        codeString += 'this->numInstructions++;\n\n'
-        # Now I have to call the update method for all the delayed registers
-        for reg in self.regs:
-            if reg.delay:
-                codeString += reg.name + '.clockCycle();\n'
-        for reg in self.regBanks:
-            for regNum in reg.delay.keys():
-                codeString += reg.name + '[' + str(regNum) + '].clockCycle();\n'
+        codeString += 'this->numInstructions++;\n'
+        codeString += '#ifdef ENABLE_PERF_COUNTERS\nthis->perfCounters.endInstruction();\n#endif\n\n'
+        # Now I have to call the update method for the delayed registers which have an outstanding
+        # write: the ones whose write has not yet completed are kept in the list
+        if len([i for i in self.regs if i.delay]) > 0 or len([i for i in self.regBanks if i.delay]) > 0:
+            codeString += """if(!this->pendingUpdates.empty()){
+                unsigned int numPending = 0;
+                for(unsigned int i = 0; i < this->pendingUpdates.size(); i++){
+                    Register * curReg = this->pendingUpdates[i];
+                    curReg->clockCycle();
+                    if(curReg->isUpdatePending()){
+                        this->pendingUpdates[numPending] = curReg;
+                        numPending++;
+                    }
+                }
+                this->pendingUpdates.resize(numPending);
+            }
+            """
         codeString += '}'
         mainLoopCode = cxx_writer.writer_code.Code(codeString)
         mainLoopCode.addInclude(includes)
         mainLoopCode.addInclude('customExceptions.hpp')
+        mainLoopCode.addInclude('pendingEvents.hpp')
+        mainLoopMethod = cxx_writer.writer_code.Method('mainLoop', mainLoopCode, cxx_writer.writer_code.voidType, 'pu')
+        processorElements.append(mainLoopMethod)
+    elif self.cycleDriven:
+        # Cycle driven pipeline: a single thread advances all the stages. The stages
+        # are executed from the last one to the fetch, so that each of them sees
+        # the state left by the following ones, as it happens with one thread per stage
+        for pipeStage in self.pipes:
+            codeString += 'this->' + pipeStage.name + '_stage.curInstruction = this->' + pipeStage.name + '_stage.NOPInstrInstance;\n'
+            codeString += 'this->' + pipeStage.name + '_stage.nextInstruction = this->' + pipeStage.name + '_stage.NOPInstrInstance;\n'
+        codeString += 'while(true){\n'
+        codeString += 'unsigned int numCycles = 0;\n'
+        codeString += 'unsigned int stageCycles = 0;\n'
+        for pipeStage in reversed(self.pipes):
+            codeString += 'stageCycles = this->' + pipeStage.name + '_stage.cycle();\n'
+            codeString += 'if(stageCycles > numCycles){\nnumCycles = stageCycles;\n}\n'
+        codeString += '// The cycle lasts as long as the slowest stage\n'
+        codeString += 'wait((numCycles + 1)*this->latency);\n'
+        codeString += '// Now the instructions move to the following stages\n'
+        for pipeStage in reversed(self.pipes):
+            codeString += 'this->' + pipeStage.name + '_stage.endCycle();\n'
+        codeString += '}'
+        mainLoopCode = cxx_writer.writer_code.Code(codeString)
         mainLoopMethod = cxx_writer.writer_code.Method('mainLoop', mainLoopCode, cxx_writer.writer_code.voidType, 'pu')
         processorElements.append(mainLoopMethod)
     ################################################
@@ -1110,6 +1402,38 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         processorElements.append(interfaceMethod)
     toolManagerAttribute = cxx_writer.writer_code.Attribute('toolManager', ToolsManagerType, 'pu')
     processorElements.append(toolManagerAttribute)
+    if hasTranslatedCode(self, model):
+        # Code translated ahead of time from the application (see the translator program)
+        translatedCodeType = cxx_writer.writer_code.TemplateType('TranslatedCode', [fetchWordType], 'translatedCode.hpp')
+        translatedCodeAttribute = cxx_writer.writer_code.Attribute('translatedCode', translatedCodeType, 'pu')
+        processorElements.append(translatedCodeAttribute)
+        # Code translated at run time from the regions executed most often
+        jitType = cxx_writer.writer_code.TemplateType('JitCompiler', [processor_name, fetchWordType], 'jitCompiler.hpp')
+        jitAttribute = cxx_writer.writer_code.Attribute('jit', jitType, 'pu')
+        processorElements.append(jitAttribute)
+        compileRegionCode = getTranslatorTargetCode(self, model, namespace)
+        compileRegionCode += str(fetchWordType) + ' regionStart = curPC & ~(this->jit.getRegionSize() - 1);\n'
+        compileRegionCode += 'CodeTranslator translator(target, this->jit.getRegionSize());\n'
+        if hasCodePages(self, model):
+            # The writes following the snapshot of the region invalidate it, even before it is registered
+            compileRegionCode += 'this->codePages.markCode(regionStart, regionStart + this->jit.getRegionSize());\n'
+        compileRegionCode += 'for(' + str(fetchWordType) + ' i = 0; i < this->jit.getRegionSize(); i += ' + str(self.wordSize) + '){\n'
+        compileRegionCode += str(fetchWordType) + ' address = regionStart + i;\n'
+        compileRegionCode += 'if(address >= this->PROGRAM_START && address + ' + str(self.wordSize) + ' <= this->PROGRAM_LIMIT){\n'
+        if self.instructionCache and self.fastFetch:
+            # Emulated routines are left to the interpreter, which calls their handler
+            compileRegionCode += 'if(this->emulatedCalls.find(address) != this->emulatedCalls.end()){\ncontinue;\n}\n'
+        compileRegionCode += str(fetchWordType) + ' word = this->' + getInstrMemory(self) + '.read_word_dbg(address);\n'
+        compileRegionCode += 'translator.addInstruction(address, word, this->decoder.decode(word));\n'
+        compileRegionCode += '}\n}\n'
+        compileRegionCode += 'this->jit.compile(regionStart, translator);\n'
+        compileRegionParam = cxx_writer.writer_code.Parameter('curPC', fetchWordType.makeRef().makeConst())
+        compileRegionMethod = cxx_writer.writer_code.Method('compileHotRegion', cxx_writer.writer_code.Code(compileRegionCode), cxx_writer.writer_code.voidType, 'pri', [compileRegionParam])
+        processorElements.append(compileRegionMethod)
+    if not model.startswith('acc'):
+        # Events (interrupts, tools) which need to be examined before the issue of the next instruction
+        pendingEventsAttribute = cxx_writer.writer_code.Attribute('pendingEvents', cxx_writer.writer_code.uintType, 'pri')
+        processorElements.append(pendingEventsAttribute)
 
     #############################################################################
     # Declaration of all the attributes of the processor class, including, in
@@ -1127,6 +1451,10 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         quantumKeeperAttribute = cxx_writer.writer_code.Attribute('quantKeeper', quantumKeeperType, 'pri')
         processorElements.append(quantumKeeperAttribute)
         bodyInits += 'this->quantKeeper.set_global_quantum( this->latency*100 );\nthis->quantKeeper.reset();\n'
+    if hasTranslatedCode(self, model):
+        bodyInits += 'this->translatedCode.setToolsManager(this->toolManager);\n'
+        bodyInits += 'this->jit.setProcessor(*this, this->translatedCode);\n'
+        bodyInits += '#ifdef TRAP_JIT\nthis->jit.setCompiler(TRAP_JIT_COMPILER, std::string(TRAP_JIT_SOURCE_DIR) + \"/' + model + '\");\n#endif\n'
     # Lets now add the registers, the reg banks, the aliases, etc.
     (bodyInits, bodyDestructor, abiIfInit) = createRegsAttributes(self, model, processorElements, initElements, bodyAliasInit, aliasInit, bodyInits)
 
@@ -1157,6 +1485,14 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
             abiIfInit = 'this->' + tlmPortName + ', ' + abiIfInit
         initElements.append(initPortCode)
         processorElements.append(attribute)
+    if hasCodePages(self, model):
+        bodyInits += 'this->codePages.setPendingEvents(&this->pendingEvents);\n'
+        if self.memory:
+            bodyInits += 'this->' + self.memory[0] + '.setCodePages(&this->codePages);\n'
+        for tlmPortName in self.tlmPorts.keys():
+            bodyInits += 'this->' + tlmPortName + '.setCodePages(&this->codePages);\n'
+        if hasTranslatedCode(self, model):
+            bodyInits += 'this->translatedCode.setCodePages(this->codePages);\n'
     if self.systemc or model.startswith('acc') or model.endswith('AT'):
         latencyAttribute = cxx_writer.writer_code.Attribute('latency', cxx_writer.writer_code.sc_timeType, 'pu')
         processorElements.append(latencyAttribute)
@@ -1201,6 +1537,13 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
     numInstructions = cxx_writer.writer_code.Attribute('numInstructions', cxx_writer.writer_code.uintType, 'pu')
     processorElements.append(numInstructions)
     bodyInits += 'this->numInstructions = 0;\n'
+    # Counters describing the behavior of the simulator itself; they are updated
+    # only when the simulator is compiled with ENABLE_PERF_COUNTERS
+    perfCountersAttr = cxx_writer.writer_code.Attribute('perfCounters', cxx_writer.writer_code.Type('PerfCounters', 'perfCounters.hpp'), 'pu')
+    processorElements.append(perfCountersAttr)
+    bodyInits += 'this->perfCounters.setName(this->name());\n'
+    for tlmPortName in self.tlmPorts.keys():
+        bodyInits += 'this->perfCounters.addPort("' + tlmPortName + '", this->' + tlmPortName + '.perfCounters);\n'
     # Now I have to declare some special constants used to keep track of the loaded executable file
     entryPointAttr = cxx_writer.writer_code.Attribute('ENTRY_POINT', fetchWordType, 'pu')
     processorElements.append(entryPointAttr)
@@ -1241,6 +1584,233 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
                         cxx_writer.writer_code.TemplateType('template_map',
                             [fetchWordType, CacheElemType], hash_map_include), 'pri')
         processorElements.append(cacheAttribute)
+    if hasInstructionArena(self, model):
+        # Memory holding the cached instructions: the whole cache is dropped when it is full
+        arenaAttribute = cxx_writer.writer_code.Attribute('instrArena', cxx_writer.writer_code.Type('InstructionArena', 'instructionArena.hpp'), 'pu')
+        processorElements.append(arenaAttribute)
+        flushCacheCode = """template_map< """ + str(fetchWordType) + """, CacheElem >::const_iterator cacheIter, cacheEnd;
+            for(cacheIter = this->instrCache.begin(), cacheEnd = this->instrCache.end(); cacheIter != cacheEnd; cacheIter++){
+                delete cacheIter->second.instr;
+        """
+        if hasFusedInstructions(self, model, trace):
+            flushCacheCode += 'delete cacheIter->second.fused;\n'
+        flushCacheCode += """}
+            this->instrCache.clear();
+            this->instrArena.reset();
+        """
+        if hasCodePages(self, model):
+            flushCacheCode += 'this->codePages.clearCachedInstrs();\n'
+        flushCacheMethod = cxx_writer.writer_code.Method('flushInstrCache', cxx_writer.writer_code.Code(flushCacheCode), cxx_writer.writer_code.voidType, 'pri')
+        processorElements.append(flushCacheMethod)
+    if self.instructionCache and self.fastFetch and not model.startswith('acc'):
+        # Routines emulated by the OS emulator: they are bound to the instruction cache
+        # when their address is decoded
+        handlerPtrType = cxx_writer.writer_code.TemplateType('ToolsIf', [fetchWordType], 'ToolsIf.hpp').makePointer()
+        emulatedCallsAttribute = cxx_writer.writer_code.Attribute('emulatedCalls',
+                        cxx_writer.writer_code.TemplateType('template_map',
+                            [fetchWordType, handlerPtrType], hash_map_include), 'pri')
+        processorElements.append(emulatedCallsAttribute)
+        addEmulatedCallCode = """this->emulatedCalls[address] = &handler;
+            // An already cached address has to be decoded again
+            template_map< """ + str(fetchWordType) + """, CacheElem >::iterator cachedInstr = this->instrCache.find(address);
+            if(cachedInstr != this->instrCache.end()){
+                delete cachedInstr->second.instr;
+        """
+        if hasFusedInstructions(self, model, trace):
+            addEmulatedCallCode += 'delete cachedInstr->second.fused;\n'
+        addEmulatedCallCode += 'this->instrCache.erase(cachedInstr);\n}\n'
+        if hasTranslatedCode(self, model):
+            # The translated code would execute the original routine
+            addEmulatedCallCode += '#if defined(TRAP_TRANSLATED_CODE) || defined(TRAP_JIT)\n'
+            addEmulatedCallCode += 'this->translatedCode.invalidate(address, address + ' + str(self.wordSize) + ');\n'
+            addEmulatedCallCode += '#endif\n'
+        addEmulatedCallBody = cxx_writer.writer_code.Code(addEmulatedCallCode)
+        addEmulatedCallParams = [cxx_writer.writer_code.Parameter('address', fetchWordType.makeRef().makeConst()),
+                    cxx_writer.writer_code.Parameter('handler', cxx_writer.writer_code.TemplateType('ToolsIf', [fetchWordType], 'ToolsIf.hpp').makeRef())]
+        addEmulatedCallMethod = cxx_writer.writer_code.Method('addEmulatedCall', addEmulatedCallBody, cxx_writer.writer_code.voidType, 'pu', addEmulatedCallParams)
+        processorElements.append(addEmulatedCallMethod)
+    if hasCodePages(self, model):
+        # Pages holding cached instructions, whose writes are notified by the memories
+        codePagesType = cxx_writer.writer_code.TemplateType('CodePages', [fetchWordType], 'codePages.hpp')
+        codePagesAttribute = cxx_writer.writer_code.Attribute('codePages', codePagesType, 'pri')
+        processorElements.append(codePagesAttribute)
+        # Only the instructions cached from the modified pages are visited; a
+        # superinstruction is recorded in all the pages of its components
+        invalidateCode = """std::vector< """ + str(fetchWordType) + """ >::const_iterator pageIter, pageEnd;
+            for(pageIter = this->codePages.getModifiedPages().begin(), pageEnd = this->codePages.getModifiedPages().end(); pageIter != pageEnd; pageIter++){
+                const std::vector< """ + str(fetchWordType) + """ > * cachedKeys = this->codePages.getCachedInstrs(*pageIter);
+                if(cachedKeys != NULL){
+                    std::vector< """ + str(fetchWordType) + """ >::const_iterator keyIter, keyEnd;
+                    for(keyIter = cachedKeys->begin(), keyEnd = cachedKeys->end(); keyIter != keyEnd; keyIter++){
+                        template_map< """ + str(fetchWordType) + """, CacheElem >::iterator cachedInstr = this->instrCache.find(*keyIter);
+                        if(cachedInstr != this->instrCache.end()){
+                            delete cachedInstr->second.instr;
+        """
+        if hasFusedInstructions(self, model, trace):
+            invalidateCode += 'delete cachedInstr->second.fused;\n'
+        invalidateCode += """this->instrCache.erase(cachedInstr);
+                        }
+                    }
+                }
+        """
+        if hasTranslatedCode(self, model):
+            invalidateCode += """#if defined(TRAP_TRANSLATED_CODE) || defined(TRAP_JIT)
+            """ + str(fetchWordType) + """ pageStart = *pageIter << CodePages< """ + str(fetchWordType) + """ >::pageBits;
+            this->translatedCode.invalidate(pageStart, pageStart + ((1 << CodePages< """ + str(fetchWordType) + """ >::pageBits) - 1));
+            #ifdef TRAP_JIT
+            this->jit.invalidate(pageStart, pageStart + ((1 << CodePages< """ + str(fetchWordType) + """ >::pageBits) - 1));
+            #endif
+            #endif
+            """
+        invalidateCode += '}\n'
+        invalidateCode += 'this->codePages.clearModified();\n'
+        invalidateBody = cxx_writer.writer_code.Code(invalidateCode)
+        invalidateBody.addInclude('vector')
+        invalidateMethod = cxx_writer.writer_code.Method('invalidateModifiedCode', invalidateBody, cxx_writer.writer_code.voidType, 'pri')
+        processorElements.append(invalidateMethod)
+    if hasFusedInstructions(self, model, trace):
+        # Superinstructions: when an instruction is added to the cache, the ones following
+        # it are decoded and, if they form one of the sequences declared in the ISA, they
+        # are fused together; the longest matching sequence is chosen
+        sequences = sorted(self.isa.superInstructions, lambda x,y: cmp(len(y), len(x)))
+        maxSequence = len(sequences[0])
+        fuseCode = str(fetchWordType) + ' words[' + str(maxSequence) + '];\n'
+        fuseCode += 'int instrIds[' + str(maxSequence) + '];\n'
+        fuseCode += 'words[0] = bitString;\n'
+        fuseCode += 'instrIds[0] = this->decoder.decode(bitString);\n'
+        fuseCode += 'unsigned int numDecoded = 1;\n'
+        fuseCode += 'for(; numDecoded < ' + str(maxSequence) + '; numDecoded++){\n'
+        fuseCode += str(fetchWordType) + ' address = curPC + numDecoded*' + str(self.wordSize) + ';\n'
+        fuseCode += '// The routines emulated by the OS emulator are never part of a sequence\n'
+        fuseCode += 'if(address < this->PROGRAM_START || address + ' + str(self.wordSize) + ' > this->PROGRAM_LIMIT || this->emulatedCalls.find(address) != this->emulatedCalls.end()){\n'
+        fuseCode += 'break;\n}\n'
+        fuseCode += 'words[numDecoded] = this->' + getInstrMemory(self) + '.read_word_dbg(address);\n'
+        fuseCode += 'instrIds[numDecoded] = this->decoder.decode(words[numDecoded]);\n'
+        fuseCode += '}\n'
+        fuseCode += 'this->codePages.addCachedInstr(curPC, curPC + ' + str(self.wordSize) + ', curPC + numDecoded*' + str(self.wordSize) + ');\n'
+        fuseCode += 'Instruction * components[' + str(maxSequence) + '];\n'
+        for sequence in sequences:
+            if sequence != sequences[0]:
+                fuseCode += 'else '
+            fuseCode += 'if(numDecoded >= ' + str(len(sequence))
+            for i in range(0, len(sequence)):
+                fuseCode += ' && instrIds[' + str(i) + '] == ' + str(self.isa.instructions[sequence[i]].id)
+            fuseCode += '){\n'
+            fuseCode += 'for(unsigned int i = 0; i < ' + str(len(sequence)) + '; i++){\n'
+            fuseCode += 'components[i] = this->INSTRUCTIONS[instrIds[i]]->replicate();\n'
+            fuseCode += 'components[i]->setParams(words[i]);\n'
+            fuseCode += '}\n'
+            fuseCode += 'cacheElem.fused = new Fused_' + '_'.join(sequence) + '(this->' + self.fetchReg[0] + ', components);\n'
+            fuseCode += '}\n'
+        fuseParams = [cxx_writer.writer_code.Parameter('curPC', fetchWordType.makeRef().makeConst()),
+                    cxx_writer.writer_code.Parameter('bitString', fetchWordType.makeRef().makeConst()),
+                    cxx_writer.writer_code.Parameter('cacheElem', CacheElemType.makeRef())]
+        fuseMethod = cxx_writer.writer_code.Method('fuseInstructions', cxx_writer.writer_code.Code(fuseCode), cxx_writer.writer_code.voidType, 'pri', fuseParams)
+        processorElements.append(fuseMethod)
+    if hasInstructionArena(self, model):
+        # Decoded instructions saved at the end of the simulation and restored at the
+        # beginning of the next one; when the cache is indexed by address the word is
+        # kept too, so that the instructions no more matching the memory are dropped
+        entriesType = cxx_writer.writer_code.TemplateType('std::vector', [cxx_writer.writer_code.Type('DecodeCacheEntry', 'decodeCache.hpp')], 'vector')
+        saveCode = 'template_map< ' + str(fetchWordType) + ', CacheElem >::const_iterator cacheIter, cacheEnd;\n'
+        saveCode += 'for(cacheIter = this->instrCache.begin(), cacheEnd = this->instrCache.end(); cacheIter != cacheEnd; cacheIter++){\n'
+        saveCode += 'if(cacheIter->second.instr == NULL){\ncontinue;\n}\n'
+        if self.fastFetch:
+            saveCode += 'if(this->emulatedCalls.find(cacheIter->first) != this->emulatedCalls.end()){\ncontinue;\n}\n'
+        saveCode += 'DecodeCacheEntry entry;\n'
+        saveCode += 'entry.key = cacheIter->first;\n'
+        saveCode += 'entry.instrId = cacheIter->second.instr->getId();\n'
+        if self.fastFetch:
+            saveCode += 'entry.word = this->' + getInstrMemory(self) + '.read_word_dbg(cacheIter->first);\n'
+        else:
+            saveCode += 'entry.word = cacheIter->first;\n'
+        saveCode += 'entries.push_back(entry);\n'
+        saveCode += '}\n'
+        saveParams = [cxx_writer.writer_code.Parameter('entries', entriesType.makeRef())]
+        saveMethod = cxx_writer.writer_code.Method('saveDecodedInstructions', cxx_writer.writer_code.Code(saveCode), cxx_writer.writer_code.voidType, 'pu', saveParams)
+        processorElements.append(saveMethod)
+        restoreCode = 'unsigned int numRestored = 0;\n'
+        restoreCode += 'std::vector<DecodeCacheEntry>::const_iterator entriesIter, entriesEnd;\n'
+        restoreCode += 'for(entriesIter = entries.begin(), entriesEnd = entries.end(); entriesIter != entriesEnd && !this->instrArena.isFull(); entriesIter++){\n'
+        restoreCode += str(fetchWordType) + ' key = (' + str(fetchWordType) + ')entriesIter->key;\n'
+        restoreCode += str(fetchWordType) + ' word = (' + str(fetchWordType) + ')entriesIter->word;\n'
+        restoreCode += 'if(key != entriesIter->key || word != entriesIter->word || this->instrCache.find(key) != this->instrCache.end()){\ncontinue;\n}\n'
+        if self.fastFetch:
+            restoreCode += '// The application might have changed since the instructions were saved\n'
+            restoreCode += 'if(key < this->PROGRAM_START || key + ' + str(self.wordSize) + ' > this->PROGRAM_LIMIT || this->emulatedCalls.find(key) != this->emulatedCalls.end()){\ncontinue;\n}\n'
+            restoreCode += 'if(this->' + getInstrMemory(self) + '.read_word_dbg(key) != word){\ncontinue;\n}\n'
+        else:
+            restoreCode += 'if(key != word){\ncontinue;\n}\n'
+        restoreCode += 'int instrId = this->decoder.decode(word);\n'
+        restoreCode += 'if(instrId != (int)entriesIter->instrId){\ncontinue;\n}\n'
+        restoreCode += 'this->addToInstrCache(key, word, instrId);\n'
+        restoreCode += 'numRestored++;\n'
+        restoreCode += '}\n'
+        restoreCode += 'return numRestored;\n'
+        restoreParams = [cxx_writer.writer_code.Parameter('entries', entriesType.makeRef().makeConst())]
+        restoreMethod = cxx_writer.writer_code.Method('restoreDecodedInstructions', cxx_writer.writer_code.Code(restoreCode), cxx_writer.writer_code.uintType, 'pu', restoreParams)
+        processorElements.append(restoreMethod)
+        # Adds to the cache an instruction which is already promoted, as if it was
+        # executed as many times as needed
+        addCode = 'Instruction * instr = this->INSTRUCTIONS[instrId]->replicate(&this->instrArena);\n'
+        addCode += 'instr->setParams(word);\n'
+        insertCode = 'this->instrCache.insert(std::pair< ' + str(fetchWordType) + ', CacheElem >(key, CacheElem(instr, ' + str(self.cacheLimit) + ')))'
+        if hasFusedInstructions(self, model, trace):
+            addCode += 'CacheElem & cacheElem = ' + insertCode + '.first->second;\n'
+        else:
+            addCode += insertCode + ';\n'
+        if self.fastFetch:
+            addCode += 'this->codePages.addCachedInstr(key);\n'
+        if hasFusedInstructions(self, model, trace):
+            addCode += 'this->fuseInstructions(key, word, cacheElem);\n'
+        addParams = [cxx_writer.writer_code.Parameter('key', fetchWordType.makeRef().makeConst()),
+                    cxx_writer.writer_code.Parameter('word', fetchWordType.makeRef().makeConst()),
+                    cxx_writer.writer_code.Parameter('instrId', cxx_writer.writer_code.intType)]
+        addMethod = cxx_writer.writer_code.Method('addToInstrCache', cxx_writer.writer_code.Code(addCode), cxx_writer.writer_code.voidType, 'pri', addParams)
+        processorElements.append(addMethod)
+        # Pre-decoding of the executable code: the words are read serially, decoded
+        # in parallel and then added to the cache serially, as neither the cache nor
+        # the arena can be shared among threads; the words which are not valid
+        # instructions are data and they are skipped
+        if self.invalid_instr:
+            invalidId = self.invalid_instr.id
+        else:
+            invalidId = max([instr.id for instr in self.isa.instructions.values()]) + 1
+        preDecodeCode = 'std::vector< ' + str(fetchWordType) + ' > addresses;\n'
+        preDecodeCode += 'std::vector< ' + str(fetchWordType) + ' > words;\n'
+        preDecodeCode += 'std::vector<std::pair<unsigned int, unsigned int> >::const_iterator segIter, segEnd;\n'
+        preDecodeCode += 'for(segIter = codeSegments.begin(), segEnd = codeSegments.end(); segIter != segEnd; segIter++){\n'
+        preDecodeCode += str(fetchWordType) + ' start = std::max((' + str(fetchWordType) + ')segIter->first, this->PROGRAM_START);\n'
+        preDecodeCode += 'start += (' + str(self.wordSize) + ' - start % ' + str(self.wordSize) + ') % ' + str(self.wordSize) + ';\n'
+        preDecodeCode += str(fetchWordType) + ' end = std::min((' + str(fetchWordType) + ')segIter->second, this->PROGRAM_LIMIT);\n'
+        preDecodeCode += 'for(' + str(fetchWordType) + ' address = start; address + ' + str(self.wordSize) + ' <= end; address += ' + str(self.wordSize) + '){\n'
+        if self.fastFetch:
+            preDecodeCode += 'if(this->emulatedCalls.find(address) != this->emulatedCalls.end() || this->instrCache.find(address) != this->instrCache.end()){\ncontinue;\n}\n'
+        preDecodeCode += 'addresses.push_back(address);\n'
+        preDecodeCode += 'words.push_back(this->' + getInstrMemory(self) + '.read_word_dbg(address));\n'
+        preDecodeCode += '}\n}\n'
+        preDecodeCode += 'std::vector<int> instrIds;\n'
+        preDecodeCode += 'parallelDecode(this->decoder, words, instrIds, numThreads);\n'
+        preDecodeCode += 'unsigned int numDecoded = 0;\n'
+        preDecodeCode += 'for(unsigned int i = 0; i < words.size() && !this->instrArena.isFull(); i++){\n'
+        preDecodeCode += 'if(instrIds[i] == ' + str(invalidId) + '){\ncontinue;\n}\n'
+        if self.fastFetch:
+            preDecodeCode += 'this->addToInstrCache(addresses[i], words[i], instrIds[i]);\n'
+        else:
+            preDecodeCode += '// The same word might appear several times in the code\n'
+            preDecodeCode += 'if(this->instrCache.find(words[i]) != this->instrCache.end()){\ncontinue;\n}\n'
+            preDecodeCode += 'this->addToInstrCache(words[i], words[i], instrIds[i]);\n'
+        preDecodeCode += 'numDecoded++;\n'
+        preDecodeCode += '}\n'
+        preDecodeCode += 'return numDecoded;\n'
+        preDecodeBody = cxx_writer.writer_code.Code(preDecodeCode)
+        preDecodeBody.addInclude('parallelDecoder.hpp')
+        preDecodeBody.addInclude('algorithm')
+        segmentsType = cxx_writer.writer_code.TemplateType('std::vector', [cxx_writer.writer_code.TemplateType('std::pair', [cxx_writer.writer_code.uintType, cxx_writer.writer_code.uintType], 'utility')], 'vector')
+        preDecodeParams = [cxx_writer.writer_code.Parameter('codeSegments', segmentsType.makeRef().makeConst()),
+                    cxx_writer.writer_code.Parameter('numThreads', cxx_writer.writer_code.uintType)]
+        preDecodeMethod = cxx_writer.writer_code.Method('preDecode', preDecodeBody, cxx_writer.writer_code.uintType, 'pu', preDecodeParams)
+        processorElements.append(preDecodeMethod)
     numProcAttribute = cxx_writer.writer_code.Attribute('numInstances',
                             cxx_writer.writer_code.intType, 'pri', True, '0')
     processorElements.append(numProcAttribute)
@@ -1257,7 +1827,10 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         irqPortAttr = cxx_writer.writer_code.Attribute(irqPort.name + '_port', irqPortType, 'pu')
         processorElements.append(irqSignalAttr)
         processorElements.append(irqPortAttr)
-        initElements.append(irqPort.name + '_port(\"' + irqPort.name + '_IRQ\", ' + irqPort.name + ')')
+        if model.startswith('acc'):
+            initElements.append(irqPort.name + '_port(\"' + irqPort.name + '_IRQ\", ' + irqPort.name + ')')
+        else:
+            initElements.append(irqPort.name + '_port(\"' + irqPort.name + '_IRQ\", ' + irqPort.name + ', pendingEvents)')
     # Generic PIN ports
     for pinPort in self.pins:
         pinPortName = 'Pin'
@@ -1302,6 +1875,22 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         enableHistoryMethod = cxx_writer.writer_code.Method('enableHistory', enableHistoryCode, cxx_writer.writer_code.voidType, 'pu', parameters)
         processorElements.append(enableHistoryMethod)
 
+    ####################################################################
+    # Binary instruction trace, used instead of the textual one when
+    # its file is opened
+    ####################################################################
+    if trace and model.startswith('func'):
+        traceWriterAttr = cxx_writer.writer_code.Attribute('traceWriter', cxx_writer.writer_code.Type('BinaryTraceWriter', 'binaryTrace.hpp'), 'pu')
+        processorElements.append(traceWriterAttr)
+        numInstrIds = max([instr.id for instr in self.isa.instructions.values()]) + 2
+        openTraceCode = 'std::vector<std::string> instrNames;\n'
+        openTraceCode += 'for(int i = 0; i < ' + str(numInstrIds) + '; i++){\n'
+        openTraceCode += 'instrNames.push_back(this->INSTRUCTIONS[i]->getInstructionName());\n}\n'
+        openTraceCode += 'this->traceWriter.open(fileName, this->INSTRUCTIONS[0]->getTraceRegisterNames(), instrNames);\n'
+        parameters = [cxx_writer.writer_code.Parameter('fileName', cxx_writer.writer_code.stringType.makeRef().makeConst())]
+        openTraceMethod = cxx_writer.writer_code.Method('openBinaryTrace', cxx_writer.writer_code.Code(openTraceCode), cxx_writer.writer_code.voidType, 'pu', parameters)
+        processorElements.append(openTraceMethod)
+
     ####################################################################
     # Cycle accurate model, lets proceed with the declaration of the
     # pipeline stages, together with the code necessary for thei initialization
@@ -1321,8 +1910,6 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
     # initialize the INSTRUCTIONS array, the local memory (if present)
     # the TLM ports, the pipeline stages, etc.
     ########################################################################
-    global baseInstrInitElement
-    baseInstrInitElement = createInstrInitCode(self, model, trace)
 
     constrCode = 'this->resetCalled = false;\n' + processor_name + '::numInstances++;\n'
     constrCode += '// Initialization of the array holding the initial instance of the instructions\n'
@@ -1343,10 +1930,19 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
             for pipeStage in self.pipes:
                 constrCode += 'this->' + pipeStage.name + '_stage.' + irqPort.name + '_irqInstr = this->' + irqPort.name + '_irqInstr;\n'
     constrCode += bodyInits
-    if not model.startswith('acc'):
+    if model.endswith('AT') and self.fetchBuffer and not self.memory:
+        # Writes through the data ports invalidate the line buffered by the fetch port
+        for fetchPortName in [name for name, isFetch in self.tlmPorts.items() if isFetch]:
+            for tlmPortName in self.tlmPorts.keys():
+                if tlmPortName != fetchPortName:
+                    constrCode += 'this->' + tlmPortName + '.setFetchBufferPort(&this->' + fetchPortName + ');\n'
+    if not model.startswith('acc') or self.cycleDriven:
         constrCode += 'SC_THREAD(mainLoop);\n'
     if not self.systemc and not model.startswith('acc'):
         constrCode += 'this->totalCycles = 0;\n'
+    if not model.startswith('acc'):
+        constrCode += 'this->pendingEvents = 0;\n'
+        constrCode += 'this->toolManager.setPendingEvents(&this->pendingEvents);\n'
     constrCode += 'end_module();'
     constructorBody = cxx_writer.writer_code.Code(constrCode)
     constructorParams = [cxx_writer.writer_code.Parameter('name', cxx_writer.writer_code.sc_module_nameType)]
@@ -1369,8 +1965,10 @@ def getCPPProc(self, model, trace, combinedTrace, namespace):
         destrCode += """template_map< """ + str(fetchWordType) + """, CacheElem >::const_iterator cacheIter, cacheEnd;
         for(cacheIter = this->instrCache.begin(), cacheEnd = this->instrCache.end(); cacheIter != cacheEnd; cacheIter++){
             delete cacheIter->second.instr;
-        }
         """
+        if hasFusedInstructions(self, model, trace):
+            destrCode += 'delete cacheIter->second.fused;\n'
+        destrCode += '}\n'
     if self.abi:
         destrCode += 'delete this->abiIf;\n'
     for irq in self.irqs:
@@ -1433,7 +2031,408 @@ def getTestMainCode(self):
     mainFunction = cxx_writer.writer_code.Function('sc_main', mainCode, cxx_writer.writer_code.intType, parameters)
     return [initFunction, mainFunction]
 
-def getMainCode(self, model, namespace):
+def getBenchmarkMainCode(self, model, namespace, decoderWords):
+    """Returns the code of the program which measures the performance
+    of the single components of the simulator and, optionally, the
+    speed of the whole simulator on a set of applications"""
+    wordType = self.bitSizes[1]
+    code = 'using namespace ' + namespace + ';\nusing namespace trap;\n\n'
+    code += """
+    boost::program_options::options_description desc("Benchmarks for the simulator of """ + self.name + """", 120);
+    desc.add_options()
+        ("help,h", "produces the help message")
+        ("application,a", boost::program_options::value<std::string>(),
+                    "application used by the profiler and ELF frontend benchmarks")
+        ("simulator,s", boost::program_options::value<std::string>(),
+                    "simulator executable used for the end-to-end benchmarks")
+        ("programs,p", boost::program_options::value<std::vector<std::string> >()->multitoken(),
+                    "applications executed on the simulator for the end-to-end benchmarks")
+        ("host_counters", "reads the hardware counters of the host during the end-to-end benchmarks")
+        ("baseline,b", boost::program_options::value<std::string>(),
+                    "saves the results in the specified baseline file")
+        ("compare,c", boost::program_options::value<std::string>(),
+                    "compares the results with the specified baseline file")
+        ("threshold,t", boost::program_options::value<double>()->default_value(5),
+                    "slowdown percentage reported as a regression")
+        ("min_time", boost::program_options::value<double>()->default_value(0.2),
+                    "minimum duration, in seconds, of each microbenchmark")
+    ;
+
+    boost::program_options::variables_map vm;
+    try{
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    }
+    catch(boost::program_options::error &e){
+        std::cerr << "ERROR in parsing the command line parametrs" << std::endl << std::endl;
+        std::cerr << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    boost::program_options::notify(vm);
+    if(vm.count("help") != 0){
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    if(vm.count("programs") != 0 && vm.count("simulator") == 0){
+        std::cerr << "It is necessary to specify the simulator executing the end-to-end benchmarks" << " using the --simulator command line option" << std::endl << std::endl;
+        return -1;
+    }
+
+    BenchmarkSuite suite(vm["min_time"].as<double>());
+
+    """
+    if (self.systemc or model.startswith('acc') or model.endswith('AT')) and not self.externalClock:
+        code += processor_name + ' procInst(\"' + self.name + '\", sc_time(1, SC_US));\n'
+    else:
+        code += processor_name + ' procInst(\"' + self.name + '\");\n'
+
+    # Decoder: all the instructions of the ISA are decoded in turn
+    code += '\n// Decoding of all the instructions of the ISA\n'
+    code += 'Decoder decoder;\n'
+    code += 'const ' + str(wordType) + ' decoderWords[] = {' + ', '.join([hex(word).rstrip('L') for word in decoderWords]) + '};\n'
+    code += """unsigned int curWord = 0;
+    BenchmarkLoop decodeLoop(suite, "decoder_decode");
+    for(unsigned int n = decodeLoop.next(); n > 0; n = decodeLoop.next()){
+        for(unsigned int i = 0; i < n; i++){
+            suite.sink(decoder.decode(decoderWords[curWord]));
+            curWord++;
+            if(curWord == """ + str(len(decoderWords)) + """){
+                curWord = 0;
+            }
+        }
+    }
+    """
+
+    # Register bank: the bank accessed by the instructions, so the alias one when it is present
+    benchBank = None
+    if self.aliasRegBanks:
+        benchBank = self.aliasRegBanks[0]
+    elif self.regBanks:
+        benchBank = self.regBanks[0]
+    if benchBank:
+        code += """
+        // Accesses to the register bank
+        unsigned int curReg = 0;
+        BenchmarkLoop regLoop(suite, "regbank_""" + benchBank.name + """");
+        for(unsigned int n = regLoop.next(); n > 0; n = regLoop.next()){
+            for(unsigned int i = 0; i < n; i++){
+                unsigned int nextReg = curReg + 1;
+                if(nextReg == """ + str(benchBank.numRegs) + """){
+                    nextReg = 0;
+                }
+                unsigned int regValue = procInst.""" + benchBank.name + """[curReg];
+                procInst.""" + benchBank.name + """[nextReg] = regValue + i;
+                curReg = nextReg;
+            }
+        }
+        suite.sink(procInst.""" + benchBank.name + """[curReg]);
+        """
+
+    # Addresses are confined in a power-of-two window at the beginning of the memory
+    benchMemSpan = 1
+    while benchMemSpan*2 <= 65536:
+        benchMemSpan *= 2
+    if self.memory:
+        while benchMemSpan > self.memory[1]:
+            benchMemSpan /= 2
+    benchMemMask = hex((benchMemSpan - 1) & ~(self.wordSize - 1))
+    if self.memory:
+        code += '\n// Accesses to the internal memory\n'
+        for access in ['read', 'write']:
+            code += 'BenchmarkLoop ' + access + 'MemLoop(suite, \"localmemory_' + access + '_word\");\n'
+            code += 'for(unsigned int n = ' + access + 'MemLoop.next(); n > 0; n = ' + access + 'MemLoop.next()){\n'
+            code += 'for(unsigned int i = 0; i < n; i++){\n'
+            if access == 'read':
+                code += 'suite.sink(procInst.' + self.memory[0] + '.read_word((i*' + str(self.wordSize) + ') & ' + benchMemMask + '));\n'
+            else:
+                code += 'procInst.' + self.memory[0] + '.write_word((i*' + str(self.wordSize) + ') & ' + benchMemMask + ', i);\n'
+            code += '}\n}\n'
+
+    # Memories used as TLM targets in the systems: their b_transport is called directly
+    code += """
+    // Transactions on the TLM memories
+    """ + str(wordType) + """ transDatum = 0;
+    sc_time transDelay = SC_ZERO_TIME;
+    tlm::tlm_generic_payload trans;
+    trans.set_data_ptr(reinterpret_cast<unsigned char*>(&transDatum));
+    trans.set_data_length(sizeof(transDatum));
+    trans.set_streaming_width(sizeof(transDatum));
+    trans.set_byte_enable_ptr(0);
+    """
+    for memClass in ['MemoryLT', 'SparseMemoryLT']:
+        code += memClass + '<1, ' + str(self.wordSize*self.byteSize) + '> bench' + memClass + '(\"bench' + memClass + '\", ' + str(benchMemSpan) + ');\n'
+        for access in ['read', 'write']:
+            loopName = access + memClass + 'Loop'
+            code += 'BenchmarkLoop ' + loopName + '(suite, \"' + memClass.lower() + '_b_transport_' + access + '\");\n'
+            code += 'for(unsigned int n = ' + loopName + '.next(); n > 0; n = ' + loopName + '.next()){\n'
+            code += 'for(unsigned int i = 0; i < n; i++){\n'
+            code += 'trans.set_address((i*' + str(self.wordSize) + ') & ' + benchMemMask + ');\n'
+            code += 'trans.set_' + access + '();\n'
+            if access == 'write':
+                code += 'transDatum = i;\n'
+            code += 'bench' + memClass + '.b_transport(trans, transDelay);\n'
+            if access == 'read':
+                code += 'suite.sink(transDatum);\n'
+            code += '}\n}\n'
+
+    # Tools: the dispatch of the tools manager is measured with tools which
+    # do nothing, so that only the cost of the dispatch is accounted for
+    code += """
+    // Dispatch of the instruction issue to the tools
+    class NullTool : public ToolsIf<""" + str(wordType) + """>{
+      public:
+        bool newIssue(const """ + str(wordType) + """ &curPC, const InstructionBase *curInstr) throw(){
+            return false;
+        }
+        bool emptyPipeline(const """ + str(wordType) + """ &curPC) const throw(){
+            return false;
+        }
+    };
+    class BenchmarkInstr : public InstructionBase{
+      public:
+        std::string getInstructionName() const throw(){
+            return "benchmark";
+        }
+        std::string getMnemonic() const throw(){
+            return "benchmark";
+        }
+        unsigned int getId() const throw(){
+            return 0;
+        }
+    };
+    NullTool firstTool, secondTool;
+    BenchmarkInstr benchInstr;
+    ToolsManager<""" + str(wordType) + """> benchToolManager;
+    benchToolManager.addTool(firstTool);
+    benchToolManager.addTool(secondTool);
+    BenchmarkLoop toolsLoop(suite, "toolsmanager_newissue");
+    for(unsigned int n = toolsLoop.next(); n > 0; n = toolsLoop.next()){
+        for(unsigned int i = 0; i < n; i++){
+            """ + str(wordType) + """ curPC = i*""" + str(self.wordSize) + """;
+            suite.sink(benchToolManager.newIssue(curPC, &benchInstr));
+        }
+    }
+    """
+
+    # Profiler and ELF frontend need an application
+    code += """
+    if(vm.count("application") != 0){
+        ELFFrontend & elfFrontend = ELFFrontend::getInstance(vm["application"].as<std::string>());
+        """ + str(wordType) + """ codeStart = elfFrontend.getBinaryStart();
+        """ + str(wordType) + """ codeEnd = elfFrontend.getBinaryEnd();
+        """ + str(wordType) + """ curPC = codeStart;
+        """
+    if self.abi:
+        code += """Profiler< """ + str(wordType) + """ > profiler(*(procInst.abiIf), vm["application"].as<std::string>(), false, """ + str(self.wordSize) + """);
+        BenchmarkLoop profilerLoop(suite, "profiler_newissue");
+        for(unsigned int n = profilerLoop.next(); n > 0; n = profilerLoop.next()){
+            for(unsigned int i = 0; i < n; i++){
+                suite.sink(profiler.newIssue(curPC, &benchInstr));
+                curPC += """ + str(self.wordSize) + """;
+                if(curPC >= codeEnd){
+                    curPC = codeStart;
+                }
+            }
+        }
+        curPC = codeStart;
+        """
+    code += """BenchmarkLoop symbolLoop(suite, "elffrontend_symbolat");
+        for(unsigned int n = symbolLoop.next(); n > 0; n = symbolLoop.next()){
+            for(unsigned int i = 0; i < n; i++){
+                suite.sink(elfFrontend.symbolAt(curPC).size());
+                curPC += """ + str(self.wordSize) + """;
+                if(curPC >= codeEnd){
+                    curPC = codeStart;
+                }
+            }
+        }
+    }
+
+    // End-to-end runs of the simulator
+    if(vm.count("programs") != 0){
+        HostCounters * hostCounters = NULL;
+        if(vm.count("host_counters") != 0){
+            hostCounters = new HostCounters();
+            if(!hostCounters->isSupported()){
+                std::cerr << "Unable to read the hardware counters of the host: " << "check the value of /proc/sys/kernel/perf_event_paranoid" << std::endl;
+                delete hostCounters;
+                hostCounters = NULL;
+            }
+        }
+        std::vector<std::string> programs = vm["programs"].as<std::vector<std::string> >();
+        std::vector<std::string>::const_iterator progIter, progEnd;
+        for(progIter = programs.begin(), progEnd = programs.end(); progIter != progEnd; progIter++){
+            suite.runSimulator(vm["simulator"].as<std::string>(), *progIter, hostCounters);
+        }
+        if(hostCounters != NULL){
+            delete hostCounters;
+        }
+    }
+
+    if(vm.count("baseline") != 0){
+        suite.writeBaseline(vm["baseline"].as<std::string>());
+    }
+    if(vm.count("compare") != 0){
+        std::cout << std::endl << "Comparison with the baseline " << vm["compare"].as<std::string>() << std::endl;
+        unsigned int numRegressions = suite.compare(vm["compare"].as<std::string>(), vm["threshold"].as<double>());
+        if(numRegressions > 0){
+            std::cout << numRegressions << " benchmarks regressed by more than " << vm["threshold"].as<double>() << "%" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+    """
+    mainCode = cxx_writer.writer_code.Code(code)
+    mainCode.addInclude('iostream')
+    mainCode.addInclude('string')
+    mainCode.addInclude('vector')
+    mainCode.addInclude('boost/program_options.hpp')
+    mainCode.addInclude('systemc.h')
+    mainCode.addInclude('tlm.h')
+    mainCode.addInclude('MemoryLT.hpp')
+    mainCode.addInclude('SparseMemoryLT.hpp')
+    mainCode.addInclude('processor.hpp')
+    mainCode.addInclude('decoder.hpp')
+    mainCode.addInclude('instructionBase.hpp')
+    mainCode.addInclude('ToolsIf.hpp')
+    mainCode.addInclude('elfFrontend.hpp')
+    mainCode.addInclude('benchmark.hpp')
+    mainCode.addInclude('hostCounters.hpp')
+    if self.abi:
+        mainCode.addInclude('profiler.hpp')
+    parameters = [cxx_writer.writer_code.Parameter('argc', cxx_writer.writer_code.intType), cxx_writer.writer_code.Parameter('argv', cxx_writer.writer_code.charPtrType.makePointer())]
+    mainFunction = cxx_writer.writer_code.Function('sc_main', mainCode, cxx_writer.writer_code.intType, parameters)
+    return mainFunction
+
+def getInstrMemory(self):
+    """Returns the name of the processor member (memory or port)
+    from which the instructions are fetched"""
+    for tlmPortName, fetch in self.tlmPorts.items():
+        if fetch:
+            return tlmPortName
+    if self.memory:
+        return self.memory[0]
+    return ''
+
+def getTranslatorTargetCode(self, model, namespace):
+    """Returns the code filling variable target with the description
+    of the processor used by the code translator"""
+    # Name of the class of each instruction, indexed by the instruction id; the
+    # invalid instruction is never translated
+    instrClasses = [''] * (max([instr.id for instr in self.isa.instructions.values()]) + 1)
+    for instr in self.isa.instructions.values():
+        instrClasses[instr.id] = instr.name
+    code = 'TranslatorTarget target;\n'
+    code += 'target.nameSpace = \"' + namespace + '\";\n'
+    code += 'target.processorClass = \"' + processor_name + '\";\n'
+    code += 'target.fetchType = \"' + str(self.bitSizes[1]) + '\";\n'
+    code += 'target.pcExpression = \"' + computeCurrentPC(self, model).replace('this->', 'processor->') + '\";\n'
+    code += 'target.instrMemory = \"' + getInstrMemory(self) + '\";\n'
+    code += 'target.wordSize = ' + str(self.wordSize) + ';\n'
+    code += 'const char * instrClasses[] = {' + ', '.join(['\"' + instrClass + '\"' for instrClass in instrClasses]) + '};\n'
+    code += 'target.instrClasses.assign(instrClasses, instrClasses + ' + str(len(instrClasses)) + ');\n'
+    return code
+
+def getTranslatorMainCode(self, model, namespace):
+    """Returns the code of the program which translates ahead of time
+    the code segments of an application to C++ code, which is then
+    compiled together with the simulator"""
+    wordType = self.bitSizes[1]
+    code = 'using namespace ' + namespace + ';\nusing namespace trap;\n\n'
+    code += """
+    boost::program_options::options_description desc("Ahead of time translator for """ + self.name + """", 120);
+    desc.add_options()
+        ("help,h", "produces the help message")
+        ("application,a", boost::program_options::value<std::string>(),
+                    "application to be translated")
+        ("output,o", boost::program_options::value<std::string>(),
+                    "file where the translated C++ code is written")
+        ("region_size", boost::program_options::value<unsigned int>()->default_value(1024),
+                    "size in bytes of the translated regions, a power of two")
+    ;
+
+    boost::program_options::variables_map vm;
+    try{
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    }
+    catch(boost::program_options::error &e){
+        std::cerr << "ERROR in parsing the command line parametrs" << std::endl << std::endl;
+        std::cerr << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    boost::program_options::notify(vm);
+    if(vm.count("help") != 0){
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    if(vm.count("application") == 0 || vm.count("output") == 0){
+        std::cerr << "It is necessary to specify the application to be translated and the output file" << " using the --application and --output command line options" << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    std::string application = vm["application"].as<std::string>();
+
+    """
+    code += getTranslatorTargetCode(self, model, namespace)
+    code += """CodeTranslator translator(target, vm["region_size"].as<unsigned int>());
+
+    // Only the instructions in the code segments are translated; when they are not known
+    // the whole application is examined
+    ExecLoader loader(application);
+    unsigned char * programData = loader.getProgData();
+    unsigned int programDim = loader.getProgDim();
+    unsigned int progDataStart = loader.getDataStart();
+    std::vector<std::pair<unsigned int, unsigned int> > codeSegments = ELFFrontend::getInstance(application).getCodeSegments();
+    if(codeSegments.empty()){
+        codeSegments.push_back(std::pair<unsigned int, unsigned int>(progDataStart, progDataStart + programDim));
+    }
+    Decoder decoder;
+    std::vector<std::pair<unsigned int, unsigned int> >::const_iterator segIter, segEnd;
+    for(segIter = codeSegments.begin(), segEnd = codeSegments.end(); segIter != segEnd; segIter++){
+        unsigned int start = std::max(segIter->first, progDataStart);
+        start += (""" + str(self.wordSize) + ' - start % ' + str(self.wordSize) + ') % ' + str(self.wordSize) + """;
+        unsigned int end = std::min(segIter->second, progDataStart + programDim);
+        for(unsigned int address = start; address + """ + str(self.wordSize) + ' <= end; address += ' + str(self.wordSize) + """){
+            """ + str(wordType) + """ word = 0;
+            for(unsigned int i = 0; i < """ + str(self.wordSize) + """; i++){
+    """
+    if self.isBigEndian:
+        code += 'word = (word << 8) | programData[address - progDataStart + i];\n'
+    else:
+        code += 'word |= ((' + str(wordType) + ')programData[address - progDataStart + i]) << (8*i);\n'
+    code += """}
+            translator.addInstruction(address, word, decoder.decode(word));
+        }
+    }
+
+    std::ofstream outFile(vm["output"].as<std::string>().c_str());
+    if(!outFile.good()){
+        std::cerr << "Unable to open the output file " << vm["output"].as<std::string>() << std::endl;
+        return -1;
+    }
+    translator.write(outFile, "Code of application " + application + " translated ahead of time for """ + self.name + """");
+    outFile.close();
+    std::cout << "Translated " << translator.getNumInstructions() << " instructions in " << translator.getNumRegions() << " regions" << std::endl;
+    return 0;
+    """
+    mainCode = cxx_writer.writer_code.Code(code)
+    mainCode.addInclude('iostream')
+    mainCode.addInclude('fstream')
+    mainCode.addInclude('string')
+    mainCode.addInclude('vector')
+    mainCode.addInclude('algorithm')
+    mainCode.addInclude('boost/program_options.hpp')
+    mainCode.addInclude('systemc.h')
+    mainCode.addInclude('decoder.hpp')
+    mainCode.addInclude('elfFrontend.hpp')
+    mainCode.addInclude('execLoader.hpp')
+    mainCode.addInclude('codeTranslator.hpp')
+    parameters = [cxx_writer.writer_code.Parameter('argc', cxx_writer.writer_code.intType), cxx_writer.writer_code.Parameter('argv', cxx_writer.writer_code.charPtrType.makePointer())]
+    mainFunction = cxx_writer.writer_code.Function('sc_main', mainCode, cxx_writer.writer_code.intType, parameters)
+    return mainFunction
+
+def getMainCode(self, model, namespace, trace = False):
     """Returns the code which instantiate the processor
     in order to execute simulations"""
     wordType = self.bitSizes[1]
@@ -1463,6 +2462,20 @@ def getMainCode(self, model, namespace):
                ("disassembler,i", "prints the disassembly of the application")
                ("history,y", boost::program_options::value<std::string>(),
                             "prints on the specified file the instruction history")
+               ("perf_counters", boost::program_options::value<std::string>(),
+                            "prints on the specified file the simulator performance counters")
+            """
+    if hasInstructionArena(self, model):
+        code += """("instr_cache_mem", boost::program_options::value<unsigned int>(),
+                    "maximum memory, in MB, used by the instructions kept in the instruction cache [Default 64MB]")
+               ("predecode", boost::program_options::value<unsigned int>(),
+                    "decodes the executable code of the application before starting the simulation, using the specified number of threads (0 for one per host core)")
+               ("decode_cache", boost::program_options::value<std::string>(),
+                    "folder where the decoded instructions are saved at the end of the simulation, to be restored by the next simulation of the same application")
+            """
+    if trace and model.startswith('func'):
+        code += """("trace_file", boost::program_options::value<std::string>(),
+                    "prints on the specified file the binary instruction trace (see trapTraceDump)")
             """
     if self.abi:
         code += """("arguments,r", boost::program_options::value<std::string>(),
@@ -1471,6 +2484,9 @@ def getMainCode(self, model, namespace):
                 "environmental variables (if any) visible to the application being simulated - comma separated")
             ("sysconf,s", boost::program_options::value<std::string>(),
                     "configuration information (if any) visible to the application being simulated - comma separated")
+            ("fs_manifest", boost::program_options::value<std::string>(),
+                    "manifest of the files kept in memory for the application being simulated")
+            ("memory_fs", "keeps in memory the files created by the application being simulated")
         """
     code += """;
 
@@ -1613,6 +2629,22 @@ def getMainCode(self, model, namespace):
         procInst.enableHistory(vm["history"].as<std::string>());
     }
     """
+    if hasInstructionArena(self, model):
+        code += """if(vm.count("instr_cache_mem") > 0){
+            procInst.instrArena.setCapacity(((std::size_t)vm["instr_cache_mem"].as<unsigned int>())*1024*1024);
+        }
+        """
+    code += """if(vm.count("perf_counters") > 0){
+        #ifndef ENABLE_PERF_COUNTERS
+        std::cout << std::endl << "Unable to collect the performance counters as they have " << "been disabled at compilation time" << std::endl << std::endl;
+        #endif
+    }
+    """
+    if trace and model.startswith('func'):
+        code += """if(vm.count("trace_file") > 0){
+            procInst.openBinaryTrace(vm["trace_file"].as<std::string>());
+        }
+        """
     if self.abi:
         code += """
         //Now I initialize the tools (i.e. debugger, os emulator, ...)
@@ -1622,7 +2654,7 @@ def getMainCode(self, model, namespace):
         #else:
         code += 'OSEmulator< ' + str(wordType) + '> osEmu(*(procInst.abiIf));\n'
         code += """GDBStub< """ + str(wordType) + """ > gdbStub(*(procInst.abiIf));
-        Profiler< """ + str(wordType) + """ > profiler(*(procInst.abiIf), vm["application"].as<std::string>(), vm.count("disable_fun_prof") > 0);
+        Profiler< """ + str(wordType) + """ > profiler(*(procInst.abiIf), vm["application"].as<std::string>(), vm.count("disable_fun_prof") > 0, """ + str(self.wordSize) + """);
 
         osEmu.initSysCalls(vm["application"].as<std::string>());
         std::vector<std::string> options;
@@ -1701,8 +2733,26 @@ def getMainCode(self, model, namespace):
                 }
             }
         }
-        procInst.toolManager.addTool(osEmu);
-        if(vm.count("debugger") != 0){
+        if(vm.count("fs_manifest") > 0){
+            osEmu.vfs.loadManifest(vm["fs_manifest"].as<std::string>());
+        }
+        if(vm.count("memory_fs") > 0){
+            osEmu.vfs.setMemoryOnly(true);
+        }
+        osEmu.setPerfCounters(&procInst.perfCounters);
+        """
+        if self.instructionCache and self.fastFetch and not model.startswith('acc'):
+            code += """// The emulated routines are bound to the instructions at their addresses when these are decoded:
+            // the OS emulator is not called for any other instruction
+            std::set<""" + str(wordType) + """> emulatedAddresses = osEmu.getRegisteredAddresses();
+            std::set<""" + str(wordType) + """>::const_iterator emulatedIter, emulatedEnd;
+            for(emulatedIter = emulatedAddresses.begin(), emulatedEnd = emulatedAddresses.end(); emulatedIter != emulatedEnd; emulatedIter++){
+                procInst.addEmulatedCall(*emulatedIter, osEmu);
+            }
+            """
+        else:
+            code += 'procInst.toolManager.addTool(osEmu);\n'
+        code += """if(vm.count("debugger") != 0){
             procInst.toolManager.addTool(gdbStub);
             gdbStub.initialize();
     """
@@ -1725,7 +2775,52 @@ def getMainCode(self, model, namespace):
                 }
                 procInst.toolManager.addTool(profiler);
             }
-
+    """
+    if hasTranslatedCode(self, model):
+        code += """
+        #ifdef TRAP_TRANSLATED_CODE
+        // The application was translated ahead of time: the translated code is used for
+        // the instructions which still match the ones loaded in memory
+        trapRegisterTranslatedCode(procInst);
+        """
+        if self.abi and self.instructionCache and self.fastFetch:
+            # The emulated routines are not tools, so they have to be excluded from the translated code
+            code += """for(emulatedIter = emulatedAddresses.begin(), emulatedEnd = emulatedAddresses.end(); emulatedIter != emulatedEnd; emulatedIter++){
+                procInst.translatedCode.invalidate(*emulatedIter, *emulatedIter + """ + str(self.wordSize) + """);
+            }
+            """
+        code += """unsigned int numTranslatedRegions = procInst.translatedCode.getNumRegions();
+        std::cout << "Using " << numTranslatedRegions << " regions of translated code" << std::endl;
+        #ifdef TRAP_JIT
+        // The regions compiled at run time have to be of the same size of the ones translated ahead of time
+        if(procInst.translatedCode.getRegionSize() != 0){
+            procInst.jit.setRegionSize(procInst.translatedCode.getRegionSize());
+        }
+        #endif
+        #endif
+        """
+    if hasInstructionArena(self, model):
+        # The signature identifies the decoder which produced the saved instructions
+        code += """std::string decodeCacheFile;
+        std::string decodeCacheSignature = \"""" + self.name + '_' + model + '_' + str(len(self.isa.instructions)) + """\";
+        if(vm.count("decode_cache") > 0){
+            decodeCacheFile = DecodeCache::getFileName(vm["decode_cache"].as<std::string>(), vm["application"].as<std::string>(), \"""" + self.name + '_' + model + """\");
+            DecodeCache decodeCache;
+            if(decodeCache.load(decodeCacheFile, decodeCacheSignature)){
+                unsigned int numRestored = procInst.restoreDecodedInstructions(decodeCache.entries);
+                std::cout << "Restored " << numRestored << " of " << decodeCache.entries.size() << " decoded instructions from " << decodeCacheFile << std::endl;
+            }
+        }
+        if(vm.count("predecode") > 0){
+            std::vector<std::pair<unsigned int, unsigned int> > codeSegments = ELFFrontend::getInstance(vm["application"].as<std::string>()).getCodeSegments();
+            if(codeSegments.empty()){
+                codeSegments.push_back(std::pair<unsigned int, unsigned int>(procInst.PROGRAM_START, procInst.PROGRAM_LIMIT));
+            }
+            unsigned int numPreDecoded = procInst.preDecode(codeSegments, vm["predecode"].as<unsigned int>());
+            std::cout << "Pre-decoded " << numPreDecoded << " instructions" << std::endl;
+        }
+        """
+    code += """
     // Lets register the signal handlers for the CTRL^C key combination
     (void) signal(SIGINT, stopSimFunction);
     (void) signal(SIGTERM, stopSimFunction);
@@ -1757,13 +2852,61 @@ def getMainCode(self, model, namespace):
                 """
     else:
         code += 'std::cout << \"Elapsed \" << std::dec << procInst.totalCycles << \" cycles\" << std::endl;\n'
+    if model.startswith('acc'):
+        # Statistics on the recycling of the replicated instructions
+        code += 'std::cout << \"Replicated instructions: \" << std::dec << trap::getFreeListStats().numAllocs << \" allocated (\" << trap::getFreeListStats().numRecycled << \" recycled), \" << trap::getFreeListStats().numFrees << \" freed\" << std::endl;\n'
+    if hasInstructionArena(self, model):
+        # Memory used by the instructions currently in the instruction cache
+        code += 'std::cout << \"Cached instructions: \" << std::dec << procInst.instrArena.getNumObjects() << \" using \" << procInst.instrArena.getUsed() << \" bytes\";\n'
+        code += 'if(procInst.instrArena.getNumObjects() > 0){\n'
+        code += 'std::cout << \" (\" << procInst.instrArena.getUsed()/procInst.instrArena.getNumObjects() << \" bytes per instruction)\";\n'
+        code += '}\n'
+        code += 'std::cout << \", \" << procInst.instrArena.getNumResets() << \" cache flushes\" << std::endl;\n'
+    if hasInstructionArena(self, model):
+        code += """if(!decodeCacheFile.empty()){
+            DecodeCache decodeCache;
+            procInst.saveDecodedInstructions(decodeCache.entries);
+            try{
+                decodeCache.save(decodeCacheFile, decodeCacheSignature);
+                std::cout << "Saved " << decodeCache.entries.size() << " decoded instructions in " << decodeCacheFile << std::endl;
+            }
+            catch(std::exception & e){
+                std::cerr << e.what() << std::endl;
+            }
+        }
+        """
+    if hasTranslatedCode(self, model):
+        code += '#ifdef TRAP_JIT\nunsigned int numJitRegions = procInst.jit.getNumCompiled();\n'
+        code += 'std::cout << \"Regions compiled at run time: \" << std::dec << numJitRegions << std::endl;\n#endif\n'
+    if trace and model.startswith('func'):
+        code += 'if(procInst.traceWriter.isOpen()){\n'
+        code += 'procInst.traceWriter.close();\n'
+        code += 'std::cout << \"Traced \" << std::dec << procInst.traceWriter.getNumRecords() << \" instructions\" << std::endl;\n'
+        code += '}\n'
     code += 'std::cout << std::endl;\n'
+    code += 'if(vm.count("perf_counters") > 0){\n'
+    if model.startswith('acc'):
+        # The pipeline stages only keep track of the retired instructions
+        code += 'procInst.perfCounters.instructions = procInst.numInstructions;\n'
+    code += """std::ofstream perfFile(vm["perf_counters"].as<std::string>().c_str());
+        if(!perfFile.good()){
+            std::cerr << "Unable to open the performance counters file " << vm["perf_counters"].as<std::string>() << std::endl;
+        }
+        else{
+            perfFile << PerfCounters::dumpAll();
+        }
+    }
+    """
     if self.endOp:
         code += '//Ok, simulation has ended: lets call cleanup methods\nprocInst.endOp();\n'
     code += """
     return 0;
     """
     mainCode = cxx_writer.writer_code.Code(code)
+    if model.startswith('acc'):
+        mainCode.addInclude('freeList.hpp')
+    if hasInstructionArena(self, model):
+        mainCode.addInclude('decodeCache.hpp')
     mainCode.addInclude("""#ifdef _WIN32
 #pragma warning( disable : 4101 )
 #endif""")
@@ -1771,6 +2914,7 @@ def getMainCode(self, model, namespace):
     mainCode.addInclude('#define WIN32_LEAN_AND_MEAN')
 
     mainCode.addInclude('iostream')
+    mainCode.addInclude('fstream')
     mainCode.addInclude('string')
     mainCode.addInclude('vector')
     mainCode.addInclude('set')
@@ -1793,6 +2937,7 @@ def getMainCode(self, model, namespace):
     mainCode.addInclude('processor.hpp')
     mainCode.addInclude('instructions.hpp')
     mainCode.addInclude('trap_utils.hpp')
+    mainCode.addInclude('perfCounters.hpp')
     mainCode.addInclude('systemc.h')
     mainCode.addInclude('elfFrontend.hpp')
     mainCode.addInclude('execLoader.hpp')
@@ -84,6 +84,8 @@ class Register:
         self.constValue = None
         self.delay = 0
         self.wbStageOrder = []
+        self.lazyFields = []
+        self.lazyOperations = []
 
     def setDefaultValue(self, value):
         if self.defValue:
@@ -116,6 +118,38 @@ class Register:
     def setWbStageOrder(self, order):
         self.wbStageOrder = order
 
+    def setLazyFields(self, fields):
+        """Declares a group of fields (typically the condition codes) which
+        are computed lazily by the functional processors: the instructions
+        only record the last operation updating them together with its
+        operands, and the fields are computed when the register is read"""
+        for field in fields:
+            if not self.bitMask.has_key(field):
+                raise Exception('Field ' + field + ' declared as lazy is not a field of register ' + self.name)
+        self.lazyFields = fields
+
+    def addLazyOperation(self, name, code, fields = None):
+        """Adds an operation updating the lazy fields: code computes the fields,
+        assigning the variables named as them, from operand1, operand2 and
+        operand3. fields lists the lazy fields updated by the operation, all
+        of them if not specified. The instructions record the operation with
+        REG.setLazy(lazy_name, operand1, operand2, operand3)"""
+        if not self.lazyFields:
+            raise Exception('No lazy fields declared for register ' + self.name + ': unable to add operation ' + name)
+        if name in [op[0] for op in self.lazyOperations]:
+            raise Exception('Lazy operation ' + name + ' already added to register ' + self.name)
+        if fields is None:
+            fields = self.lazyFields
+        for field in fields:
+            if not field in self.lazyFields:
+                raise Exception('Field ' + field + ' updated by lazy operation ' + name + ' is not a lazy field of register ' + self.name)
+        self.lazyOperations.append((name, code, fields))
+
+    def getLazyOperations(self):
+        """Returns the lazy operations, the ones updating all the lazy fields
+        first: operation number i + 1 corresponds to the i-th one"""
+        return [op for op in self.lazyOperations if len(op[2]) == len(self.lazyFields)] + [op for op in self.lazyOperations if len(op[2]) != len(self.lazyFields)]
+
     def getCPPClass(self, model, regType, namespace):
         return registerWriter.getCPPRegClass(self, model, regType, namespace)
 
@@ -144,6 +178,8 @@ class RegisterBank:
         self.offset = 0
         self.constValue = {}
         self.delay = {}
+        self.lazyFields = []
+        self.lazyOperations = []
 
     def setConst(self, numReg, value):
         if self.delay.has_key(numReg):
@@ -288,10 +324,28 @@ class AliasRegBank:
         self.offsets = {}
         self.fixedIndices = []
         self.checkGroup = False
+        self.windows = []
 
     def setCheckGroup(self):
         self.checkGroup = True
 
+    def addWindow(self, firstIndex, lastIndex, bankName):
+        """Declares that the aliases from firstIndex to lastIndex form a window
+        on register bank bankName: in the functional processors alias
+        firstIndex + i refers to register bankName[(base + i) % size], so that
+        moving the window (updateWindow(newBase) on any alias of the window,
+        where newBase is smaller than the size of the bank) only refreshes the
+        register cached by each alias, through a table. The initial aliases of the window must be
+        consecutive registers of the bank. The aliases of a window have to be
+        moved only through updateWindow: updateAlias detaches an alias from
+        its window, and calling updateWindow on it is then an error"""
+        if firstIndex < 0 or lastIndex >= self.numRegs or firstIndex > lastIndex:
+            raise Exception('Window ' + str(firstIndex) + '-' + str(lastIndex) + ' is not valid for alias bank ' + self.name)
+        for window in self.windows:
+            if firstIndex <= window[1] and lastIndex >= window[0]:
+                raise Exception('Window ' + str(firstIndex) + '-' + str(lastIndex) + ' overlaps with window ' + str(window[0]) + '-' + str(window[1]) + ' of alias bank ' + self.name)
+        self.windows.append((firstIndex, lastIndex, bankName))
+
     def setFixed(self, indices):
         for index in indices:
             if index >= self.numRegs:
@@ -335,8 +389,12 @@ class Processor:
     will be used for keeping time or not in the completely
     functional processor in case a local memory is used (in case TLM ports
     are used the systemc parameter is not taken into account)
+    The cycleDriven parameter specifies, for the cycle accurate processors,
+    whether the pipeline stages are separate SystemC threads synchronized
+    through events or whether a single thread advances all of them at
+    each clock cycle, calling their behavior as plain methods
     """
-    def __init__(self, name, version, systemc = True, coprocessor = False, instructionCache = True, fastFetch = False, externalClock = False, cacheLimit = 256):
+    def __init__(self, name, version, systemc = True, coprocessor = False, instructionCache = True, fastFetch = False, externalClock = False, cacheLimit = 256, cycleDriven = False):
         if coprocessor:
             raise Exception('Generation of co-processors not yet enabled')
         if externalClock:
@@ -372,8 +430,10 @@ class Processor:
         self.instructionCache = instructionCache
         self.fastFetch = fastFetch
         self.externalClock = externalClock
+        self.cycleDriven = cycleDriven
         self.preProcMacros = []
         self.tlmFakeMemProperties = ()
+        self.fetchBuffer = ()
         self.license_text = licenses.create_gpl_license(self.name)
         self.license = 'gpl'
         self.developer_name = ''
@@ -401,6 +461,17 @@ class Processor:
         """the memory latency is exrepssed in us"""
         self.tlmFakeMemProperties = (memSize, memLatency, sparse)
 
+    def setFetchBuffer(self, lineSize, beatLatency = 0):
+        """Enables, in the AT models, the fetch buffer of the TLM fetch port:
+        instead of issuing a transaction per instruction, an aligned line of
+        lineSize bytes is read in a single transaction and the following
+        sequential fetches are served from it. The beat latency (expressed in ns)
+        is the time needed for the transfer of each word of the line after
+        the first one"""
+        if lineSize <= 0 or (lineSize & (lineSize - 1)) != 0:
+            raise Exception('The size of the fetch buffer line must be a power of 2, while ' + str(lineSize) + ' was specified')
+        self.fetchBuffer = (lineSize, beatLatency)
+
     def setPreProcMacro(self, wafOption, macro):
         self.preProcMacros.append( (wafOption, macro) )
 
@@ -654,6 +725,11 @@ class Processor:
                 # Single register or alias: I check that it exists
                 if self.isRegExisting(memAliasReg.alias) is None:
                     raise Exception('Register ' + memAliasReg.alias + ' indicated in memory alias for address ' + memAliasReg.address)
+        if self.fetchBuffer:
+            if self.memory:
+                raise Exception('The fetch buffer can only be used when instructions are fetched from a TLM port')
+            if self.fetchBuffer[0] < self.wordSize:
+                raise Exception('The line of the fetch buffer (' + str(self.fetchBuffer[0]) + ' bytes) must contain at least one word')
         if self.memory and self.memory[3]:
             index = extractRegInterval(self.memory[3])
             if index:
@@ -970,14 +1046,24 @@ class Processor:
         BOOST_AUTO_TEST_MAIN and BOOST_TEST_DYN_LINK"""
         return procWriter.getTestMainCode(self)
 
-    def getMainCode(self, model, namespace):
+    def getTranslatorMainCode(self, model, namespace):
+        """Returns the code implementing the main
+        routine of the ahead of time translator"""
+        return procWriter.getTranslatorMainCode(self, model, namespace)
+
+    def getBenchmarkMainCode(self, model, namespace, decoderWords):
+        """Returns the code for the file which contains the main
+        routine of the benchmarks of the simulator components"""
+        return procWriter.getBenchmarkMainCode(self, model, namespace, decoderWords)
+
+    def getMainCode(self, model, namespace, trace = False):
         """Returns the code which instantiate the processor
         in order to execute simulations"""
-        return procWriter.getMainCode(self, model, namespace)
+        return procWriter.getMainCode(self, model, namespace, trace)
 
-    def getGetIRQPorts(self, namespace):
+    def getGetIRQPorts(self, model, namespace):
         """Returns the code implementing the interrupt ports"""
-        return portsWriter.getGetIRQPorts(self, namespace)
+        return portsWriter.getGetIRQPorts(self, model, namespace)
 
     def getGetIRQInstr(self, model, trace, combinedTrace, namespace):
         """Returns the code implementing the fake interrupt instruction"""
@@ -996,7 +1082,7 @@ class Processor:
         """Returns the code implementing the pipeline stages"""
         return pipelineWriter.getGetPipelineStages(self, trace, combinedTrace, model, namespace)
 
-    def write(self, folder = '', models = validModels, namespace = '', dumpDecoderName = '', trace = False, combinedTrace = False, forceDecoderCreation = False, tests = True, memPenaltyFactor = 4):
+    def write(self, folder = '', models = validModels, namespace = '', dumpDecoderName = '', trace = False, combinedTrace = False, forceDecoderCreation = False, tests = True, memPenaltyFactor = 4, benchmarks = True):
         """Ok: this method does two things: first of all it performs all
         the possible checks to ensure that the processor description is
         coherent. Second it actually calls the write method of the
@@ -1100,7 +1186,7 @@ class Processor:
                 namespace = self.name.lower() + '_' + model.lower() + '_trap'
             namespaceUse = cxx_writer.writer_code.UseNamespace(namespace)
             namespaceTrapUse = cxx_writer.writer_code.UseNamespace('trap')
-            decClasses = dec.getCPPClass(self.bitSizes[1], self.instructionCache, namespace)
+            decClasses = dec.getCPPClass(self.bitSizes[1], self.instructionCache, namespace, procWriter.hasFusedInstructions(self, model, trace))
             implFileDec = cxx_writer.writer_code.FileDumper('decoder.cpp', False)
             headFileDec = cxx_writer.writer_code.FileDumper('decoder.hpp', True)
             headFileDec.addMember(defCode)
@@ -1124,7 +1210,7 @@ class Processor:
             ISAClasses = self.isa.getCPPClasses(self, model, trace, combinedTrace, namespace)
             IRQClasses = []
             if self.irqs:
-                IRQClasses += self.getGetIRQPorts(namespace)
+                IRQClasses += self.getGetIRQPorts(model, namespace)
                 ISAClasses += self.getGetIRQInstr(model, trace, combinedTrace, namespace)
             # Ok, now that we have all the classes it is time to write
             # them to file
@@ -1155,6 +1241,8 @@ class Processor:
             headFileProc.addMember(defCode)
             headFileProc.addMember(namespaceTrapUse)
             headFileProc.addMember(ProcClass)
+            if procWriter.hasTranslatedCode(self, model):
+                headFileProc.addMember(cxx_writer.writer_code.Define('#ifdef TRAP_TRANSLATED_CODE\n// Defined by the code translated ahead of time from the application\nextern "C" unsigned int trapRegisterTranslatedCode(' + namespace + '::' + procWriter.processor_name + ' & translatedProcessor);\n#endif\n'))
             implFileProc.addInclude('processor.hpp')
             if model.startswith('acc'):
                 implFilePipe = cxx_writer.writer_code.FileDumper('pipeline.cpp', False)
@@ -1221,7 +1309,26 @@ class Processor:
                     implFilePIN.addMember(i)
                     headFilePIN.addMember(i)
             mainFile = cxx_writer.writer_code.FileDumper('main.cpp', False)
-            mainFile.addMember(self.getMainCode(model, namespace))
+            mainFile.addMember(self.getMainCode(model, namespace, trace))
+
+            if (model == 'funcLT') and benchmarks:
+                # Program measuring the performance of the single components of the simulator
+                benchFolder = cxx_writer.writer_code.Folder('benchmarks')
+                curFolder.addSubFolder(benchFolder)
+                mainBenchFile = cxx_writer.writer_code.FileDumper('main.cpp', False)
+                mainBenchFile.addMember(self.getBenchmarkMainCode(model, namespace, dec.getBenchmarkWords()))
+                benchFolder.addCode(mainBenchFile)
+                benchFolder.addUseLib(os.path.split(curFolder.path)[-1] + '_objs')
+
+            if procWriter.hasTranslatedCode(self, model):
+                # Program translating ahead of time the applications to C++ code, which
+                # is compiled together with the simulator
+                translatorFolder = cxx_writer.writer_code.Folder('translator')
+                curFolder.addSubFolder(translatorFolder)
+                mainTranslatorFile = cxx_writer.writer_code.FileDumper('main.cpp', False)
+                mainTranslatorFile.addMember(self.getTranslatorMainCode(model, namespace))
+                translatorFolder.addCode(mainTranslatorFile)
+                translatorFolder.addUseLib(os.path.split(curFolder.path)[-1] + '_objs')
 
             if (model == 'funcLT') and (not self.systemc) and tests:
                 testFolder = cxx_writer.writer_code.Folder('tests')
@@ -1315,7 +1422,13 @@ class Processor:
                 curFolder.addCode(implFilePIN)
             curFolder.addCode(mainFile)
             curFolder.setMain(mainFile.name)
+            if procWriter.hasTranslatedCode(self, model):
+                curFolder.setTranslatedCode()
             curFolder.create()
+            if (model == 'funcLT') and benchmarks:
+                benchFolder.create()
+            if procWriter.hasTranslatedCode(self, model):
+                translatorFolder.create()
             if (model == 'funcLT') and (not self.systemc) and tests:
                 testFolder.create(configure = False, tests = True)
             print ('\t\tCreated in folder ' + os.path.expanduser(os.path.expandvars(folder)))
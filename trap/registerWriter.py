@@ -56,8 +56,94 @@ def getRegistersBitfields(self):
                 defineCode += '#define key_' + key + ' ' + str(numKeys) + '\n'
                 addedKeys.append(key)
                 numKeys += 1
+    # Identifiers of the operations updating the lazy fields of the registers
+    addedOperations = []
+    for reg in self.regs:
+        lazyOperations = reg.getLazyOperations()
+        for i in range(0, len(lazyOperations)):
+            if lazyOperations[i][0] in addedOperations:
+                raise Exception('Lazy operation ' + lazyOperations[i][0] + ' of register ' + reg.name + ' has the same name of an operation of another register')
+            defineCode += '#define lazy_' + lazyOperations[i][0] + ' ' + str(i + 1) + '\n'
+            addedOperations.append(lazyOperations[i][0])
     return cxx_writer.writer_code.Code(defineCode + '\n\n')
 
+def hasLazyFields(self, model):
+    """Returns true if the lazy fields of the register are actually computed
+    lazily: this happens only in the functional models and for registers
+    which are not constant, delayed or with an offset; otherwise the
+    lazy operations update the fields as soon as they are recorded"""
+    if not self.lazyFields or model.startswith('acc'):
+        return False
+    return type(self.delay) == type(0) and self.delay == 0 and self.constValue == None and not self.offset
+
+def getLazyFieldsCode(self, model, regType):
+    """Returns the methods and the attributes used to record the operations
+    updating the lazy fields of the register and to compute the fields"""
+    lazyElements = []
+    lazyAttrs = []
+    lazyOperations = self.getLazyOperations()
+    numFullOperations = len([op for op in lazyOperations if len(op[2]) == len(self.lazyFields)])
+    switchCode = ''
+    for name, code, fields in lazyOperations:
+        switchCode += 'case lazy_' + name + ':{\n' + str(code) + '\nbreak;\n}\n'
+    operandsParams = [cxx_writer.writer_code.Parameter('operand' + str(i), regMaxType.makeRef().makeConst()) for i in range(1, 4)]
+    operationParam = cxx_writer.writer_code.Parameter('operation', cxx_writer.writer_code.uintType)
+    if hasLazyFields(self, model):
+        # The fields are computed from the last recorded operation, starting from
+        # their current value for the operations which do not update all of them
+        evaluateCode = ''
+        lazyMask = 0
+        for field in self.lazyFields:
+            fieldMask = ((1 << (self.bitMask[field][1] - self.bitMask[field][0] + 1)) - 1) << self.bitMask[field][0]
+            lazyMask |= fieldMask
+            evaluateCode += str(regMaxType) + ' ' + field + ' = (this->value & ' + hex(fieldMask).rstrip('L') + ')'
+            if self.bitMask[field][0] > 0:
+                evaluateCode += ' >> ' + str(self.bitMask[field][0])
+            evaluateCode += ';\n'
+        for i in range(1, 4):
+            evaluateCode += 'const ' + str(regMaxType) + ' & operand' + str(i) + ' = this->lazyOperand' + str(i) + ';\n'
+        evaluateCode += 'switch(this->lazyOperation){\n' + switchCode + '}\n'
+        evaluateCode += 'this->value &= ' + hex(~lazyMask & ((1 << self.bitWidth) - 1)).rstrip('L') + ';\n'
+        for field in self.lazyFields:
+            fieldLenMask = (1 << (self.bitMask[field][1] - self.bitMask[field][0] + 1)) - 1
+            evaluateCode += 'this->value |= ((' + field + ' & ' + hex(fieldLenMask).rstrip('L') + ')'
+            if self.bitMask[field][0] > 0:
+                evaluateCode += ' << ' + str(self.bitMask[field][0])
+            evaluateCode += ');\n'
+        evaluateCode += 'this->lazyOperation = 0;\n'
+        evaluateMethod = cxx_writer.writer_code.Method('evaluateLazy', cxx_writer.writer_code.Code(evaluateCode), cxx_writer.writer_code.voidType, 'pu', noException = True)
+        lazyElements.append(evaluateMethod)
+        flushBody = cxx_writer.writer_code.Code('if(this->lazyOperation != 0){\nthis->evaluateLazy();\n}')
+        flushMethod = cxx_writer.writer_code.Method('flushLazy', flushBody, cxx_writer.writer_code.voidType, 'pu', inline = True, noException = True)
+        lazyElements.append(flushMethod)
+        getValueBody = cxx_writer.writer_code.Code('if(this->lazyOperation != 0){\nconst_cast< ' + regType.name + ' * >(this)->evaluateLazy();\n}\nreturn this->value;')
+        getValueMethod = cxx_writer.writer_code.Method('getValue', getValueBody, regMaxType.makeRef().makeConst(), 'pu', inline = True, noException = True, const = True)
+        lazyElements.append(getValueMethod)
+        # An operation which does not update all the fields needs the result of
+        # the previous one
+        setLazyCode = ''
+        if numFullOperations < len(lazyOperations):
+            setLazyCode += 'if(operation > ' + str(numFullOperations) + ' && this->lazyOperation != 0){\nthis->evaluateLazy();\n}\n'
+        setLazyCode += 'this->lazyOperation = operation;\n'
+        for i in range(1, 4):
+            setLazyCode += 'this->lazyOperand' + str(i) + ' = operand' + str(i) + ';\n'
+        setLazyMethod = cxx_writer.writer_code.Method('setLazy', cxx_writer.writer_code.Code(setLazyCode), cxx_writer.writer_code.voidType, 'pu', [operationParam] + operandsParams, inline = True, noException = True)
+        lazyElements.append(setLazyMethod)
+        lazyAttrs.append(cxx_writer.writer_code.Attribute('lazyOperation', cxx_writer.writer_code.uintType, 'pri'))
+        for i in range(1, 4):
+            lazyAttrs.append(cxx_writer.writer_code.Attribute('lazyOperand' + str(i), regMaxType, 'pri'))
+    else:
+        # The fields are immediately updated through the normal field accesses
+        setLazyCode = ''
+        for field in self.lazyFields:
+            setLazyCode += str(regMaxType) + ' ' + field + ' = this->field_' + field + ';\n'
+        setLazyCode += 'switch(operation){\n' + switchCode + '}\n'
+        for field in self.lazyFields:
+            setLazyCode += 'this->field_' + field + ' = ' + field + ';\n'
+        setLazyMethod = cxx_writer.writer_code.Method('setLazy', cxx_writer.writer_code.Code(setLazyCode), cxx_writer.writer_code.voidType, 'pu', [operationParam] + operandsParams, noException = True)
+        lazyElements.append(setLazyMethod)
+    return (lazyElements, lazyAttrs)
+
 def getCPPRegClass(self, model, regType, namespace):
     """returns the class implementing the current register; I have to
     define all the operators;"""
@@ -79,9 +165,19 @@ def getCPPRegClass(self, model, regType, namespace):
         assignValueItem = 'this->value'
         readValueItem = 'this->value'
     else:
-        assignValueItem = 'this->updateSlot[' + str(self.delay - 1) + '] = true;\nthis->values[' + str(self.delay - 1) + ']'
+        assignValueItem = 'this->markPending();\nthis->updateSlot[' + str(self.delay - 1) + '] = true;\nthis->values[' + str(self.delay - 1) + ']'
         readValueItem = 'this->value'
 
+    # Lazy fields: the value is read only after having computed them
+    lazy = hasLazyFields(self, model)
+    if lazy:
+        readValueItem = 'this->getValue()'
+        otherValueItem = 'other.getValue()'
+        flushValueItem = 'this->flushLazy();\n'
+    else:
+        otherValueItem = 'other.value'
+        flushValueItem = ''
+
     if constReg and model.startswith('acc'):
         isLockedBody = cxx_writer.writer_code.Code('return false;')
         isLockedMethod = cxx_writer.writer_code.Method('isLocked', isLockedBody, cxx_writer.writer_code.boolType, 'pu', noException = True)
@@ -115,6 +211,8 @@ def getCPPRegClass(self, model, regType, namespace):
                         this->updateSlot[""" + str(i - 1) + """] = true;
                     }
                     """
+        # The register stays in the processor's pending list only while some write is still in flight
+        clockCycleCode += 'this->updatePending = ' + ' || '.join(['this->updateSlot[' + str(i) + ']' for i in range(0, self.delay)]) + ';\n'
         clockCycleBody = cxx_writer.writer_code.Code(clockCycleCode)
         clockCycleMethod = cxx_writer.writer_code.Method('clockCycle', clockCycleBody, cxx_writer.writer_code.voidType, 'pu', inline = True, noException = True)
         registerElements.append(clockCycleMethod)
@@ -128,6 +226,8 @@ def getCPPRegClass(self, model, regType, namespace):
         registerElements.append(forceValueMethod)
     if self.constValue == None or type(self.constValue) == type({}):
         immediateWriteCode = 'this->value = value;\n'
+        if lazy:
+            immediateWriteCode = 'this->lazyOperation = 0;\n' + immediateWriteCode
         if not model.startswith('acc') and type(self.delay) != type({}) and self.delay > 0:
             for i in range(0, self.delay):
                 immediateWriteCode += 'this->updateSlot[' + str(i) + '] = false;\n'
@@ -162,7 +262,7 @@ def getCPPRegClass(self, model, regType, namespace):
         if not model.startswith('acc') and self.offset:
             readNewValueCode = 'return this->value + ' + str(self.offset) + ';\n'
         else:
-            readNewValueCode = 'return this->value;\n'
+            readNewValueCode = 'return ' + readValueItem + ';\n'
         #try:
             #for i in range(0, self.delay):
                 #immediateWriteCode += 'this->updateSlot[' + str(i) + '] = false;\n'
@@ -189,7 +289,7 @@ def getCPPRegClass(self, model, regType, namespace):
         elif model.startswith('acc'):
             operatorBody = cxx_writer.writer_code.Code(assignValueItem + ' ' + i + ' other;\n*(this->hasToPropagate) = true;\nthis->timeStamp = sc_time_stamp();\nreturn *this;')
         else:
-            operatorBody = cxx_writer.writer_code.Code(assignValueItem + ' ' + i + ' other;\nreturn *this;')
+            operatorBody = cxx_writer.writer_code.Code(flushValueItem + assignValueItem + ' ' + i + ' other;\nreturn *this;')
         operatorParam = cxx_writer.writer_code.Parameter('other', regMaxType.makeRef().makeConst())
         operatorDecl = cxx_writer.writer_code.MemberOperator(i, operatorBody, regType.makeRef(), 'pu', [operatorParam], noException = True)
         registerElements.append(operatorDecl)
@@ -198,7 +298,7 @@ def getCPPRegClass(self, model, regType, namespace):
         if self.offset and not model.startswith('acc'):
             operatorBody = cxx_writer.writer_code.Code('return ((' + readValueItem + '  + ' + str(self.offset) + ') ' + i + ' (other.value + ' + str(self.offset) + '));')
         else:
-            operatorBody = cxx_writer.writer_code.Code('return (' + readValueItem + ' ' + i + ' other.value);')
+            operatorBody = cxx_writer.writer_code.Code('return (' + readValueItem + ' ' + i + ' ' + otherValueItem + ');')
         operatorParam = cxx_writer.writer_code.Parameter('other', regType.makeRef().makeConst())
         operatorDecl = cxx_writer.writer_code.MemberOperator(i, operatorBody, regMaxType, 'pu', [operatorParam], const = True, noException = True)
         registerElements.append(operatorDecl)
@@ -206,7 +306,7 @@ def getCPPRegClass(self, model, regType, namespace):
         if self.offset and not model.startswith('acc'):
             operatorBody = cxx_writer.writer_code.Code('return ((' + readValueItem + ' + ' + str(self.offset) + ') ' + i + ' (other.value + ' + str(self.offset) + '));')
         else:
-            operatorBody = cxx_writer.writer_code.Code('return (' + readValueItem + ' ' + i + ' other.value);')
+            operatorBody = cxx_writer.writer_code.Code('return (' + readValueItem + ' ' + i + ' ' + otherValueItem + ');')
         operatorParam = cxx_writer.writer_code.Parameter('other', regType.makeRef().makeConst())
         operatorDecl = cxx_writer.writer_code.MemberOperator(i, operatorBody, cxx_writer.writer_code.boolType, 'pu', [operatorParam], const = True, noException = True)
         registerElements.append(operatorDecl)
@@ -216,7 +316,7 @@ def getCPPRegClass(self, model, regType, namespace):
         elif model.startswith('acc'):
             operatorBody = cxx_writer.writer_code.Code(assignValueItem + ' ' + i + ' other;\n*(this->hasToPropagate) = true;\nthis->timeStamp = sc_time_stamp();\nreturn *this;')
         else:
-            operatorBody = cxx_writer.writer_code.Code(assignValueItem + ' ' + i + ' other;\nreturn *this;')
+            operatorBody = cxx_writer.writer_code.Code(flushValueItem + assignValueItem + ' ' + i + ' other;\nreturn *this;')
         operatorParam = cxx_writer.writer_code.Parameter('other', regType.makeRef().makeConst())
         operatorDecl = cxx_writer.writer_code.MemberOperator(i, operatorBody, regType.makeRef(), 'pu', [operatorParam], noException = True)
         registerElements.append(operatorDecl)
@@ -244,7 +344,7 @@ def getCPPRegClass(self, model, regType, namespace):
         elif model.startswith('acc'):
             operatorBody = cxx_writer.writer_code.Code(assignValueItem + ' ' + i + ' other;\n*(this->hasToPropagate) = true;\nthis->timeStamp = sc_time_stamp();\nreturn *this;')
         else:
-            operatorBody = cxx_writer.writer_code.Code(assignValueItem + ' ' + i + ' other;\nreturn *this;')
+            operatorBody = cxx_writer.writer_code.Code(flushValueItem + assignValueItem + ' ' + i + ' other;\nreturn *this;')
         operatorParam = cxx_writer.writer_code.Parameter('other', registerType.makeRef().makeConst())
         operatorDecl = cxx_writer.writer_code.MemberOperator(i, operatorBody, regType.makeRef(), 'pu', [operatorParam], noException = True)
         registerElements.append(operatorDecl)
@@ -260,17 +360,22 @@ def getCPPRegClass(self, model, regType, namespace):
     fieldInit = []
     if not model.startswith('acc') and type(self.delay) != type({}) and self.delay > 0:
         for field in self.bitMask.keys():
-            fieldInit.append('field_' + field + '(this->value, this->values[' + str(self.delay - 1) + '], this->updateSlot[' + str(self.delay - 1) + '])')
+            fieldInit.append('field_' + field + '(this->value, this->values[' + str(self.delay - 1) + '], this->updateSlot[' + str(self.delay - 1) + '], *this)')
     elif model.startswith('acc'):
         for field in self.bitMask.keys():
             fieldInit.append('field_' + field + '(this->value, this->timeStamp, this->hasToPropagate)')
     else:
         for field in self.bitMask.keys():
-            fieldInit.append('field_' + field + '(this->value)')
+            if lazy and field in self.lazyFields:
+                fieldInit.append('field_' + field + '(this->value, *this)')
+            else:
+                fieldInit.append('field_' + field + '(this->value)')
     if self.constValue != None and type(self.constValue) != type({}):
         constructorCode = 'this->value = ' + readValueItem + ';\n'
     else:
         constructorCode = 'this->value = 0;\n'
+    if lazy:
+        constructorCode += 'this->lazyOperation = 0;\n'
     if not model.startswith('acc') and type(self.delay) != type({}) and self.delay != 0:
         for i in range(0, self.delay):
             constructorCode += 'this->updateSlot[' + str(i) + '] = false;\n'
@@ -308,7 +413,7 @@ def getCPPRegClass(self, model, regType, namespace):
                 fieldLenMask = '0' + fieldLenMask
         operatorCode = ''
         if not model.startswith('acc') and type(self.delay) != type({}) and self.delay > 0:
-            operatorCode += 'this->lastValid = true;\n'
+            operatorCode += 'this->owner.markPending();\nthis->lastValid = true;\n'
             if type(readValueItem) != type(0):
                 if onesMask != negatedMask:
                     operatorCode += 'this->valueLast = (this->value & ' + hex(int(negatedMask, 2)) + ');\n'
@@ -318,6 +423,8 @@ def getCPPRegClass(self, model, regType, namespace):
                 else:
                     operatorCode += 'other;\n'
         else:
+            if lazy and field in self.lazyFields:
+                operatorCode += 'this->owner.flushLazy();\n'
             if type(readValueItem) != type(0):
                 if onesMask != negatedMask:
                     operatorCode += 'this->value &= ' + hex(int(negatedMask, 2)) + ';\n'
@@ -333,7 +440,10 @@ def getCPPRegClass(self, model, regType, namespace):
         operatorParam = cxx_writer.writer_code.Parameter('other', regMaxType.makeRef().makeConst())
         operatorEqualDecl = cxx_writer.writer_code.MemberOperator('=', operatorBody, cxx_writer.writer_code.Type('InnerField').makeRef(), 'pu', [operatorParam], noException = True)
         InnerFieldElems.append(operatorEqualDecl)
-        operatorCode = 'return (this->value & ' + hex(int(mask, 2)) + ')'
+        if lazy and field in self.lazyFields:
+            operatorCode = 'return (this->owner.getValue() & ' + hex(int(mask, 2)) + ')'
+        else:
+            operatorCode = 'return (this->value & ' + hex(int(mask, 2)) + ')'
         if length[0] > 0:
             operatorCode += ' >> ' + str(length[0])
         operatorCode += ';'
@@ -347,6 +457,11 @@ def getCPPRegClass(self, model, regType, namespace):
             InnerFieldElems.append(fieldAttribute)
             fieldAttribute = cxx_writer.writer_code.Attribute('lastValid', cxx_writer.writer_code.boolType.makeRef(), 'pri')
             InnerFieldElems.append(fieldAttribute)
+            fieldAttribute = cxx_writer.writer_code.Attribute('owner', registerType.makeRef(), 'pri')
+            InnerFieldElems.append(fieldAttribute)
+        elif lazy and field in self.lazyFields:
+            fieldAttribute = cxx_writer.writer_code.Attribute('owner', regType.makeRef(), 'pri')
+            InnerFieldElems.append(fieldAttribute)
         elif model.startswith('acc'):
             timeStampAttribute = cxx_writer.writer_code.Attribute('timeStamp', cxx_writer.writer_code.sc_timeType.makeRef(), 'pri')
             InnerFieldElems.append(timeStampAttribute)
@@ -359,6 +474,11 @@ def getCPPRegClass(self, model, regType, namespace):
             constructorInit.append('valueLast(valueLast)')
             constructorParams.append(cxx_writer.writer_code.Parameter('lastValid', cxx_writer.writer_code.boolType.makeRef()))
             constructorInit.append('lastValid(lastValid)')
+            constructorParams.append(cxx_writer.writer_code.Parameter('owner', registerType.makeRef()))
+            constructorInit.append('owner(owner)')
+        elif lazy and field in self.lazyFields:
+            constructorParams.append(cxx_writer.writer_code.Parameter('owner', regType.makeRef()))
+            constructorInit.append('owner(owner)')
         elif model.startswith('acc'):
             constructorParams.append(cxx_writer.writer_code.Parameter('timeStamp', cxx_writer.writer_code.sc_timeType.makeRef()))
             constructorInit.append('timeStamp(timeStamp)')
@@ -395,6 +515,10 @@ def getCPPRegClass(self, model, regType, namespace):
         attrs.append(delaySlotAttribute)
         updateSlotAttribute = cxx_writer.writer_code.Attribute('updateSlot[' + str(self.delay) + ']', cxx_writer.writer_code.boolType, 'pri')
         attrs.append(updateSlotAttribute)
+    if self.lazyFields:
+        lazyElements, lazyAttrs = getLazyFieldsCode(self, model, regType)
+        registerElements += lazyElements
+        attrs += lazyAttrs
     registerElements = attrs + registerElements
 
     registerDecl = cxx_writer.writer_code.ClassDeclaration(regType.name, registerElements, [registerType], namespaces = [namespace])
@@ -476,9 +600,6 @@ def getCPPPipelineReg(self, trace, combinedTrace, namespace):
     this->reg_all->unlock();""")
     unlockMethod = cxx_writer.writer_code.Method('unlock', unlockBody, cxx_writer.writer_code.voidType, 'pu', virtual = True, noException = True)
     registerElements.append(unlockMethod)
-    latencyParam = cxx_writer.writer_code.Parameter('wbLatency', cxx_writer.writer_code.intType)
-    unlockMethod = cxx_writer.writer_code.Method('unlock', unlockBody, cxx_writer.writer_code.voidType, 'pu', [latencyParam], virtual = True, noException = True)
-    registerElements.append(unlockMethod)
     isLockedBody = cxx_writer.writer_code.Code('return this->reg_all->isLocked();')
     isLockedMethod = cxx_writer.writer_code.Method('isLocked', isLockedBody, cxx_writer.writer_code.boolType, 'pu', noException = True)
     registerElements.append(isLockedMethod)
@@ -698,67 +819,49 @@ def getCPPRegisters(self, trace, combinedTrace, model, namespace):
     emptyBody = cxx_writer.writer_code.Code('')
 
     ################ Constructor: it initializes the width of the register ######################
+    # Delayed registers of the functional models notify their pending writes to the processor,
+    # so that only them are updated at the end of each instruction
+    hasDelayedRegs = not model.startswith('acc') and (len([i for i in self.regs if i.delay]) > 0 or len([i for i in self.regBanks if i.delay]) > 0)
     constructorCode = ''
     if model.startswith('acc'):
         constructorCode += 'this->numLocked = 0;\n'
-        constructorCode += 'this->lockedLatency = -1;\n'
         constructorCode += 'this->hasToPropagate = NULL;\n'
         constructorCode += 'this->timeStamp = SC_ZERO_TIME;\n'
+    elif hasDelayedRegs:
+        constructorCode += 'this->pendingUpdates = NULL;\n'
+        constructorCode += 'this->updatePending = false;\n'
     constructorBody = cxx_writer.writer_code.Code(constructorCode)
     publicConstr = cxx_writer.writer_code.Constructor(constructorBody, 'pu')
 
     constructorCode = ''
     if model.startswith('acc'):
         constructorCode += 'this->numLocked = other.numLocked;\n'
-        constructorCode += 'this->lockedLatency = other.lockedLatency;\n'
         constructorCode += 'this->hasToPropagate = other.hasToPropagate;\n'
         constructorCode += 'this->timeStamp = other.timeStamp;\n'
+    elif hasDelayedRegs:
+        constructorCode += 'this->pendingUpdates = other.pendingUpdates;\n'
+        constructorCode += 'this->updatePending = false;\n'
     copyConstrParam = cxx_writer.writer_code.Parameter('other', registerType.makeRef().makeConst())
     copyConstrBody = cxx_writer.writer_code.Code(constructorCode)
     copyConstr = cxx_writer.writer_code.Constructor(copyConstrBody, 'pu', [copyConstrParam])
 
     ################ Lock and Unlock methods used for hazards detection ######################
     if model.startswith('acc'):
-        lockedLatencyAttribute = cxx_writer.writer_code.Attribute('lockedLatency', cxx_writer.writer_code.intType, 'pri')
-        registerElements.append(lockedLatencyAttribute)
         lockedAttribute = cxx_writer.writer_code.Attribute('numLocked', cxx_writer.writer_code.intType, 'pri')
         registerElements.append(lockedAttribute)
         propagateAttribute = cxx_writer.writer_code.Attribute('hasToPropagate', cxx_writer.writer_code.boolType.makePointer(), 'pu')
         registerElements.append(propagateAttribute)
         timeStampAttribute = cxx_writer.writer_code.Attribute('timeStamp', cxx_writer.writer_code.sc_timeType, 'pu')
         registerElements.append(timeStampAttribute)
-        lockBody = cxx_writer.writer_code.Code('this->lockedLatency = -1;\nthis->numLocked++;')
+        lockBody = cxx_writer.writer_code.Code('this->numLocked++;')
         lockMethod = cxx_writer.writer_code.Method('lock', lockBody, cxx_writer.writer_code.voidType, 'pu', virtual = True, noException = True)
         registerElements.append(lockMethod)
-        unlockBody = cxx_writer.writer_code.Code('this->lockedLatency = -1;\nif(this->numLocked > 0){\nthis->numLocked--;\n}')
+        # Delayed unlocks are managed by the timing wheel of the pipeline, which calls
+        # unlock only when the write back latency has elapsed: isLocked has no side effects
+        unlockBody = cxx_writer.writer_code.Code('if(this->numLocked > 0){\nthis->numLocked--;\n}')
         unlockMethod = cxx_writer.writer_code.Method('unlock', unlockBody, cxx_writer.writer_code.voidType, 'pu', virtual = True, noException = True)
         registerElements.append(unlockMethod)
-        latencyParam = cxx_writer.writer_code.Parameter('wbLatency', cxx_writer.writer_code.intType)
-        unlockBody = cxx_writer.writer_code.Code("""if(wbLatency > 0){
-            this->lockedLatency = wbLatency;
-        }
-        else{
-            this->lockedLatency = -1;
-            if(this->numLocked > 0){
-                this->numLocked--;
-            }
-        }""")
-        unlockMethod = cxx_writer.writer_code.Method('unlock', unlockBody, cxx_writer.writer_code.voidType, 'pu', [latencyParam], virtual = True, noException = True)
-        registerElements.append(unlockMethod)
-        isLockedBody = cxx_writer.writer_code.Code("""if(this->lockedLatency > 0){
-            this->lockedLatency--;
-            if(this->lockedLatency == 0){
-                this->numLocked--;
-            }
-        }
-        if(this->numLocked > 0){
-            return true;
-        }
-        else{
-            this->numLocked = 0;
-            return false;
-        }
-        """)
+        isLockedBody = cxx_writer.writer_code.Code('return this->numLocked > 0;')
         isLockedMethod = cxx_writer.writer_code.Method('isLocked', isLockedBody, cxx_writer.writer_code.boolType, 'pu', noException = True, virtual = True)
         registerElements.append(isLockedMethod)
 
@@ -771,6 +874,23 @@ def getCPPRegisters(self, trace, combinedTrace, model, namespace):
     if not model.startswith('acc'):
         clockCycleMethod = cxx_writer.writer_code.Method('clockCycle', emptyBody, cxx_writer.writer_code.voidType, 'pu', virtual = True, noException = True)
         registerElements.append(clockCycleMethod)
+        if hasDelayedRegs:
+            registerPtrType = registerType.makePointer()
+            pendingUpdatesType = cxx_writer.writer_code.TemplateType('std::vector', [registerPtrType], 'vector')
+            pendingUpdatesAttribute = cxx_writer.writer_code.Attribute('pendingUpdates', pendingUpdatesType.makePointer(), 'pro')
+            registerElements.append(pendingUpdatesAttribute)
+            updatePendingAttribute = cxx_writer.writer_code.Attribute('updatePending', cxx_writer.writer_code.boolType, 'pro')
+            registerElements.append(updatePendingAttribute)
+            setPendingBody = cxx_writer.writer_code.Code('this->pendingUpdates = pendingUpdates;')
+            setPendingParam = [cxx_writer.writer_code.Parameter('pendingUpdates', pendingUpdatesType.makePointer())]
+            setPendingMethod = cxx_writer.writer_code.Method('setPendingUpdates', setPendingBody, cxx_writer.writer_code.voidType, 'pu', setPendingParam, noException = True)
+            registerElements.append(setPendingMethod)
+            markPendingBody = cxx_writer.writer_code.Code('if(!this->updatePending && this->pendingUpdates != NULL){\nthis->updatePending = true;\nthis->pendingUpdates->push_back(this);\n}')
+            markPendingMethod = cxx_writer.writer_code.Method('markPending', markPendingBody, cxx_writer.writer_code.voidType, 'pu', inline = True, noException = True)
+            registerElements.append(markPendingMethod)
+            isPendingBody = cxx_writer.writer_code.Code('return this->updatePending;')
+            isPendingMethod = cxx_writer.writer_code.Method('isUpdatePending', isPendingBody, cxx_writer.writer_code.boolType, 'pu', inline = True, noException = True, const = True)
+            registerElements.append(isPendingMethod)
     else:
         forceValueParam = [cxx_writer.writer_code.Parameter('value', regMaxType.makeRef().makeConst())]
         forceValueMethod = cxx_writer.writer_code.Method('forceValue', emptyBody, cxx_writer.writer_code.voidType, 'pu', forceValueParam, pure = True, noException = True)
@@ -845,6 +965,8 @@ def getCPPRegisters(self, trace, combinedTrace, model, namespace):
             curName += '_' + str(reg.constValue)
         if type(reg.delay) == type(0) and not model.startswith('acc') and reg.delay > 0:
             curName += '_' + str(reg.delay)
+        if reg.lazyFields:
+            curName += '_' + reg.name
         if not curName in regTypeNames:
             regTypes.append(reg)
             regTypeNames.append(curName)
@@ -855,6 +977,9 @@ def getCPPRegisters(self, trace, combinedTrace, model, namespace):
             regTypeName += '_const_' + str(reg.constValue)
         if type(reg.delay) == type(0) and not model.startswith('acc') and reg.delay > 0:
             regTypeName += '_delay_' + str(reg.delay)
+        if reg.lazyFields:
+            # The lazy operations are specific of the register
+            regTypeName += '_lazy_' + reg.name
         resourceType[reg.name] = cxx_writer.writer_code.Type(regTypeName, 'registers.hpp')
         if reg in self.regBanks:
             if (reg.constValue and len(reg.constValue) < reg.numRegs)  or ((reg.delay and len(reg.delay) < reg.numRegs) and not model.startswith('acc')):
@@ -970,6 +1095,24 @@ def getCPPAlias(self, namespace):
     for i in self.aliasRegs + self.aliasRegBanks:
         resourceType[i.name] = aliasType
 
+    # When there are windows on the register banks the aliases of a window
+    # find their register in a table indexed by the window base, shared by
+    # the whole window; the register is cached in reg, which is refreshed
+    # when the window moves, so that the accesses are as direct as for the
+    # aliases which are not part of a window (whose table is NULL)
+    windowed = False
+    for aliasB in self.aliasRegBanks:
+        if aliasB.windows:
+            windowed = True
+    if windowed:
+        ownWindowCode = 'this->window = NULL;\nthis->windowBase = NULL;\nthis->windowAliases = NULL;\nthis->windowLen = 0;\n'
+        copyWindowCode = 'this->window = newAlias.window;\nthis->windowBase = newAlias.windowBase;\nthis->windowAliases = newAlias.windowAliases;\nthis->windowLen = newAlias.windowLen;\n'
+        propagateWindowCode = '(*referredIter)->setWindow(this->window, this->windowBase, this->windowAliases, this->windowLen);\n'
+    else:
+        ownWindowCode = ''
+        copyWindowCode = ''
+        propagateWindowCode = ''
+
     ####################### Lets declare the operators used to access the register fields ##############
     codeOperatorBody = 'return (*this->reg)[bitField];'
     InnerFieldType = cxx_writer.writer_code.Type('InnerField')
@@ -1052,7 +1195,8 @@ def getCPPAlias(self, namespace):
     aliasElements.append(operatorIntDecl)
 
     ######### Constructor: takes as input the initial register #########
-    constructorBody = cxx_writer.writer_code.Code('this->referringAliases = NULL;')
+    constructorCode = 'this->referringAliases = NULL;\n' + ownWindowCode
+    constructorBody = cxx_writer.writer_code.Code(constructorCode)
     constructorParams = [cxx_writer.writer_code.Parameter('reg', registerType.makePointer())]
     constructorInit = ['reg(reg)']
     constructorParams.append(cxx_writer.writer_code.Parameter('offset', cxx_writer.writer_code.uintType, initValue = '0'))
@@ -1061,7 +1205,11 @@ def getCPPAlias(self, namespace):
     constructorInit = ['offset(0)', 'defaultOffset(0)']
     publicMainEmptyClassConstr = cxx_writer.writer_code.Constructor(constructorBody, 'pu', [], constructorInit)
     # Constructor: takes as input the initial alias
-    constructorBody = cxx_writer.writer_code.Code('initAlias->referredAliases.push_back(this);\nthis->referringAliases = initAlias;')
+    constructorBody = 'initAlias->referredAliases.push_back(this);\nthis->referringAliases = initAlias;\n'
+    if windowed:
+        constructorBody += 'this->window = initAlias->window;\nthis->windowBase = initAlias->windowBase;\n'
+        constructorBody += 'this->windowAliases = initAlias->windowAliases;\nthis->windowLen = initAlias->windowLen;\n'
+    constructorBody = cxx_writer.writer_code.Code(constructorBody)
     constructorParams = [cxx_writer.writer_code.Parameter('initAlias', aliasType.makePointer())]
     publicAliasConstrInit = ['reg(initAlias->reg)']
     constructorParams.append(cxx_writer.writer_code.Parameter('offset', cxx_writer.writer_code.uintType, initValue = '0'))
@@ -1088,12 +1236,13 @@ def getCPPAlias(self, namespace):
     aliasElements.append(operatorDecl)
 
     # Update method: updates the register pointed by this alias: Standard Alias
-    updateCode = """this->reg = newAlias.reg;
-    this->offset = newAlias.offset + newOffset;
+    updateCode = 'this->reg = newAlias.reg;\n'
+    updateCode += """this->offset = newAlias.offset + newOffset;
     this->defaultOffset = newOffset;
-    std::list<Alias *>::iterator referredIter, referredEnd;
+    """ + copyWindowCode + """std::list<Alias *>::iterator referredIter, referredEnd;
     for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
         (*referredIter)->newReferredAlias(newAlias.reg, newAlias.offset + newOffset);
+        """ + propagateWindowCode + """
     }
     if(this->referringAliases != NULL){
         this->referringAliases->referredAliases.remove(this);
@@ -1109,11 +1258,11 @@ def getCPPAlias(self, namespace):
     updateCode = """this->offset = newAlias.offset;
     this->defaultOffset = 0;
     """
-    updateCode += """this->reg = newAlias.reg;
-    std::list<Alias *>::iterator referredIter, referredEnd;
+    updateCode += 'this->reg = newAlias.reg;\n' + copyWindowCode
+    updateCode += """std::list<Alias *>::iterator referredIter, referredEnd;
     for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
     """
-    updateCode += '(*referredIter)->newReferredAlias(newAlias.reg, newAlias.offset);'
+    updateCode += '(*referredIter)->newReferredAlias(newAlias.reg, newAlias.offset);\n' + propagateWindowCode
     updateCode += """
     }
     if(this->referringAliases != NULL){
@@ -1130,7 +1279,7 @@ def getCPPAlias(self, namespace):
     updateCode = """this->reg = &newAlias;
     this->offset = newOffset;
     this->defaultOffset = 0;
-    std::list<Alias *>::iterator referredIter, referredEnd;
+    """ + ownWindowCode + """std::list<Alias *>::iterator referredIter, referredEnd;
     for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
         (*referredIter)->newReferredAlias(&newAlias, newOffset);
     }
@@ -1148,8 +1297,8 @@ def getCPPAlias(self, namespace):
     updateCode = """this->offset = 0;
     this->defaultOffset = 0;
     """
-    updateCode += """this->reg = &newAlias;
-    std::list<Alias *>::iterator referredIter, referredEnd;
+    updateCode += 'this->reg = &newAlias;\n' + ownWindowCode
+    updateCode += """std::list<Alias *>::iterator referredIter, referredEnd;
     for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
         (*referredIter)->newReferredAlias(&newAlias);
     }
@@ -1165,6 +1314,7 @@ def getCPPAlias(self, namespace):
 
     directSetCode = 'this->reg = newAlias.reg;\n'
     directSetCode += 'this->offset = newAlias.offset;\n'
+    directSetCode += copyWindowCode
     directSetCode += """if(this->referringAliases != NULL){
         this->referringAliases->referredAliases.remove(this);
     }
@@ -1176,8 +1326,7 @@ def getCPPAlias(self, namespace):
     directSetDecl = cxx_writer.writer_code.Method('directSetAlias', directSetBody, cxx_writer.writer_code.voidType, 'pu', directSetParam, noException = True)
     aliasElements.append(directSetDecl)
 
-    directSetBody = cxx_writer.writer_code.Code("""this->reg = &newAlias;
-    if(this->referringAliases != NULL){
+    directSetBody = cxx_writer.writer_code.Code('this->reg = &newAlias;\n' + ownWindowCode + """if(this->referringAliases != NULL){
         this->referringAliases->referredAliases.remove(this);
     }
     this->referringAliases = NULL;""")
@@ -1187,7 +1336,7 @@ def getCPPAlias(self, namespace):
 
     updateCode = """this->reg = newAlias;
     this->offset = newOffset + this->defaultOffset;
-    std::list<Alias *>::iterator referredIter, referredEnd;
+    """ + ownWindowCode + """std::list<Alias *>::iterator referredIter, referredEnd;
     for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
         (*referredIter)->newReferredAlias(newAlias, newOffset);
     }
@@ -1199,8 +1348,8 @@ def getCPPAlias(self, namespace):
     aliasElements.append(updateDecl)
 
     updateCode = 'this->offset = this->defaultOffset;\n'
-    updateCode += """this->reg = newAlias;
-    std::list<Alias *>::iterator referredIter, referredEnd;
+    updateCode += 'this->reg = newAlias;\n' + ownWindowCode
+    updateCode += """std::list<Alias *>::iterator referredIter, referredEnd;
     for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
         (*referredIter)->newReferredAlias(newAlias);
     }"""
@@ -1210,8 +1359,66 @@ def getCPPAlias(self, namespace):
     aliasElements.append(updateDecl)
 
 
+    if windowed:
+        # Window management: the alias becomes part of a window (window points
+        # to the entry of the table of its first position, windowAliases to the
+        # aliases of the window), shared by the aliases referring to it
+        setWindowCode = """this->window = window;
+        this->windowBase = windowBase;
+        this->windowAliases = windowAliases;
+        this->windowLen = windowLen;
+        if(window != NULL){
+            this->reg = window[*windowBase];
+        }
+        std::list<Alias *>::iterator referredIter, referredEnd;
+        for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
+            (*referredIter)->setWindow(window, windowBase, windowAliases, windowLen);
+        }
+        """
+        setWindowBody = cxx_writer.writer_code.Code(setWindowCode)
+        setWindowParam = [cxx_writer.writer_code.Parameter('window', registerType.makePointer().makePointer())]
+        setWindowParam.append(cxx_writer.writer_code.Parameter('windowBase', cxx_writer.writer_code.uintType.makePointer()))
+        setWindowParam.append(cxx_writer.writer_code.Parameter('windowAliases', aliasType.makePointer()))
+        setWindowParam.append(cxx_writer.writer_code.Parameter('windowLen', cxx_writer.writer_code.uintType))
+        setWindowDecl = cxx_writer.writer_code.Method('setWindow', setWindowBody, cxx_writer.writer_code.voidType, 'pu', setWindowParam, noException = True)
+        aliasElements.append(setWindowDecl)
+        refreshWindowCode = """if(this->window != NULL){
+            this->reg = this->window[*this->windowBase];
+        }
+        std::list<Alias *>::iterator referredIter, referredEnd;
+        for(referredIter = this->referredAliases.begin(), referredEnd = this->referredAliases.end(); referredIter != referredEnd; referredIter++){
+            (*referredIter)->refreshWindow();
+        }
+        """
+        refreshWindowDecl = cxx_writer.writer_code.Method('refreshWindow', cxx_writer.writer_code.Code(refreshWindowCode), cxx_writer.writer_code.voidType, 'pri', noException = True)
+        aliasElements.append(refreshWindowDecl)
+        # An alias moved with updateAlias leaves its window and it is not refreshed
+        # any more: the window has to be moved through one of its aliases
+        updateWindowCode = """if(this->windowAliases == NULL){
+            THROW_ERROR("Error, updateWindow called on an alias detached from its window");
+        }
+        *this->windowBase = newBase;
+        for(unsigned int i = 0; i < this->windowLen; i++){
+            this->windowAliases[i].refreshWindow();
+        }
+        """
+        updateWindowBody = cxx_writer.writer_code.Code(updateWindowCode)
+        updateWindowBody.addInclude('trap_utils.hpp')
+        updateWindowParam = [cxx_writer.writer_code.Parameter('newBase', cxx_writer.writer_code.uintType)]
+        updateWindowDecl = cxx_writer.writer_code.Method('updateWindow', updateWindowBody, cxx_writer.writer_code.voidType, 'pu', updateWindowParam, noException = True)
+        aliasElements.append(updateWindowDecl)
+
     regAttribute = cxx_writer.writer_code.Attribute('reg', registerType.makePointer(), 'pri')
     aliasElements.append(regAttribute)
+    if windowed:
+        windowAttribute = cxx_writer.writer_code.Attribute('window', registerType.makePointer().makePointer(), 'pri')
+        aliasElements.append(windowAttribute)
+        windowAttribute = cxx_writer.writer_code.Attribute('windowBase', cxx_writer.writer_code.uintType.makePointer(), 'pri')
+        aliasElements.append(windowAttribute)
+        windowAttribute = cxx_writer.writer_code.Attribute('windowAliases', aliasType.makePointer(), 'pri')
+        aliasElements.append(windowAttribute)
+        windowAttribute = cxx_writer.writer_code.Attribute('windowLen', cxx_writer.writer_code.uintType, 'pri')
+        aliasElements.append(windowAttribute)
     offsetAttribute = cxx_writer.writer_code.Attribute('offset', cxx_writer.writer_code.uintType, 'pri')
     aliasElements.append(offsetAttribute)
     offsetAttribute = cxx_writer.writer_code.Attribute('defaultOffset', cxx_writer.writer_code.uintType, 'pri')
@@ -1279,10 +1486,6 @@ def getCPPPipelineAlias(self, namespace):
     unlockBody = cxx_writer.writer_code.Code('this->pipelineReg->unlock();')
     unlockMethod = cxx_writer.writer_code.Method('unlock', unlockBody, cxx_writer.writer_code.voidType, 'pu', inline = True, noException = True)
     aliasElements.append(unlockMethod)
-    latencyParam = cxx_writer.writer_code.Parameter('wbLatency', cxx_writer.writer_code.intType)
-    unlockBody = cxx_writer.writer_code.Code('this->pipelineReg->unlock(wbLatency);')
-    unlockMethod = cxx_writer.writer_code.Method('unlock', unlockBody, cxx_writer.writer_code.voidType, 'pu', [latencyParam], inline = True, noException = True)
-    aliasElements.append(unlockMethod)
     isLockedBody = cxx_writer.writer_code.Code('return this->pipelineReg->isLocked();')
     isLockedMethod = cxx_writer.writer_code.Method('isLocked', isLockedBody, cxx_writer.writer_code.boolType, 'pu', inline = True, noException = True)
     aliasElements.append(isLockedMethod)
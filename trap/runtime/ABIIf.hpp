@@ -44,11 +44,13 @@
 #define ABIIF_HPP
 
 #include <vector>
+#include <string>
 
 #include <boost/circular_buffer.hpp>
 
 #include "trap_utils.hpp"
 #include "instructionBase.hpp"
+#include "perfCounters.hpp"
 
 namespace trap{
 
@@ -108,12 +110,63 @@ template<class regWidth> class ABIIf{
     virtual unsigned char readCharMem( const regWidth & address) = 0;
     virtual void writeMem( const regWidth & address, regWidth datum) = 0;
     virtual void writeCharMem( const regWidth & address, unsigned char datum ) = 0;
+    ///Copies length bytes of guest memory, starting at address, into buffer; the
+    ///generated interfaces override it with a single copy from the backing memory
+    virtual void readMemBlock( const regWidth & address, unsigned char * buffer, unsigned int length){
+        for(unsigned int i = 0; i < length; i++){
+            buffer[i] = this->readCharMem(address + i);
+        }
+    }
+    ///Copies length bytes from buffer into guest memory, starting at address
+    virtual void writeMemBlock( const regWidth & address, const unsigned char * buffer, unsigned int length){
+        for(unsigned int i = 0; i < length; i++){
+            this->writeCharMem(address + i, buffer[i]);
+        }
+    }
+    ///Returns the last address of the memory holding address, so that block
+    ///reads are kept inside that memory; when the size of the memory is not
+    ///known address itself is returned, and the memory is read byte by byte
+    virtual regWidth getMemoryLimit( const regWidth & address){
+        return address;
+    }
+    ///Reads the NUL terminated string located at address; memory is read in
+    ///64 byte aligned chunks, so no access goes past the block holding the
+    ///terminator, and chunks are clipped at the end of the memory
+    virtual std::string readCString( const regWidth & address){
+        std::string str;
+        unsigned char chunk[64];
+        regWidth curAddress = address;
+        while(true){
+            unsigned int chunkLen = sizeof(chunk) - (unsigned int)(curAddress % sizeof(chunk));
+            regWidth memLimit = this->getMemoryLimit(curAddress);
+            if(memLimit < curAddress){
+                chunkLen = 1;
+            }
+            else if(memLimit - curAddress < chunkLen - 1){
+                chunkLen = (unsigned int)(memLimit - curAddress) + 1;
+            }
+            this->readMemBlock(curAddress, chunk, chunkLen);
+            for(unsigned int i = 0; i < chunkLen; i++){
+                if(chunk[i] == '\x0'){
+                    str.append((const char *)chunk, i);
+                    return str;
+                }
+            }
+            str.append((const char *)chunk, chunkLen);
+            curAddress += chunkLen;
+        }
+    }
     virtual regWidth getCodeLimit() = 0;
     virtual bool isRoutineEntry(const InstructionBase * instr) throw() = 0;
     virtual bool isRoutineExit(const InstructionBase * instr) throw() = 0;
     virtual unsigned char * getState() const throw() = 0;
     virtual void setState(unsigned char * state) throw() = 0;
     virtual boost::circular_buffer<HistoryInstrType> & getInstructionHistory() = 0;
+    ///Returns, as a JSON document, the performance counters collected up to now;
+    ///they are meaningful only for simulators compiled with ENABLE_PERF_COUNTERS
+    virtual std::string getPerfCounters() const{
+        return PerfCounters::dumpAll();
+    }
     virtual ~ABIIf(){}
 };
 
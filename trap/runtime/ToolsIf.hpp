@@ -45,6 +45,7 @@
 
 #include <cstdlib>
 #include "instructionBase.hpp"
+#include "pendingEvents.hpp"
 
 namespace trap{
 
@@ -74,6 +75,13 @@ template<class issueWidth> class ToolsIf{
     ///Returns true if the pipeline has to be empty before being able to
     ///call the current tool, false otherwise
     virtual bool emptyPipeline(const issueWidth &curPC) const throw() = 0;
+    ///Returns true if the tool has to be activated by the issue of any of the
+    ///instructions in the range [start, end); the code which is not watched by
+    ///any tool can be executed without calling the tools (e.g. by the statically
+    ///translated code). By default all the instructions are watched
+    virtual bool watchesRange(const issueWidth &start, const issueWidth &end) const throw(){
+        return true;
+    }
     virtual ~ToolsIf(){}
 };
 
@@ -82,10 +90,22 @@ template<class issueWidth> class ToolsManager{
     ///List of the active tools, which are activated at every instruction
     ToolsIf<issueWidth> ** activeTools;
     int activeToolsNum;
+    ///Word of pending events of the processor: the PENDING_TOOLS bit is set
+    ///as soon as there is at least one active tool
+    unsigned int * pendingEvents;
     public:
     ToolsManager(){
         activeTools = NULL;
         activeToolsNum = 0;
+        pendingEvents = NULL;
+    }
+    ///Sets the word of pending events of the processor, which is notified
+    ///that the tools need to be called at every instruction issue
+    void setPendingEvents(unsigned int * pendingEvents){
+        this->pendingEvents = pendingEvents;
+        if(this->pendingEvents != NULL && this->activeToolsNum > 0){
+            *(this->pendingEvents) |= PENDING_TOOLS;
+        }
     }
     ///Adds a tool to the list of the tool which are activated when there is a new instruction
     ///issue
@@ -100,6 +120,9 @@ template<class issueWidth> class ToolsManager{
         }
         this->activeTools = activeToolsTemp;
         this->activeTools[this->activeToolsNum - 1] = &tool;
+        if(this->pendingEvents != NULL){
+            *(this->pendingEvents) |= PENDING_TOOLS;
+        }
     }
     ///The only method which is called to activate the tool
     ///it signals to the tool that a new instruction issue has been started;
@@ -122,6 +145,21 @@ template<class issueWidth> class ToolsManager{
         }
         return needToEmpty;
     }
+    ///Returns true if any of the tools has to be activated by the issue of
+    ///the instructions in the range [start, end)
+    bool watchesRange(const issueWidth &start, const issueWidth &end) const throw(){
+        for(int i = 0; i < this->activeToolsNum; i++){
+            if(this->activeTools[i]->watchesRange(start, end)){
+                return true;
+            }
+        }
+        return false;
+    }
+    ///Returns the number of active tools; since tools are never removed, it
+    ///changes whenever a new tool is added
+    inline int getNumTools() const throw(){
+        return this->activeToolsNum;
+    }
 };
 
 };
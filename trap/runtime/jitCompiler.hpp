@@ -0,0 +1,356 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef JITCOMPILER_HPP
+#define JITCOMPILER_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/bind.hpp>
+
+#include "trap_utils.hpp"
+#include "codeTranslator.hpp"
+#include "translatedCode.hpp"
+
+namespace trap{
+
+///Translates at run time the regions of code which are executed most often.
+///The instructions interpreted in each region are counted: when a region
+///becomes hot its code is emitted by the processor (see CodeTranslator) and
+///compiled by a background thread with the host compiler into a shared
+///library, while the interpretation goes on. Once the library is loaded the
+///region is registered in the translated code by the simulation thread, which
+///looks for the compiled regions every POLL_INTERVAL interpreted instructions
+template<class ProcessorType, class issueWidth> class JitCompiler{
+  public:
+    ///Function, defined by each compiled library, registering its region
+    typedef unsigned int (*RegisterFunction)(ProcessorType & processor);
+
+  private:
+    ///Counter of the instructions interpreted in a region; regions are
+    ///mapped on a small direct mapped table, so that profiling is cheap
+    struct HotEntry{
+        issueWidth region;
+        unsigned int count;
+    };
+    static const unsigned int HOT_TABLE_SIZE = 4096;
+    HotEntry hotTable[HOT_TABLE_SIZE];
+    ///Number of interpreted instructions between two looks at the regions
+    ///compiled by the compilation thread
+    static const unsigned int POLL_INTERVAL = 1024;
+    unsigned int pollCountdown;
+    struct CompileJob{
+        issueWidth region;
+        unsigned int id;
+        std::string code;
+    };
+    struct CompiledRegion{
+        issueWidth region;
+        unsigned int id;
+        RegisterFunction function;
+    };
+
+    ProcessorType * processor;
+    TranslatedCode<issueWidth> * translatedCode;
+    issueWidth regionSize;
+    unsigned int threshold;
+    ///Only used by the simulation thread
+    bool enabled;
+    unsigned int numCompiled;
+    std::string compilerCommand;
+    std::string includeDir;
+    std::string workDir;
+    ///Regions already sent to the compiler
+    std::set<issueWidth> requested;
+    ///Regions sent to the compiler and not registered yet, with the id of
+    ///their last job; the ones invalidated in the meantime are removed, so
+    ///that their stale code is never registered, even if the region is sent
+    ///again to the compiler before the old job completes
+    std::map<issueWidth, unsigned int> pending;
+    unsigned int numJobs;
+
+    ///State shared with the compilation thread, always accessed holding jobsMutex
+    boost::mutex jobsMutex;
+    boost::condition jobsCondition;
+    std::deque<CompileJob> jobs;
+    std::vector<CompiledRegion> compiled;
+    bool compilerFailed;
+    bool stopThread;
+    boost::thread * compilerThread;
+
+    ///Body of the compilation thread: each job is compiled and loaded in turn
+    void compileJobs(){
+        while(true){
+            CompileJob job;
+            {
+                boost::mutex::scoped_lock lock(this->jobsMutex);
+                while(this->jobs.empty() && !this->stopThread){
+                    this->jobsCondition.wait(lock);
+                }
+                if(this->stopThread){
+                    return;
+                }
+                job = this->jobs.front();
+                this->jobs.pop_front();
+            }
+            RegisterFunction function = this->compileRegion(job);
+            boost::mutex::scoped_lock lock(this->jobsMutex);
+            if(function == NULL){
+                // Most likely the compiler is not usable: the following regions would fail as well
+                this->compilerFailed = true;
+                this->jobs.clear();
+                return;
+            }
+            CompiledRegion compiledRegion;
+            compiledRegion.region = job.region;
+            compiledRegion.id = job.id;
+            compiledRegion.function = function;
+            this->compiled.push_back(compiledRegion);
+        }
+    }
+    ///Compiles the code of a region and loads it, returning the function
+    ///which registers it or NULL in case of errors
+    RegisterFunction compileRegion(const CompileJob & job){
+        #ifdef _WIN32
+        return NULL;
+        #else
+        std::ostringstream baseName;
+        baseName << this->workDir << "/region_" << std::hex << job.region;
+        std::string sourceName = baseName.str() + ".cpp";
+        std::string libName = baseName.str() + ".so";
+        std::ofstream sourceFile(sourceName.c_str());
+        sourceFile << job.code;
+        sourceFile.close();
+        std::string command = this->compilerCommand + " -I\"" + this->includeDir + "\" -o \"" + libName + "\" \"" + sourceName + "\"";
+        if(!sourceFile.good() || std::system(command.c_str()) != 0){
+            std::cerr << "Unable to compile at run time the code of region " << std::hex << std::showbase << job.region << std::dec << ": disabling the JIT" << std::endl;
+            std::remove(sourceName.c_str());
+            return NULL;
+        }
+        // The library is never closed, since its instructions are used until the end of the simulation
+        void * library = dlopen(libName.c_str(), RTLD_NOW | RTLD_LOCAL);
+        std::remove(sourceName.c_str());
+        std::remove(libName.c_str());
+        if(library == NULL){
+            std::cerr << "Unable to load the code of region " << std::hex << std::showbase << job.region << std::dec << ": " << dlerror() << std::endl;
+            return NULL;
+        }
+        union{
+            void * symbol;
+            RegisterFunction function;
+        } entry;
+        entry.symbol = dlsym(library, "trapRegisterJitRegion");
+        return entry.function;
+        #endif
+    }
+    ///Registers the regions compiled in the meantime; called by the simulation thread
+    void registerCompiled(){
+        boost::mutex::scoped_lock lock(this->jobsMutex);
+        if(this->compilerFailed){
+            this->enabled = false;
+        }
+        typename std::vector<CompiledRegion>::iterator compiledIter, compiledEnd;
+        for(compiledIter = this->compiled.begin(), compiledEnd = this->compiled.end(); compiledIter != compiledEnd; compiledIter++){
+            typename std::map<issueWidth, unsigned int>::iterator foundPending = this->pending.find(compiledIter->region);
+            if(foundPending == this->pending.end() || foundPending->second != compiledIter->id){
+                continue;
+            }
+            this->pending.erase(foundPending);
+            issueWidth curSize = this->translatedCode->getRegionSize();
+            if(curSize == 0 || curSize == this->regionSize){
+                this->numCompiled += compiledIter->function(*this->processor);
+            }
+        }
+        this->compiled.clear();
+    }
+
+  public:
+    JitCompiler() : pollCountdown(POLL_INTERVAL), processor(NULL), translatedCode(NULL), regionSize(1024), threshold(5000),
+                    enabled(false), numCompiled(0), numJobs(0), compilerFailed(false), stopThread(false), compilerThread(NULL){
+        for(unsigned int i = 0; i < HOT_TABLE_SIZE; i++){
+            this->hotTable[i].region = 1;
+            this->hotTable[i].count = 0;
+        }
+    }
+    ~JitCompiler(){
+        if(this->compilerThread != NULL){
+            {
+                boost::mutex::scoped_lock lock(this->jobsMutex);
+                this->stopThread = true;
+            }
+            this->jobsCondition.notify_all();
+            this->compilerThread->join();
+            delete this->compilerThread;
+        }
+        #ifndef _WIN32
+        if(!this->workDir.empty()){
+            rmdir(this->workDir.c_str());
+        }
+        #endif
+    }
+    void setProcessor(ProcessorType & processor, TranslatedCode<issueWidth> & translatedCode){
+        this->processor = &processor;
+        this->translatedCode = &translatedCode;
+    }
+    ///Enables the JIT: command is the compiler, with its flags, producing a shared
+    ///library; includeDir is the folder containing the sources of the processor
+    void setCompiler(const std::string & command, const std::string & includeDir){
+        this->compilerCommand = command;
+        this->includeDir = includeDir;
+        this->enabled = true;
+    }
+    void setThreshold(unsigned int threshold){
+        this->threshold = threshold;
+    }
+    ///The size of the regions has to be the same of the code translated ahead of time, if any
+    void setRegionSize(const issueWidth & regionSize){
+        if(regionSize == 0 || (regionSize & (regionSize - 1)) != 0){
+            THROW_EXCEPTION("Error, the size of the JIT regions has to be a power of two");
+        }
+        this->regionSize = regionSize;
+    }
+    issueWidth getRegionSize() const{
+        return this->regionSize;
+    }
+    ///Returns the number of regions compiled and registered so far
+    unsigned int getNumCompiled() const{
+        return this->numCompiled;
+    }
+
+    ///Called for each interpreted instruction: returns true when the region
+    ///of curPC becomes hot, meaning that its code has to be compiled
+    inline bool profile(const issueWidth & curPC){
+        if(!this->enabled){
+            return false;
+        }
+        if(--this->pollCountdown == 0){
+            this->pollCountdown = POLL_INTERVAL;
+            if(this->compilerThread != NULL){
+                this->registerCompiled();
+            }
+        }
+        issueWidth region = curPC & ~(this->regionSize - 1);
+        HotEntry & entry = this->hotTable[(region/this->regionSize) & (HOT_TABLE_SIZE - 1)];
+        if(entry.region != region){
+            entry.region = region;
+            entry.count = 0;
+        }
+        entry.count++;
+        if(entry.count != this->threshold){
+            return false;
+        }
+        return this->requested.insert(region).second;
+    }
+    ///Sends the code of a hot region to the compilation thread
+    void compile(const issueWidth & region, const CodeTranslator & translator){
+        #ifdef _WIN32
+        this->enabled = false;
+        #else
+        if(this->workDir.empty()){
+            const char * tmpDir = std::getenv("TMPDIR");
+            std::string dirTemplate = std::string(tmpDir != NULL ? tmpDir : "/tmp") + "/trapjitXXXXXX";
+            std::vector<char> dirName(dirTemplate.begin(), dirTemplate.end());
+            dirName.push_back('\0');
+            if(mkdtemp(&dirName[0]) == NULL){
+                std::cerr << "Unable to create the JIT folder " << dirTemplate << ": disabling the JIT" << std::endl;
+                this->enabled = false;
+                return;
+            }
+            this->workDir = &dirName[0];
+        }
+        CompileJob job;
+        job.region = region;
+        job.id = this->numJobs++;
+        std::ostringstream code;
+        translator.write(code, "Region compiled at run time", "trapRegisterJitRegion");
+        job.code = code.str();
+        this->pending[region] = job.id;
+        {
+            boost::mutex::scoped_lock lock(this->jobsMutex);
+            this->jobs.push_back(job);
+        }
+        this->jobsCondition.notify_one();
+        if(this->compilerThread == NULL){
+            this->compilerThread = new boost::thread(boost::bind(&JitCompiler::compileJobs, this));
+        }
+        #endif
+    }
+    ///Called when the code of [start, end) is modified: the overlapping regions
+    ///being compiled are dropped and all the overlapping regions are profiled
+    ///from scratch, so that they are compiled again once they become hot
+    void invalidate(const issueWidth & start, const issueWidth & end){
+        issueWidth firstRegion = start & ~(this->regionSize - 1);
+        typename std::map<issueWidth, unsigned int>::iterator pendingIter = this->pending.lower_bound(firstRegion);
+        while(pendingIter != this->pending.end() && pendingIter->first < end){
+            this->pending.erase(pendingIter++);
+        }
+        typename std::set<issueWidth>::iterator requestedIter = this->requested.lower_bound(firstRegion);
+        while(requestedIter != this->requested.end() && *requestedIter < end){
+            HotEntry & entry = this->hotTable[(*requestedIter/this->regionSize) & (HOT_TABLE_SIZE - 1)];
+            if(entry.region == *requestedIter){
+                entry.count = 0;
+            }
+            this->requested.erase(requestedIter++);
+        }
+    }
+};
+
+};
+
+#endif
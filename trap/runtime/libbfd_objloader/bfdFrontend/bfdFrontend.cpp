@@ -158,6 +158,9 @@ trap::ELFFrontend::ELFFrontend(std::string binaryName){
                 gblEndAddr = datasize + vma;
             if(gblStartAddr > vma || gblStartAddr == (bfd_vma)-1)
                 gblStartAddr = vma;
+            if((flags & SEC_CODE) != 0 && (flags & SEC_HAS_CONTENTS) != 0){
+                this->codeSegments.push_back(std::pair<unsigned int, unsigned int>(vma, vma + datasize));
+            }
              if((flags & SEC_HAS_CONTENTS) != 0){
                 Section sec;
                 sec.datasize = datasize;
@@ -411,6 +414,12 @@ unsigned int trap::ELFFrontend::getBinaryStart() const{
     return this->codeSize.second;
 }
 
+///Returns the start and end addresses of the parts of the binary file
+///containing executable code
+const std::vector<std::pair<unsigned int, unsigned int> > & trap::ELFFrontend::getCodeSegments() const{
+    return this->codeSegments;
+}
+
 std::string trap::ELFFrontend::getMatchingFormats (char **p) const{
     std::string match = "";
     if(p != NULL){
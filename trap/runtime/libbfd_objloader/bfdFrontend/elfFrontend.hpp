@@ -106,6 +106,8 @@ class ELFFrontend{
 
     //end address and start address (not necessarily the entry point) of the loadable part of the binary file
     std::pair<unsigned int, unsigned int> codeSize;
+    //start and end address of the executable parts of the binary
+    std::vector<std::pair<unsigned int, unsigned int> > codeSegments;
 
     ///Contains a list of the sections which contain executable code
     std::vector<Section> secList;
@@ -151,6 +153,9 @@ class ELFFrontend{
     unsigned int getBinaryEnd() const;
     ///Returns the start address of the loadable code
     unsigned int getBinaryStart() const;
+    ///Returns the start and end addresses of the parts of the binary file
+    ///containing executable code
+    const std::vector<std::pair<unsigned int, unsigned int> > & getCodeSegments() const;
     ///Given an address, it sets fileName to the name of the source file
     ///which contains the code and line to the line in that file. Returns
     ///false if the address is not valid
@@ -192,6 +192,9 @@ void trap::ELFFrontend::readProgramData(){
         if(elfProgHeader.p_type == PT_LOAD){
             //Found a standard loadable segment: I can put its content into the executable
             //image
+            if((elfProgHeader.p_flags & PF_X) != 0 && elfProgHeader.p_filesz > 0){
+                this->codeSegments.push_back(std::pair<unsigned int, unsigned int>(elfProgHeader.p_vaddr, elfProgHeader.p_vaddr + elfProgHeader.p_filesz));
+            }
             std::map<unsigned int, unsigned char>::iterator curMapPos = memMap.end();
             if(elfProgHeader.p_filesz > 0){
                 unsigned char * fileContent = new unsigned char[elfProgHeader.p_filesz];
@@ -388,6 +391,12 @@ unsigned int trap::ELFFrontend::getBinaryStart() const{
     return this->codeSize.second;
 }
 
+///Returns the start and end addresses of the parts of the binary file
+///containing executable code
+const std::vector<std::pair<unsigned int, unsigned int> > & trap::ELFFrontend::getCodeSegments() const{
+    return this->codeSegments;
+}
+
 ///Returns the entry point of the executable code
 unsigned int trap::ELFFrontend::getEntryPoint() const{
     return this->entryPoint;
@@ -99,6 +99,8 @@ class ELFFrontend{
 
     //end address and start address (not necessarily the entry point) of the loadable part of the binary file
     std::pair<unsigned int, unsigned int> codeSize;
+    //start and end address of the executable parts of the binary
+    std::vector<std::pair<unsigned int, unsigned int> > codeSegments;
 
     static std::map<std::string, ELFFrontend *> curInstance;
     //Private constructor: we want pepole to be only able to use getInstance
@@ -138,6 +140,9 @@ class ELFFrontend{
     unsigned int getBinaryEnd() const;
     ///Returns the start address of the loadable code
     unsigned int getBinaryStart() const;
+    ///Returns the start and end addresses of the parts of the binary file
+    ///containing executable code
+    const std::vector<std::pair<unsigned int, unsigned int> > & getCodeSegments() const;
     ///Returns the entry point of the executable code
     unsigned int getEntryPoint() const;
     ///Given an address, it sets fileName to the name of the source file
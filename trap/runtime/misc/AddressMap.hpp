@@ -0,0 +1,168 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef ADDRESSMAP_HPP
+#define ADDRESSMAP_HPP
+
+#include <systemc.h>
+#include <tlm.h>
+#include <vector>
+#include <algorithm>
+
+#include <trap_utils.hpp>
+
+namespace trap{
+
+///Single entry of the address map: all the addresses in the
+///[start, end] interval are routed to the target with the
+///specified id; the address seen by the target is rebased on start
+struct AddressRange{
+    sc_dt::uint64 start;
+    sc_dt::uint64 end;
+    unsigned int target;
+
+    AddressRange(sc_dt::uint64 start, sc_dt::uint64 end, unsigned int target) : start(start), end(end), target(target){}
+    bool operator<(const AddressRange & other) const{
+        return this->start < other.start;
+    }
+};
+
+///Address map used by the routers: the ranges are kept sorted on the
+///start address, so that decoding is a binary search; the last decoded
+///range is also cached, since consecutive accesses usually target the
+///same device and, in that case, translation is reduced to a comparison and
+///a subtraction
+class AddressMap{
+    private:
+    std::vector<AddressRange> ranges;
+    const AddressRange * lastHit;
+
+    public:
+    AddressMap() : lastHit(NULL){}
+
+    ///Maps the [start, end] range (extremes included) on target
+    void addRange(unsigned int target, sc_dt::uint64 start, sc_dt::uint64 end){
+        if(start > end){
+            THROW_EXCEPTION("Invalid range " << std::hex << std::showbase << start << " - " << end << " for target " << std::dec << target);
+        }
+        std::vector<AddressRange>::iterator rangesIter, rangesEnd;
+        for(rangesIter = this->ranges.begin(), rangesEnd = this->ranges.end(); rangesIter != rangesEnd; rangesIter++){
+            if(start <= rangesIter->end && end >= rangesIter->start){
+                THROW_EXCEPTION("Range " << std::hex << std::showbase << start << " - " << end << " for target " << std::dec << target << " overlaps with range " << std::hex << rangesIter->start << " - " << rangesIter->end << " of target " << std::dec << rangesIter->target);
+            }
+        }
+        this->ranges.push_back(AddressRange(start, end, target));
+        std::sort(this->ranges.begin(), this->ranges.end());
+        // The vector might have been reallocated
+        this->lastHit = NULL;
+    }
+
+    ///Returns the range containing address, NULL if the address
+    ///is not mapped on any target
+    inline const AddressRange * decode(const sc_dt::uint64 & address) throw(){
+        if(this->lastHit != NULL && address >= this->lastHit->start && address <= this->lastHit->end){
+            return this->lastHit;
+        }
+        std::vector<AddressRange>::const_iterator foundRange = std::upper_bound(this->ranges.begin(), this->ranges.end(), AddressRange(address, address, 0));
+        if(foundRange == this->ranges.begin()){
+            return NULL;
+        }
+        foundRange--;
+        if(address > foundRange->end){
+            return NULL;
+        }
+        this->lastHit = &(*foundRange);
+        return this->lastHit;
+    }
+
+    ///Returns all the ranges mapped on the specified target
+    std::vector<AddressRange> getTargetRanges(unsigned int target) const{
+        std::vector<AddressRange> targetRanges;
+        std::vector<AddressRange>::const_iterator rangesIter, rangesEnd;
+        for(rangesIter = this->ranges.begin(), rangesEnd = this->ranges.end(); rangesIter != rangesEnd; rangesIter++){
+            if(rangesIter->target == target){
+                targetRanges.push_back(*rangesIter);
+            }
+        }
+        return targetRanges;
+    }
+
+    ///Translates a DMI region granted by a target, expressed in the
+    ///target address space, into the address space of the initiators, clipping
+    ///it to the mapped range; the DMI pointer refers to the start of the region,
+    ///so it is still valid as only the end of the region is clipped. Returns
+    ///false in case the region does not intersect the mapped range
+    bool rebaseDMI(const AddressRange & range, tlm::tlm_dmi & dmi_data) const{
+        sc_dt::uint64 rangeSize = range.end - range.start;
+        sc_dt::uint64 dmiStart = dmi_data.get_start_address();
+        sc_dt::uint64 dmiEnd = dmi_data.get_end_address();
+        if(dmiStart > rangeSize){
+            return false;
+        }
+        if(dmiEnd > rangeSize){
+            dmiEnd = rangeSize;
+        }
+        dmi_data.set_start_address(range.start + dmiStart);
+        dmi_data.set_end_address(range.start + dmiEnd);
+        return true;
+    }
+
+    ///Translates an invalidation range coming from a target into the
+    ///address space of the initiators; returns false in case the
+    ///invalidated region does not intersect the mapped range
+    bool rebaseInvalidate(const AddressRange & range, sc_dt::uint64 & start, sc_dt::uint64 & end) const{
+        sc_dt::uint64 rangeSize = range.end - range.start;
+        if(start > rangeSize){
+            return false;
+        }
+        if(end > rangeSize){
+            end = rangeSize;
+        }
+        start += range.start;
+        end += range.start;
+        return true;
+    }
+};
+
+};
+
+#endif
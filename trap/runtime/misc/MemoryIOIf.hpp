@@ -0,0 +1,68 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef MEMORYIOIF_HPP
+#define MEMORYIOIF_HPP
+
+namespace trap{
+
+///Base class for the memory mapped devices which can be attached
+///to an address range of the local memory of the processors: all the
+///accesses to the range are forwarded to the device. size is the
+///size in bytes of the access, the data is in the host endianess
+template<class addressType> class MemoryIOIf{
+    public:
+    virtual unsigned long long read(const addressType &address, unsigned int size) = 0;
+    virtual void write(const addressType &address, unsigned int size, unsigned long long datum) = 0;
+    virtual ~MemoryIOIf(){}
+};
+
+///Address range [start, end] mapped to a memory mapped device
+template<class addressType> struct MemoryIORange{
+    addressType start;
+    addressType end;
+    MemoryIOIf<addressType> * device;
+};
+
+};
+
+#endif
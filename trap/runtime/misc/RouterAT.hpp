@@ -0,0 +1,247 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef ROUTERAT_HPP
+#define ROUTERAT_HPP
+
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <boost/lexical_cast.hpp>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <trap_utils.hpp>
+
+#include "AddressMap.hpp"
+
+namespace trap{
+
+///Approximate timed address-decoding router: the address map is the same
+///used by RouterLT; in addition the router keeps track of the transactions in
+///flight, so that the phases coming back from the targets are sent
+///to the initiator which started the transaction
+template<unsigned int N_INITIATORS, unsigned int N_TARGETS, unsigned int sockSize> class RouterAT: public sc_module{
+    public:
+    tlm_utils::simple_target_socket_tagged<RouterAT, sockSize> * socket[N_INITIATORS];
+    tlm_utils::simple_initiator_socket_tagged<RouterAT, sockSize> * initSocket[N_TARGETS];
+
+    RouterAT(sc_module_name name, sc_time latency = SC_ZERO_TIME) : sc_module(name), latency(latency){
+        for(int i = 0; i < N_INITIATORS; i++){
+            this->socket[i] = new tlm_utils::simple_target_socket_tagged<RouterAT, sockSize>(("router_socket_" + boost::lexical_cast<std::string>(i)).c_str());
+            this->socket[i]->register_nb_transport_fw(this, &RouterAT::nb_transport_fw, i);
+            this->socket[i]->register_get_direct_mem_ptr(this, &RouterAT::get_direct_mem_ptr, i);
+            this->socket[i]->register_transport_dbg(this, &RouterAT::transport_dbg, i);
+        }
+        for(int i = 0; i < N_TARGETS; i++){
+            this->initSocket[i] = new tlm_utils::simple_initiator_socket_tagged<RouterAT, sockSize>(("router_init_socket_" + boost::lexical_cast<std::string>(i)).c_str());
+            this->initSocket[i]->register_nb_transport_bw(this, &RouterAT::nb_transport_bw, i);
+            this->initSocket[i]->register_invalidate_direct_mem_ptr(this, &RouterAT::invalidate_direct_mem_ptr, i);
+        }
+        end_module();
+    }
+
+    ~RouterAT(){
+        for(int i = 0; i < N_INITIATORS; i++){
+            delete this->socket[i];
+        }
+        for(int i = 0; i < N_TARGETS; i++){
+            delete this->initSocket[i];
+        }
+    }
+
+    ///Maps size bytes starting from address start on the target
+    ///bound to initSocket[target]
+    void addTarget(unsigned int target, sc_dt::uint64 start, sc_dt::uint64 size){
+        if(target >= N_TARGETS){
+            THROW_EXCEPTION("Target " << target << " does not exist: router " << this->name() << " has only " << N_TARGETS << " targets");
+        }
+        if(size == 0){
+            THROW_EXCEPTION("Empty range specified for target " << target << " of router " << this->name());
+        }
+        this->addressMap.addRange(target, start, start + size - 1);
+    }
+
+    // TLM-2 non-blocking transport method, forward path
+    tlm::tlm_sync_enum nb_transport_fw(int tag, tlm::tlm_generic_payload& trans,
+                                                tlm::tlm_phase& phase, sc_time& delay){
+        unsigned int target = 0;
+        if(phase == tlm::BEGIN_REQ){
+            sc_dt::uint64 adr = trans.get_address();
+            const AddressRange * range = this->addressMap.decode(adr);
+            if(range == NULL){
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                std::cerr << "Error, address " << std::showbase << std::hex << adr << std::dec << " not mapped in router " << this->name() << std::endl;
+                return tlm::TLM_COMPLETED;
+            }
+            target = range->target;
+            this->routes[&trans] = RouteInfo(tag, target, adr);
+            trans.set_address(adr - range->start);
+            delay += this->latency;
+        }
+        else{
+            typename std::map<tlm::tlm_generic_payload *, RouteInfo>::iterator foundRoute = this->routes.find(&trans);
+            if(foundRoute == this->routes.end()){
+                SC_REPORT_FATAL("TLM-2", "Router received a phase for a transaction which is not in progress");
+            }
+            target = foundRoute->second.target;
+        }
+
+        bool endResponse = (phase == tlm::END_RESP);
+        tlm::tlm_sync_enum status = (*(this->initSocket[target]))->nb_transport_fw(trans, phase, delay);
+        if(status == tlm::TLM_COMPLETED || endResponse){
+            this->completeRoute(trans);
+        }
+        return status;
+    }
+
+    // TLM-2 non-blocking transport method, backward path: the phase is
+    // sent to the initiator which started the transaction
+    tlm::tlm_sync_enum nb_transport_bw(int tag, tlm::tlm_generic_payload& trans,
+                                                tlm::tlm_phase& phase, sc_time& delay){
+        typename std::map<tlm::tlm_generic_payload *, RouteInfo>::iterator foundRoute = this->routes.find(&trans);
+        if(foundRoute == this->routes.end()){
+            SC_REPORT_FATAL("TLM-2", "Router received a phase for a transaction which is not in progress");
+        }
+
+        tlm::tlm_sync_enum status = (*(this->socket[foundRoute->second.initiator]))->nb_transport_bw(trans, phase, delay);
+        if(status == tlm::TLM_COMPLETED){
+            this->completeRoute(trans);
+        }
+        return status;
+    }
+
+    // TLM-2 DMI method: the request is forwarded to the target and the
+    // granted (or denied) region is translated back in the initiator address space
+    bool get_direct_mem_ptr(int tag, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data){
+        sc_dt::uint64 adr = trans.get_address();
+        const AddressRange * range = this->addressMap.decode(adr);
+        if(range == NULL){
+            dmi_data.set_start_address(adr);
+            dmi_data.set_end_address(adr);
+            return false;
+        }
+
+        trans.set_address(adr - range->start);
+        bool dmiGranted = (*(this->initSocket[range->target]))->get_direct_mem_ptr(trans, dmi_data);
+        trans.set_address(adr);
+
+        if(!this->addressMap.rebaseDMI(*range, dmi_data)){
+            // The granted region is outside the mapped range: DMI is denied
+            dmi_data.set_start_address(adr);
+            dmi_data.set_end_address(adr);
+            return false;
+        }
+        dmi_data.set_read_latency(dmi_data.get_read_latency() + this->latency);
+        dmi_data.set_write_latency(dmi_data.get_write_latency() + this->latency);
+
+        return dmiGranted;
+    }
+
+    // TLM-2 debug transaction method
+    unsigned int transport_dbg(int tag, tlm::tlm_generic_payload& trans){
+        sc_dt::uint64 adr = trans.get_address();
+        const AddressRange * range = this->addressMap.decode(adr);
+        if(range == NULL){
+            return 0;
+        }
+
+        // Debug accesses are not allowed to cross the boundary of the target range
+        unsigned int len = trans.get_data_length();
+        if(len > range->end - adr + 1){
+            trans.set_data_length(range->end - adr + 1);
+        }
+        trans.set_address(adr - range->start);
+        unsigned int num_bytes = (*(this->initSocket[range->target]))->transport_dbg(trans);
+        trans.set_address(adr);
+        trans.set_data_length(len);
+
+        return num_bytes;
+    }
+
+    // TLM-2 DMI invalidation coming from one of the targets: the range is
+    // translated in the initiator address space and broadcasted to all the initiators
+    void invalidate_direct_mem_ptr(int tag, sc_dt::uint64 start_range, sc_dt::uint64 end_range){
+        std::vector<AddressRange> targetRanges = this->addressMap.getTargetRanges(tag);
+        std::vector<AddressRange>::iterator rangesIter, rangesEnd;
+        for(rangesIter = targetRanges.begin(), rangesEnd = targetRanges.end(); rangesIter != rangesEnd; rangesIter++){
+            sc_dt::uint64 start = start_range;
+            sc_dt::uint64 end = end_range;
+            if(!this->addressMap.rebaseInvalidate(*rangesIter, start, end)){
+                continue;
+            }
+            for(int i = 0; i < N_INITIATORS; i++){
+                (*(this->socket[i]))->invalidate_direct_mem_ptr(start, end);
+            }
+        }
+    }
+
+    private:
+    ///Routing information of a transaction in flight
+    struct RouteInfo{
+        int initiator;
+        unsigned int target;
+        sc_dt::uint64 address;
+
+        RouteInfo() : initiator(0), target(0), address(0){}
+        RouteInfo(int initiator, unsigned int target, sc_dt::uint64 address) : initiator(initiator), target(target), address(address){}
+    };
+
+    ///Restores the original address of the transaction and stops tracking it
+    void completeRoute(tlm::tlm_generic_payload& trans){
+        typename std::map<tlm::tlm_generic_payload *, RouteInfo>::iterator foundRoute = this->routes.find(&trans);
+        if(foundRoute != this->routes.end()){
+            trans.set_address(foundRoute->second.address);
+            this->routes.erase(foundRoute);
+        }
+    }
+
+    const sc_time latency;
+    AddressMap addressMap;
+    std::map<tlm::tlm_generic_payload *, RouteInfo> routes;
+};
+
+};
+
+#endif
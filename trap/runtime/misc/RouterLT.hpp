@@ -0,0 +1,194 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef ROUTERLT_HPP
+#define ROUTERLT_HPP
+
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <boost/lexical_cast.hpp>
+#include <string>
+#include <vector>
+
+#include <trap_utils.hpp>
+
+#include "AddressMap.hpp"
+
+namespace trap{
+
+///Loosely timed address-decoding router: requests coming from the initiators
+///are forwarded to the target owning the accessed address, with the address
+///rebased on the start of the target range. DMI requests and invalidations are
+///forwarded too, translating the DMI regions between the address spaces of the
+///initiators and of the targets, so that platforms with more than one target
+///keep on using direct memory access
+template<unsigned int N_INITIATORS, unsigned int N_TARGETS, unsigned int sockSize> class RouterLT: public sc_module{
+    public:
+    tlm_utils::simple_target_socket_tagged<RouterLT, sockSize> * socket[N_INITIATORS];
+    tlm_utils::simple_initiator_socket_tagged<RouterLT, sockSize> * initSocket[N_TARGETS];
+
+    RouterLT(sc_module_name name, sc_time latency = SC_ZERO_TIME) : sc_module(name), latency(latency){
+        for(int i = 0; i < N_INITIATORS; i++){
+            this->socket[i] = new tlm_utils::simple_target_socket_tagged<RouterLT, sockSize>(("router_socket_" + boost::lexical_cast<std::string>(i)).c_str());
+            this->socket[i]->register_b_transport(this, &RouterLT::b_transport, i);
+            this->socket[i]->register_get_direct_mem_ptr(this, &RouterLT::get_direct_mem_ptr, i);
+            this->socket[i]->register_transport_dbg(this, &RouterLT::transport_dbg, i);
+        }
+        for(int i = 0; i < N_TARGETS; i++){
+            this->initSocket[i] = new tlm_utils::simple_initiator_socket_tagged<RouterLT, sockSize>(("router_init_socket_" + boost::lexical_cast<std::string>(i)).c_str());
+            this->initSocket[i]->register_invalidate_direct_mem_ptr(this, &RouterLT::invalidate_direct_mem_ptr, i);
+        }
+        end_module();
+    }
+
+    ~RouterLT(){
+        for(int i = 0; i < N_INITIATORS; i++){
+            delete this->socket[i];
+        }
+        for(int i = 0; i < N_TARGETS; i++){
+            delete this->initSocket[i];
+        }
+    }
+
+    ///Maps size bytes starting from address start on the target
+    ///bound to initSocket[target]
+    void addTarget(unsigned int target, sc_dt::uint64 start, sc_dt::uint64 size){
+        if(target >= N_TARGETS){
+            THROW_EXCEPTION("Target " << target << " does not exist: router " << this->name() << " has only " << N_TARGETS << " targets");
+        }
+        if(size == 0){
+            THROW_EXCEPTION("Empty range specified for target " << target << " of router " << this->name());
+        }
+        this->addressMap.addRange(target, start, start + size - 1);
+    }
+
+    void b_transport(int tag, tlm::tlm_generic_payload& trans, sc_time& delay){
+        sc_dt::uint64 adr = trans.get_address();
+        const AddressRange * range = this->addressMap.decode(adr);
+        if(range == NULL){
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            std::cerr << "Error, address " << std::showbase << std::hex << adr << std::dec << " not mapped in router " << this->name() << std::endl;
+            return;
+        }
+
+        trans.set_address(adr - range->start);
+        (*(this->initSocket[range->target]))->b_transport(trans, delay);
+        trans.set_address(adr);
+
+        delay += this->latency;
+    }
+
+    // TLM-2 DMI method: the request is forwarded to the target and the
+    // granted (or denied) region is translated back in the initiator address space
+    bool get_direct_mem_ptr(int tag, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data){
+        sc_dt::uint64 adr = trans.get_address();
+        const AddressRange * range = this->addressMap.decode(adr);
+        if(range == NULL){
+            dmi_data.set_start_address(adr);
+            dmi_data.set_end_address(adr);
+            return false;
+        }
+
+        trans.set_address(adr - range->start);
+        bool dmiGranted = (*(this->initSocket[range->target]))->get_direct_mem_ptr(trans, dmi_data);
+        trans.set_address(adr);
+
+        if(!this->addressMap.rebaseDMI(*range, dmi_data)){
+            // The granted region is outside the mapped range: DMI is denied
+            dmi_data.set_start_address(adr);
+            dmi_data.set_end_address(adr);
+            return false;
+        }
+        dmi_data.set_read_latency(dmi_data.get_read_latency() + this->latency);
+        dmi_data.set_write_latency(dmi_data.get_write_latency() + this->latency);
+
+        return dmiGranted;
+    }
+
+    // TLM-2 debug transaction method
+    unsigned int transport_dbg(int tag, tlm::tlm_generic_payload& trans){
+        sc_dt::uint64 adr = trans.get_address();
+        const AddressRange * range = this->addressMap.decode(adr);
+        if(range == NULL){
+            return 0;
+        }
+
+        // Debug accesses are not allowed to cross the boundary of the target range
+        unsigned int len = trans.get_data_length();
+        if(len > range->end - adr + 1){
+            trans.set_data_length(range->end - adr + 1);
+        }
+        trans.set_address(adr - range->start);
+        unsigned int num_bytes = (*(this->initSocket[range->target]))->transport_dbg(trans);
+        trans.set_address(adr);
+        trans.set_data_length(len);
+
+        return num_bytes;
+    }
+
+    // TLM-2 DMI invalidation coming from one of the targets: the range is
+    // translated in the initiator address space and broadcasted to all the initiators
+    void invalidate_direct_mem_ptr(int tag, sc_dt::uint64 start_range, sc_dt::uint64 end_range){
+        std::vector<AddressRange> targetRanges = this->addressMap.getTargetRanges(tag);
+        std::vector<AddressRange>::iterator rangesIter, rangesEnd;
+        for(rangesIter = targetRanges.begin(), rangesEnd = targetRanges.end(); rangesIter != rangesEnd; rangesIter++){
+            sc_dt::uint64 start = start_range;
+            sc_dt::uint64 end = end_range;
+            if(!this->addressMap.rebaseInvalidate(*rangesIter, start, end)){
+                continue;
+            }
+            for(int i = 0; i < N_INITIATORS; i++){
+                (*(this->socket[i]))->invalidate_direct_mem_ptr(start, end);
+            }
+        }
+    }
+
+    private:
+    const sc_time latency;
+    AddressMap addressMap;
+};
+
+};
+
+#endif
@@ -40,8 +40,8 @@
  *
 \***************************************************************************/
 
-#ifndef MEMORYLT_HPP
-#define MEMORYLT_HPP
+#ifndef SPARSE_MEMORYLT_HPP
+#define SPARSE_MEMORYLT_HPP
 
 #include <systemc.h>
 #include <tlm.h>
@@ -83,6 +83,7 @@
 
 #include "syscCallB.hpp"
 #include "instructionBase.hpp"
+#include "perfCounters.hpp"
 
 namespace trap{
 
@@ -92,6 +93,7 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
     ABIIf<issueWidth> &processorInstance;
     typename template_map<issueWidth, SyscallCB<issueWidth>* >::const_iterator syscCallbacksEnd;
     ELFFrontend *elfFrontend;
+    PerfCounters *perfCounters;
 
     unsigned int countBits(issueWidth bits){
         unsigned int numBits = 0;
@@ -149,7 +151,7 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
     }
 
   public:
-    OSEmulator(ABIIf<issueWidth> &processorInstance) : processorInstance(processorInstance){
+    OSEmulator(ABIIf<issueWidth> &processorInstance) : processorInstance(processorInstance), perfCounters(NULL){
         this->syscCallbacksEnd = this->syscCallbacks.end();
     }
     std::set<std::string> getRegisteredFunctions(){
@@ -160,6 +162,22 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
         }
         return registeredFunctions;
     }
+    ///Returns the addresses of the emulated routines; processors which bind them
+    ///to the decoded instructions call newIssue only when one of these addresses
+    ///is reached, instead of registering the emulator as a tool
+    std::set<issueWidth> getRegisteredAddresses(){
+        std::set<issueWidth> registeredAddresses;
+        typename template_map<issueWidth, SyscallCB<issueWidth>* >::iterator emuIter, emuEnd;
+        for(emuIter = this->syscCallbacks.begin(), emuEnd = this->syscCallbacks.end(); emuIter != emuEnd; emuIter++){
+            registeredAddresses.insert(emuIter->first);
+        }
+        return registeredAddresses;
+    }
+    ///Sets the counters where the emulated calls are accounted for; they
+    ///are updated only when ENABLE_PERF_COUNTERS is defined
+    void setPerfCounters(PerfCounters * perfCounters){
+        this->perfCounters = perfCounters;
+    }
     void initSysCalls(std::string execName, int group = 0){
         std::map<std::string, sc_time> emptyLatMap;
         this->initSysCalls(execName, emptyLatMap, group);
@@ -179,66 +197,66 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
 
         openSysCall<issueWidth> *a = NULL;
         if(latencies.find("open") != latencies.end())
-            a = new openSysCall<issueWidth>(this->processorInstance, *this, latencies["open"]);
+            a = new openSysCall<issueWidth>(this->processorInstance, *this, this->vfs, latencies["open"]);
         else if(latencies.find("_open") != latencies.end())
-            a = new openSysCall<issueWidth>(this->processorInstance, *this, latencies["_open"]);
+            a = new openSysCall<issueWidth>(this->processorInstance, *this, this->vfs, latencies["_open"]);
         else
-            a = new openSysCall<issueWidth>(this->processorInstance, *this);
+            a = new openSysCall<issueWidth>(this->processorInstance, *this, this->vfs);
         registered = this->register_syscall("open", *a);
         registered |= this->register_syscall("_open", *a);
         if(!registered)
             delete a;
         creatSysCall<issueWidth> *b = NULL;
         if(latencies.find("creat") != latencies.end())
-            b = new creatSysCall<issueWidth>(this->processorInstance, latencies["creat"]);
+            b = new creatSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["creat"]);
         else if(latencies.find("_creat") != latencies.end())
-            b = new creatSysCall<issueWidth>(this->processorInstance, latencies["_creat"]);
+            b = new creatSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_creat"]);
         else
-            b = new creatSysCall<issueWidth>(this->processorInstance);
+            b = new creatSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("creat", *b);
         registered |= this->register_syscall("_creat", *b);
         if(!registered)
             delete b;
         closeSysCall<issueWidth> *c = NULL;
         if(latencies.find("close") != latencies.end())
-            c = new closeSysCall<issueWidth>(this->processorInstance, latencies["close"]);
+            c = new closeSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["close"]);
         else if(latencies.find("_close") != latencies.end())
-            c = new closeSysCall<issueWidth>(this->processorInstance, latencies["_close"]);
+            c = new closeSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_close"]);
         else
-            c = new closeSysCall<issueWidth>(this->processorInstance);
+            c = new closeSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("close", *c);
         registered |= this->register_syscall("_close", *c);
         if(!registered)
             delete c;
         readSysCall<issueWidth> *d = NULL;
         if(latencies.find("read") != latencies.end())
-            d = new readSysCall<issueWidth>(this->processorInstance, latencies["read"]);
+            d = new readSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["read"]);
         else if(latencies.find("_read") != latencies.end())
-            d = new readSysCall<issueWidth>(this->processorInstance, latencies["_read"]);
+            d = new readSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_read"]);
         else
-            d = new readSysCall<issueWidth>(this->processorInstance);
+            d = new readSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("read", *d);
         registered |= this->register_syscall("_read", *d);
         if(!registered)
             delete d;
         writeSysCall<issueWidth> *e = NULL;
         if(latencies.find("write") != latencies.end())
-            e = new writeSysCall<issueWidth>(this->processorInstance, latencies["write"]);
+            e = new writeSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["write"]);
         else if(latencies.find("_write") != latencies.end())
-            e = new writeSysCall<issueWidth>(this->processorInstance, latencies["_write"]);
+            e = new writeSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_write"]);
         else
-            e = new writeSysCall<issueWidth>(this->processorInstance);
+            e = new writeSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("write", *e);
         registered |= this->register_syscall("_write", *e);
         if(!registered)
             delete e;
         isattySysCall<issueWidth> *f = NULL;
         if(latencies.find("isatty") != latencies.end())
-            f = new isattySysCall<issueWidth>(this->processorInstance, latencies["isatty"]);
+            f = new isattySysCall<issueWidth>(this->processorInstance, this->vfs, latencies["isatty"]);
         else if(latencies.find("_isatty") != latencies.end())
-            f = new isattySysCall<issueWidth>(this->processorInstance, latencies["_isatty"]);
+            f = new isattySysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_isatty"]);
         else
-            f = new isattySysCall<issueWidth>(this->processorInstance);
+            f = new isattySysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("isatty", *f);
         registered |= this->register_syscall("_isatty", *f);
         if(!registered)
@@ -256,31 +274,31 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
             delete g;
         lseekSysCall<issueWidth> *h = NULL;
         if(latencies.find("lseek") != latencies.end())
-            h = new lseekSysCall<issueWidth>(this->processorInstance, latencies["lseek"]);
+            h = new lseekSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["lseek"]);
         else if(latencies.find("_lseek") != latencies.end())
-            h = new lseekSysCall<issueWidth>(this->processorInstance, latencies["_lseek"]);
+            h = new lseekSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_lseek"]);
         else
-            h = new lseekSysCall<issueWidth>(this->processorInstance);
+            h = new lseekSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("lseek", *h);
         registered |= this->register_syscall("_lseek", *h);
         if(!registered)
             delete h;
         fstatSysCall<issueWidth> *i = NULL;
         if(latencies.find("fstat") != latencies.end())
-            i = new fstatSysCall<issueWidth>(this->processorInstance, latencies["fstat"]);
+            i = new fstatSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["fstat"]);
         else if(latencies.find("_fstat") != latencies.end())
-            i = new fstatSysCall<issueWidth>(this->processorInstance, latencies["_fstat"]);
+            i = new fstatSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_fstat"]);
         else
-            i = new fstatSysCall<issueWidth>(this->processorInstance);
+            i = new fstatSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("fstat", *i);
         registered |= this->register_syscall("_fstat", *i);
         if(!registered)
             delete i;
         _exitSysCall<issueWidth> *j = NULL;
         if(latencies.find("_exit") != latencies.end())
-            j = new _exitSysCall<issueWidth>(this->processorInstance, latencies["_exit"]);
+            j = new _exitSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_exit"]);
         else
-            j = new _exitSysCall<issueWidth>(this->processorInstance);
+            j = new _exitSysCall<issueWidth>(this->processorInstance, this->vfs);
         if(!this->register_syscall("_exit", *j))
             delete j;
         timesSysCall<issueWidth> *k = NULL;
@@ -340,22 +358,22 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
             delete o;
         dupSysCall<issueWidth> * p = NULL;
         if(latencies.find("dup") != latencies.end())
-            p = new dupSysCall<issueWidth>(this->processorInstance, latencies["dup"]);
+            p = new dupSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["dup"]);
         else if(latencies.find("_dup") != latencies.end())
-            p = new dupSysCall<issueWidth>(this->processorInstance, latencies["_dup"]);
+            p = new dupSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_dup"]);
         else
-            p = new dupSysCall<issueWidth>(this->processorInstance);
+            p = new dupSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("dup", *p);
         registered |= this->register_syscall("_dup", *p);
         if(!registered)
             delete p;
         dup2SysCall<issueWidth> * q = NULL;
         if(latencies.find("dup2") != latencies.end())
-            q = new dup2SysCall<issueWidth>(this->processorInstance, latencies["dup2"]);
+            q = new dup2SysCall<issueWidth>(this->processorInstance, this->vfs, latencies["dup2"]);
         else if(latencies.find("_dup2") != latencies.end())
-            q = new dup2SysCall<issueWidth>(this->processorInstance, latencies["_dup2"]);
+            q = new dup2SysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_dup2"]);
         else
-            q = new dup2SysCall<issueWidth>(this->processorInstance);
+            q = new dup2SysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("dup2", *q);
         registered |= this->register_syscall("_dup2", *q);
         if(!registered)
@@ -402,11 +420,11 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
             delete u;
         errorSysCall<issueWidth> *v = NULL;
         if(latencies.find("error") != latencies.end())
-            v = new errorSysCall<issueWidth>(this->processorInstance, latencies["error"]);
+            v = new errorSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["error"]);
         else if(latencies.find("_error") != latencies.end())
-            v = new errorSysCall<issueWidth>(this->processorInstance, latencies["_error"]);
+            v = new errorSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_error"]);
         else
-            v = new errorSysCall<issueWidth>(this->processorInstance);
+            v = new errorSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("error", *v);
         registered |= this->register_syscall("_error", *v);
         if(!registered)
@@ -424,11 +442,11 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
             delete w;
         unlinkSysCall<issueWidth> *x = NULL;
         if(latencies.find("unlink") != latencies.end())
-            x = new unlinkSysCall<issueWidth>(this->processorInstance, latencies["unlink"]);
+            x = new unlinkSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["unlink"]);
         else if(latencies.find("_unlink") != latencies.end())
-            x = new unlinkSysCall<issueWidth>(this->processorInstance, latencies["_unlink"]);
+            x = new unlinkSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_unlink"]);
         else
-            x = new unlinkSysCall<issueWidth>(this->processorInstance);
+            x = new unlinkSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("unlink", *x);
         registered |= this->register_syscall("_unlink", *x);
         if(!registered)
@@ -446,22 +464,22 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
             delete y;
         statSysCall<issueWidth> *z = NULL;
         if(latencies.find("stat") != latencies.end())
-            z = new statSysCall<issueWidth>(this->processorInstance, latencies["stat"]);
+            z = new statSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["stat"]);
         else if(latencies.find("_stat") != latencies.end())
-            z = new statSysCall<issueWidth>(this->processorInstance, latencies["_stat"]);
+            z = new statSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_stat"]);
         else
-            z = new statSysCall<issueWidth>(this->processorInstance);
+            z = new statSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("stat", *z);
         registered |= this->register_syscall("_stat", *z);
         if(!registered)
             delete z;
         lstatSysCall<issueWidth> *A = NULL;
         if(latencies.find("lstat") != latencies.end())
-            A = new lstatSysCall<issueWidth>(this->processorInstance, latencies["lstat"]);
+            A = new lstatSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["lstat"]);
         else if(latencies.find("_lstat") != latencies.end())
-            A = new lstatSysCall<issueWidth>(this->processorInstance, latencies["_lstat"]);
+            A = new lstatSysCall<issueWidth>(this->processorInstance, this->vfs, latencies["_lstat"]);
         else
-            A = new lstatSysCall<issueWidth>(this->processorInstance);
+            A = new lstatSysCall<issueWidth>(this->processorInstance, this->vfs);
         registered = this->register_syscall("lstat", *A);
         registered |= this->register_syscall("_lstat", *A);
         if(!registered)
@@ -490,6 +508,15 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
         //callback.
         typename template_map<issueWidth, SyscallCB<issueWidth>* >::const_iterator foundSysc = this->syscCallbacks.find(curPC);
         if(foundSysc != this->syscCallbacksEnd){
+            #ifdef ENABLE_PERF_COUNTERS
+            if(this->perfCounters != NULL){
+                this->perfCounters->syscalls++;
+                PerfPhase prevPhase = this->perfCounters->enterPhase(PHASE_SYSCALLS);
+                bool skip = (*(foundSysc->second))();
+                this->perfCounters->enterPhase(prevPhase);
+                return skip;
+            }
+            #endif
             return (*(foundSysc->second))();
         }
         return false;
@@ -503,6 +530,16 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
         }
         return false;
     }
+    ///Only the addresses of the emulated routines are watched
+    bool watchesRange(const issueWidth &start, const issueWidth &end) const throw(){
+        typename template_map<issueWidth, SyscallCB<issueWidth>* >::const_iterator syscIter;
+        for(syscIter = this->syscCallbacks.begin(); syscIter != this->syscCallbacksEnd; syscIter++){
+            if(syscIter->first >= start && syscIter->first < end){
+                return true;
+            }
+        }
+        return false;
+    }
     ///Resets the whole concurrency emulator, reinitializing it and preparing it for a new simulation
     void reset(){
         this->syscCallbacks.clear();
@@ -513,6 +550,7 @@ template<class issueWidth> class OSEmulator : public ToolsIf<issueWidth>, public
         this->heapPointer = 0;
         this->groupIDs.clear();
         this->programsCount = 0;
+        this->vfs.reset();
     }
     //The destructor calls the reset method
     ~OSEmulator(){
@@ -111,6 +111,7 @@ void trap::OSEmulatorBase::reset(){
     this->sysconfmap.clear();    
     this->programArgs.clear();    
     this->heapPointer = 0;
+    this->vfs.reset();
     ELFFrontend::reset();
 }
 
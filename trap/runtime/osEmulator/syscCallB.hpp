@@ -87,6 +87,7 @@ extern int errno;
 #include <ctime>
 
 #include "elfFrontend.hpp"
+#include "vfs.hpp"
 
 
 namespace trap{
@@ -105,6 +106,8 @@ class OSEmulatorBase{
     std::map<std::string, int> sysconfmap;
     std::vector<std::string> programArgs;
     unsigned int heapPointer;    
+    ///File system and descriptor table of the emulated application
+    VirtualFS vfs;
     
     static std::vector<unsigned int> groupIDs;
     static unsigned int programsCount;
@@ -127,27 +130,19 @@ template<class wordSize> class SyscallCB{
 template<class wordSize> class openSysCall : public SyscallCB<wordSize>{
     private:
         OSEmulatorBase& osEmu;
+        VirtualFS &vfs;
     public:
-    openSysCall(ABIIf<wordSize> &processorInstance, OSEmulatorBase &osEmu, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), osEmu(osEmu){}
+    openSysCall(ABIIf<wordSize> &processorInstance, OSEmulatorBase &osEmu, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), osEmu(osEmu), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
         //Lets read the name of the file to be opened
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
         int flags = callArgs[1];
         osEmu.correct_flags(flags);
         int mode = callArgs[2];
-        #ifdef __GNUC__
-        int ret = ::open(pathname, flags, mode);
-        #else
-        int ret = ::_open(pathname, flags, mode);
-        #endif
+        int ret = this->vfs.open(pathname, flags, mode);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -160,25 +155,18 @@ template<class wordSize> class openSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class creatSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    creatSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    creatSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
         //Lets read the name of the file to be opened
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
         int mode = callArgs[1];
-        #ifdef __GNUC__
-        int ret = ::creat((char*)pathname, mode);
-        #else
-        int ret = ::_creat((char*)pathname, mode);
-        #endif
+        int ret = this->vfs.open(pathname, O_CREAT | O_WRONLY | O_TRUNC, mode);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -191,8 +179,10 @@ template<class wordSize> class creatSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class closeSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    closeSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    closeSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -201,23 +191,9 @@ template<class wordSize> class closeSysCall : public SyscallCB<wordSize>{
         if(fd < 0){
             THROW_EXCEPTION("File descriptor " << fd << " not valid");
         }
-        #ifdef __GNUC__
-        if( fd == fileno(stdin) || fd == fileno(stdout) || fd == fileno(stderr) ){
-        #else
-        if( fd == _fileno(stdin) || fd == _fileno(stdout) || fd == _fileno(stderr) ){
-        #endif
-            this->processorInstance.setRetVal(0);
-            this->processorInstance.returnFromCall();
-        }
-        else{
-            #ifdef __GNUC__
-            int ret = ::close(fd);
-            #else
-            int ret = ::_close(fd);
-            #endif
-            this->processorInstance.setRetVal(ret);
-            this->processorInstance.returnFromCall();
-        }
+        int ret = this->vfs.close(fd);
+        this->processorInstance.setRetVal(ret);
+        this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
 
         if(this->latency.to_double() > 0)
@@ -228,8 +204,10 @@ template<class wordSize> class closeSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class readSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    readSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    readSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -240,15 +218,11 @@ template<class wordSize> class readSysCall : public SyscallCB<wordSize>{
         }
         unsigned count = callArgs[2];
         unsigned char *buf = new unsigned char[count];
-        #ifdef __GNUC__
-        int ret = ::read(fd, buf, count);
-        #else
-        int ret = ::_read(fd, buf, count);
-        #endif
+        int ret = this->vfs.read(fd, buf, count);
         // Now I have to write the read content into memory
         wordSize destAddress = callArgs[1];
-        for(int i = 0; i < ret; i++){
-            this->processorInstance.writeCharMem(destAddress + i, buf[i]);
+        if(ret > 0){
+            this->processorInstance.writeMemBlock(destAddress, buf, ret);
         }
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
@@ -263,8 +237,10 @@ template<class wordSize> class readSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class writeSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    writeSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    writeSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -276,14 +252,8 @@ template<class wordSize> class writeSysCall : public SyscallCB<wordSize>{
         unsigned count = callArgs[2];
         wordSize destAddress = callArgs[1];
         unsigned char *buf = new unsigned char[count];
-        for(unsigned int i = 0; i < count; i++){
-            buf[i] = this->processorInstance.readCharMem(destAddress + i);
-        }
-        #ifdef __GNUC__
-        int ret = ::write(fd, buf, count);
-        #else
-        int ret = ::_write(fd, buf, count);
-        #endif
+        this->processorInstance.readMemBlock(destAddress, buf, count);
+        int ret = this->vfs.write(fd, buf, count);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         delete [] buf;
@@ -297,18 +267,16 @@ template<class wordSize> class writeSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class isattySysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    isattySysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    isattySysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
         int desc = callArgs[0];
-        #ifdef __GNUC__
-        int ret = ::isatty(desc);
-        #else
-        int ret = ::_isatty(desc);
-        #endif
+        int ret = this->vfs.isatty(desc);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -358,8 +326,10 @@ template<class wordSize> class sbrkSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class lseekSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    lseekSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    lseekSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -370,11 +340,7 @@ template<class wordSize> class lseekSysCall : public SyscallCB<wordSize>{
         }
         int offset = callArgs[1];
         int whence = callArgs[2];
-        #ifdef __GNUC__
-        int ret = ::lseek(fd, offset, whence);
-        #else
-        int ret = ::_lseek(fd, offset, whence);
-        #endif
+        int ret = this->vfs.lseek(fd, offset, whence);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -387,27 +353,21 @@ template<class wordSize> class lseekSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class fstatSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    fstatSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    fstatSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
-        #ifdef __GNUC__
-        struct stat buf_stat;
-        #else
-        struct _stat buf_stat;
-        #endif
+        HostStat buf_stat;
         int fd = callArgs[0];
         if(fd < 0){
             THROW_EXCEPTION("File descriptor " << fd << " not valid");
         }
         int retAddr = callArgs[1];
-        #ifdef __GNUC__
-        int ret = ::fstat(fd, &buf_stat);
-        #else
-        int ret = ::_fstat(fd, &buf_stat);
-        #endif
+        int ret = this->vfs.fstat(fd, buf_stat);
         if(ret >= 0 && retAddr != 0){
             this->processorInstance.writeMem(retAddr, buf_stat.st_dev);
             this->processorInstance.writeMem(retAddr + 2, buf_stat.st_ino);
@@ -437,31 +397,20 @@ template<class wordSize> class fstatSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class statSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    statSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    statSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        #ifdef __GNUC__
-        struct stat buf_stat;
-        #else
-        struct _stat buf_stat;
-        #endif
+        HostStat buf_stat;
 
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
         int retAddr = callArgs[1];
-        #ifdef __GNUC__
-        int ret = ::stat((char *)pathname, &buf_stat);
-        #else
-        int ret = ::_stat((char *)pathname, &buf_stat);
-        #endif
+        int ret = this->vfs.stat(pathname, buf_stat);
         if(ret >= 0 && retAddr != 0){
             this->processorInstance.writeMem(retAddr, buf_stat.st_dev);
             this->processorInstance.writeMem(retAddr + 2, buf_stat.st_ino);
@@ -491,13 +440,16 @@ template<class wordSize> class statSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class _exitSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    _exitSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    _exitSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         extern int exitValue;
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
         exitValue = (int)callArgs[0];
+        this->vfs.flush();
         std::cout << std::endl << "Program exited with value " << exitValue << std::endl << std::endl;
 
         if(sc_is_running()){
@@ -609,17 +561,12 @@ template<class wordSize> class utimesSysCall : public SyscallCB<wordSize>{
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
 
         int ret = -1;
         int timesAddr = callArgs[1];
         if(timesAddr == 0){
-            ret = ::utimes((char *)pathname, NULL);
+            ret = ::utimes(pathname.c_str(), NULL);
         }
         else{
             struct timeval times[2];
@@ -627,7 +574,7 @@ template<class wordSize> class utimesSysCall : public SyscallCB<wordSize>{
             times[0].tv_usec = this->processorInstance.readMem(timesAddr + 4);
             times[1].tv_sec = this->processorInstance.readMem(timesAddr + 8);
             times[1].tv_usec = this->processorInstance.readMem(timesAddr + 12);
-            ret = ::utimes((char *)pathname, times);
+            ret = ::utimes(pathname.c_str(), times);
         }
 
         this->processorInstance.setRetVal(ret);
@@ -642,31 +589,20 @@ template<class wordSize> class utimesSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class lstatSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    lstatSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    lstatSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        #ifdef __GNUC__
-        struct stat buf_stat;
-        #else
-        struct _stat buf_stat;
-        #endif
+        HostStat buf_stat;
 
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
         int retAddr = callArgs[1];
-        #ifdef __GNUC__
-        int ret = ::lstat((char *)pathname, &buf_stat);
-        #else
-        int ret = ::_lstat((char *)pathname, &buf_stat);
-        #endif
+        int ret = this->vfs.lstat(pathname, buf_stat);
         if(ret >= 0 && retAddr != 0){
             this->processorInstance.writeMem(retAddr, buf_stat.st_dev);
             this->processorInstance.writeMem(retAddr + 2, buf_stat.st_ino);
@@ -719,17 +655,12 @@ template<class wordSize> class chmodSysCall : public SyscallCB<wordSize>{
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
         int mode = callArgs[1];
         #ifdef __GNUC__
-        int ret = ::chmod((char*)pathname, mode);
+        int ret = ::chmod(pathname.c_str(), mode);
         #else
-        int ret = ::_chmod((char*)pathname, mode);
+        int ret = ::_chmod(pathname.c_str(), mode);
         #endif
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
@@ -743,8 +674,10 @@ template<class wordSize> class chmodSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class dupSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    dupSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    dupSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -753,11 +686,7 @@ template<class wordSize> class dupSysCall : public SyscallCB<wordSize>{
         if(fd < 0){
             THROW_EXCEPTION("File descriptor not valid");
         }
-        #ifdef __GNUC__
-        int ret = ::dup(fd);
-        #else
-        int ret = ::_dup(fd);
-        #endif
+        int ret = this->vfs.dup(fd);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -770,8 +699,10 @@ template<class wordSize> class dupSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class dup2SysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    dup2SysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    dup2SysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -781,11 +712,7 @@ template<class wordSize> class dup2SysCall : public SyscallCB<wordSize>{
             THROW_EXCEPTION("File descriptor not valid");
         }
         int newfd = callArgs[1];
-        #ifdef __GNUC__
-        int ret = ::dup2(fd,  newfd);
-        #else
-        int ret = ::_dup2(fd,  newfd);
-        #endif
+        int ret = this->vfs.dup2(fd,  newfd);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -809,15 +736,10 @@ template<class wordSize> class getenvSysCall : public SyscallCB<wordSize>{
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        char envname[256];
         int envNameAddr = callArgs[0];
         if(envNameAddr != 0){
-            for(int i = 0; i < 256; i++){
-                envname[i] = (char)this->processorInstance.readCharMem(envNameAddr + i);
-                if(envname[i] == '\x0')
-                    break;
-            }
-            std::map<std::string,  std::string>::iterator curEnv = this->env.find((std::string(envname)));
+            std::string envname = this->processorInstance.readCString(envNameAddr);
+            std::map<std::string,  std::string>::iterator curEnv = this->env.find(envname);
             if(curEnv == this->env.end()){
                 this->processorInstance.setRetVal(0);
                 this->processorInstance.returnFromCall();
@@ -828,10 +750,7 @@ template<class wordSize> class getenvSysCall : public SyscallCB<wordSize>{
                 //the pointer to it
                 unsigned int base = this->heapPointer;
                 this->heapPointer += curEnv->second.size() + 1;
-                for(unsigned int i = 0; i < curEnv->second.size(); i++){
-                    this->processorInstance.writeCharMem(base + i, curEnv->second[i]);
-                }
-                this->processorInstance.writeCharMem(base + curEnv->second.size(), 0);
+                this->processorInstance.writeMemBlock(base, (const unsigned char *)curEnv->second.c_str(), curEnv->second.size() + 1);
                 this->processorInstance.setRetVal(base);
                 this->processorInstance.returnFromCall();
             }
@@ -891,8 +810,10 @@ template<class wordSize> class killSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class errorSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    errorSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    errorSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
@@ -901,6 +822,7 @@ template<class wordSize> class errorSysCall : public SyscallCB<wordSize>{
         int status = callArgs[0];
         int errnum = callArgs[1];
         char*  errorString = ::strerror(errnum);
+        this->vfs.flush();
         if(status != 0){
             std::cerr << std::endl << "Program exited with value " << status << std::endl << " Error message: " << errorString << std::endl;
             if(sc_is_running())
@@ -929,15 +851,10 @@ template<class wordSize> class chownSysCall : public SyscallCB<wordSize>{
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
         uid_t owner = callArgs[1];
         gid_t group = callArgs[2];
-        int ret = ::chown((char*)pathname, owner, group);
+        int ret = ::chown(pathname.c_str(), owner, group);
         #else
         int ret = 0;
         #endif
@@ -953,24 +870,17 @@ template<class wordSize> class chownSysCall : public SyscallCB<wordSize>{
 };
 
 template<class wordSize> class unlinkSysCall : public SyscallCB<wordSize>{
+    private:
+        VirtualFS &vfs;
     public:
-    unlinkSysCall(ABIIf<wordSize> &processorInstance, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency){}
+    unlinkSysCall(ABIIf<wordSize> &processorInstance, VirtualFS &vfs, sc_time latency = SC_ZERO_TIME) : SyscallCB<wordSize>(processorInstance, latency), vfs(vfs){}
     bool operator()(){
         this->processorInstance.preCall();
         //Lets get the system call arguments
         std::vector< wordSize > callArgs = this->processorInstance.readArgs();
 
-        char pathname[256];
-        for(int i = 0; i < 256; i++){
-            pathname[i] = (char)this->processorInstance.readCharMem(callArgs[0] + i);
-            if(pathname[i] == '\x0')
-                break;
-        }
-        #ifdef __GNUC__
-        int ret = ::unlink((char*)pathname);
-        #else
-        int ret = ::_unlink((char*)pathname);
-        #endif
+        std::string pathname = this->processorInstance.readCString(callArgs[0]);
+        int ret = this->vfs.unlink(pathname);
         this->processorInstance.setRetVal(ret);
         this->processorInstance.returnFromCall();
         this->processorInstance.postCall();
@@ -1030,10 +940,7 @@ template<class wordSize> class mainSysCall : public SyscallCB<wordSize>{
         for(argsIter = this->programArgs.begin(), argsEnd = this->programArgs.end(); argsIter != argsEnd; argsIter++){
             this->processorInstance.writeMem(argNumAddr, argAddr);
             argNumAddr += 4;
-            for(unsigned int i = 0; i < argsIter->size(); i++){
-                this->processorInstance.writeCharMem(argAddr + i, argsIter->c_str()[i]);
-            }
-            this->processorInstance.writeCharMem(argAddr + argsIter->size(), 0);
+            this->processorInstance.writeMemBlock(argAddr, (const unsigned char *)argsIter->c_str(), argsIter->size() + 1);
             argAddr += argsIter->size() + 1;
         }
         this->processorInstance.writeMem(argNumAddr, 0);
@@ -0,0 +1,499 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#include "vfs.hpp"
+#include "trap_utils.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef __GNUC__
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include <boost/shared_ptr.hpp>
+
+///Maximum number of descriptors a simulated application can keep open
+#define VFS_MAX_FDS 1024
+
+static void fillMemoryStat(const trap::MemoryFile & file, trap::HostStat & buf){
+    memset(&buf, 0, sizeof(buf));
+    buf.st_mode = S_IFREG | (file.mode & 0777);
+    buf.st_nlink = 1;
+    buf.st_size = file.data.size();
+    buf.st_atime = file.modTime;
+    buf.st_mtime = file.modTime;
+    buf.st_ctime = file.modTime;
+    #ifdef __GNUC__
+    buf.st_blksize = 4096;
+    buf.st_blocks = (file.data.size() + 511)/512;
+    #endif
+}
+
+trap::VirtualFS::VirtualFS() : pendingFile(NULL), bufferSize(4096), memoryOnly(false){
+    this->initStdFiles();
+}
+
+trap::VirtualFS::~VirtualFS(){
+    this->closeAll();
+}
+
+void trap::VirtualFS::initStdFiles(){
+    // Guest descriptors 0, 1 and 2 refer to the host standard streams;
+    // output and error are buffered
+    for(int i = 0; i < 3; i++){
+        boost::shared_ptr<OpenFile> stdFile(new OpenFile());
+        stdFile->hostFd = i;
+        stdFile->flags = (i == 0) ? O_RDONLY : O_WRONLY;
+        stdFile->offset = 0;
+        stdFile->buffered = i > 0;
+        this->fdTable.push_back(stdFile);
+    }
+}
+
+void trap::VirtualFS::closeAll(){
+    this->flush();
+    std::vector<boost::shared_ptr<OpenFile> >::iterator fdIter, fdEnd;
+    for(fdIter = this->fdTable.begin(), fdEnd = this->fdTable.end(); fdIter != fdEnd; fdIter++){
+        if(*fdIter){
+            this->releaseFile(*fdIter);
+        }
+    }
+    this->fdTable.clear();
+}
+
+void trap::VirtualFS::reset(){
+    this->closeAll();
+    this->files.clear();
+    this->initStdFiles();
+}
+
+void trap::VirtualFS::loadManifest(const std::string & manifest){
+    std::ifstream manifestFile(manifest.c_str());
+    if(!manifestFile){
+        THROW_EXCEPTION("Error in opening the file system manifest " << manifest);
+    }
+    std::string line;
+    while(std::getline(manifestFile, line)){
+        std::istringstream lineStream(line);
+        std::string guestPath, hostPath;
+        if(!(lineStream >> guestPath) || guestPath[0] == '#'){
+            continue;
+        }
+        if(!(lineStream >> hostPath)){
+            hostPath = guestPath;
+        }
+        std::ifstream hostFile(hostPath.c_str(), std::ios::in | std::ios::binary);
+        if(!hostFile){
+            THROW_EXCEPTION("Error in opening file " << hostPath << " listed in the file system manifest " << manifest);
+        }
+        std::ostringstream content;
+        content << hostFile.rdbuf();
+        this->addFile(guestPath, content.str());
+    }
+}
+
+void trap::VirtualFS::addFile(const std::string & path, const std::string & content){
+    boost::shared_ptr<MemoryFile> newFile(new MemoryFile());
+    newFile->data.assign(content.begin(), content.end());
+    newFile->mode = 0644;
+    newFile->modTime = ::time(NULL);
+    this->files[path] = newFile;
+}
+
+void trap::VirtualFS::setMemoryOnly(bool memoryOnly){
+    this->memoryOnly = memoryOnly;
+}
+
+void trap::VirtualFS::setBufferSize(unsigned int bufferSize){
+    this->flush();
+    this->bufferSize = bufferSize;
+}
+
+boost::shared_ptr<trap::OpenFile> trap::VirtualFS::getFile(int fd){
+    if(fd < 0 || fd >= (int)this->fdTable.size() || !this->fdTable[fd]){
+        errno = EBADF;
+        return boost::shared_ptr<OpenFile>();
+    }
+    return this->fdTable[fd];
+}
+
+int trap::VirtualFS::allocateFd(boost::shared_ptr<OpenFile> file, unsigned int minFd){
+    for(unsigned int i = minFd; i < this->fdTable.size(); i++){
+        if(!this->fdTable[i]){
+            this->fdTable[i] = file;
+            return i;
+        }
+    }
+    if(this->fdTable.size() >= VFS_MAX_FDS){
+        errno = EMFILE;
+        return -1;
+    }
+    this->fdTable.push_back(file);
+    return this->fdTable.size() - 1;
+}
+
+void trap::VirtualFS::flushFile(OpenFile & file){
+    unsigned int written = 0;
+    while(written < file.outBuffer.size()){
+        #ifdef __GNUC__
+        int ret = ::write(file.hostFd, file.outBuffer.data() + written, file.outBuffer.size() - written);
+        #else
+        int ret = ::_write(file.hostFd, file.outBuffer.data() + written, file.outBuffer.size() - written);
+        #endif
+        if(ret <= 0){
+            break;
+        }
+        written += ret;
+    }
+    file.outBuffer.clear();
+    if(this->pendingFile == &file){
+        this->pendingFile = NULL;
+    }
+}
+
+int trap::VirtualFS::releaseFile(boost::shared_ptr<OpenFile> & file){
+    int ret = 0;
+    // The host descriptor is closed only when the last guest descriptor
+    // referring to it goes away; the host standard streams are never closed
+    if(file.unique()){
+        this->flushFile(*file);
+        if(!file->memFile && file->hostFd > 2){
+            #ifdef __GNUC__
+            ret = ::close(file->hostFd);
+            #else
+            ret = ::_close(file->hostFd);
+            #endif
+        }
+    }
+    file.reset();
+    return ret;
+}
+
+int trap::VirtualFS::open(const std::string & pathname, int flags, int mode){
+    boost::shared_ptr<OpenFile> file(new OpenFile());
+    file->hostFd = -1;
+    file->flags = flags;
+    file->offset = 0;
+    file->buffered = false;
+    std::map<std::string, boost::shared_ptr<MemoryFile> >::iterator foundFile = this->files.find(pathname);
+    if(foundFile != this->files.end()){
+        if((flags & O_CREAT) != 0 && (flags & O_EXCL) != 0){
+            errno = EEXIST;
+            return -1;
+        }
+        file->memFile = foundFile->second;
+        if((flags & O_TRUNC) != 0 && (flags & (O_WRONLY | O_RDWR)) != 0){
+            file->memFile->data.clear();
+            file->memFile->modTime = ::time(NULL);
+        }
+    }
+    else if(this->memoryOnly && (flags & O_CREAT) != 0){
+        boost::shared_ptr<MemoryFile> newFile(new MemoryFile());
+        newFile->mode = mode;
+        newFile->modTime = ::time(NULL);
+        this->files[pathname] = newFile;
+        file->memFile = newFile;
+    }
+    else{
+        #ifdef __GNUC__
+        file->hostFd = ::open(pathname.c_str(), flags, mode);
+        #else
+        file->hostFd = ::_open(pathname.c_str(), flags, mode);
+        #endif
+        if(file->hostFd < 0){
+            return -1;
+        }
+    }
+    int fd = this->allocateFd(file);
+    if(fd < 0){
+        this->releaseFile(file);
+    }
+    return fd;
+}
+
+int trap::VirtualFS::close(int fd){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    // The guest descriptor is always released, so that it can be reused by
+    // the next open (e.g. to redirect the standard output); the host
+    // standard streams are only flushed, as the simulator keeps printing
+    // its own messages on them
+    file.reset();
+    return this->releaseFile(this->fdTable[fd]);
+}
+
+int trap::VirtualFS::read(int fd, unsigned char * buffer, unsigned int count){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    if(file->memFile){
+        if((file->flags & O_WRONLY) != 0){
+            errno = EBADF;
+            return -1;
+        }
+        std::vector<unsigned char> & data = file->memFile->data;
+        if(file->offset >= data.size()){
+            return 0;
+        }
+        unsigned int toRead = data.size() - file->offset;
+        if(count < toRead){
+            toRead = count;
+        }
+        memcpy(buffer, &data[file->offset], toRead);
+        file->offset += toRead;
+        return toRead;
+    }
+    // The output produced so far has to be visible before the application
+    // waits for its input (e.g. when printing a prompt)
+    if(file->hostFd == 0){
+        this->flush();
+    }
+    #ifdef __GNUC__
+    return ::read(file->hostFd, buffer, count);
+    #else
+    return ::_read(file->hostFd, buffer, count);
+    #endif
+}
+
+int trap::VirtualFS::write(int fd, const unsigned char * buffer, unsigned int count){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    if(file->memFile){
+        if((file->flags & (O_WRONLY | O_RDWR)) == 0){
+            errno = EBADF;
+            return -1;
+        }
+        std::vector<unsigned char> & data = file->memFile->data;
+        if((file->flags & O_APPEND) != 0){
+            file->offset = data.size();
+        }
+        if(file->offset + count > data.size()){
+            data.resize(file->offset + count);
+        }
+        if(count > 0){
+            memcpy(&data[file->offset], buffer, count);
+        }
+        file->offset += count;
+        file->memFile->modTime = ::time(NULL);
+        return count;
+    }
+    if(file->buffered && this->bufferSize > 0){
+        if(this->pendingFile != NULL && this->pendingFile != file.get()){
+            this->flushFile(*this->pendingFile);
+        }
+        file->outBuffer.append((const char *)buffer, count);
+        this->pendingFile = file.get();
+        if(file->outBuffer.size() >= this->bufferSize){
+            this->flushFile(*file);
+        }
+        return count;
+    }
+    #ifdef __GNUC__
+    return ::write(file->hostFd, buffer, count);
+    #else
+    return ::_write(file->hostFd, buffer, count);
+    #endif
+}
+
+int trap::VirtualFS::lseek(int fd, int offset, int whence){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    if(file->memFile){
+        long newOffset = 0;
+        switch(whence){
+            case SEEK_SET:
+                newOffset = offset;
+            break;
+            case SEEK_CUR:
+                newOffset = (long)file->offset + offset;
+            break;
+            case SEEK_END:
+                newOffset = (long)file->memFile->data.size() + offset;
+            break;
+            default:
+                errno = EINVAL;
+                return -1;
+            break;
+        }
+        if(newOffset < 0){
+            errno = EINVAL;
+            return -1;
+        }
+        file->offset = newOffset;
+        return newOffset;
+    }
+    this->flushFile(*file);
+    #ifdef __GNUC__
+    return ::lseek(file->hostFd, offset, whence);
+    #else
+    return ::_lseek(file->hostFd, offset, whence);
+    #endif
+}
+
+int trap::VirtualFS::isatty(int fd){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return 0;
+    }
+    if(file->memFile){
+        errno = ENOTTY;
+        return 0;
+    }
+    #ifdef __GNUC__
+    return ::isatty(file->hostFd);
+    #else
+    return ::_isatty(file->hostFd);
+    #endif
+}
+
+int trap::VirtualFS::fstat(int fd, HostStat & buf){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    if(file->memFile){
+        fillMemoryStat(*file->memFile, buf);
+        return 0;
+    }
+    #ifdef __GNUC__
+    return ::fstat(file->hostFd, &buf);
+    #else
+    return ::_fstat(file->hostFd, &buf);
+    #endif
+}
+
+int trap::VirtualFS::stat(const std::string & pathname, HostStat & buf){
+    std::map<std::string, boost::shared_ptr<MemoryFile> >::iterator foundFile = this->files.find(pathname);
+    if(foundFile != this->files.end()){
+        fillMemoryStat(*foundFile->second, buf);
+        return 0;
+    }
+    #ifdef __GNUC__
+    return ::stat(pathname.c_str(), &buf);
+    #else
+    return ::_stat(pathname.c_str(), &buf);
+    #endif
+}
+
+int trap::VirtualFS::lstat(const std::string & pathname, HostStat & buf){
+    std::map<std::string, boost::shared_ptr<MemoryFile> >::iterator foundFile = this->files.find(pathname);
+    if(foundFile != this->files.end()){
+        fillMemoryStat(*foundFile->second, buf);
+        return 0;
+    }
+    #ifdef __GNUC__
+    return ::lstat(pathname.c_str(), &buf);
+    #else
+    return ::_lstat(pathname.c_str(), &buf);
+    #endif
+}
+
+int trap::VirtualFS::unlink(const std::string & pathname){
+    // Descriptors still referring to an unlinked in-memory file keep
+    // using its content, as it happens on the host
+    if(this->files.erase(pathname) > 0){
+        return 0;
+    }
+    #ifdef __GNUC__
+    return ::unlink(pathname.c_str());
+    #else
+    return ::_unlink(pathname.c_str());
+    #endif
+}
+
+int trap::VirtualFS::dup(int fd){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    return this->allocateFd(file);
+}
+
+int trap::VirtualFS::dup2(int fd, int newfd){
+    boost::shared_ptr<OpenFile> file = this->getFile(fd);
+    if(!file){
+        return -1;
+    }
+    if(newfd < 0 || newfd >= VFS_MAX_FDS){
+        errno = EBADF;
+        return -1;
+    }
+    if(newfd == fd){
+        return newfd;
+    }
+    if(newfd < (int)this->fdTable.size()){
+        if(this->fdTable[newfd]){
+            this->releaseFile(this->fdTable[newfd]);
+        }
+    }
+    else{
+        this->fdTable.resize(newfd + 1);
+    }
+    this->fdTable[newfd] = file;
+    return newfd;
+}
+
+void trap::VirtualFS::flush(){
+    if(this->pendingFile != NULL){
+        this->flushFile(*this->pendingFile);
+    }
+}
@@ -0,0 +1,143 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef VFS_HPP
+#define VFS_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace trap{
+
+#ifdef __GNUC__
+typedef struct stat HostStat;
+#else
+typedef struct _stat HostStat;
+#endif
+
+///File of the in-memory file tree
+struct MemoryFile{
+    std::vector<unsigned char> data;
+    int mode;
+    time_t modTime;
+};
+
+///Open file description, shared by all the guest descriptors obtained
+///through dup from the same open call; it refers either to a file of
+///the in-memory tree or to a host descriptor
+struct OpenFile{
+    boost::shared_ptr<MemoryFile> memFile;
+    int hostFd;
+    int flags;
+    unsigned int offset;
+    bool buffered;
+    std::string outBuffer;
+};
+
+///File system seen by the emulated application: the files listed in
+///the manifest are kept in memory and never reach the host, all the other
+///paths are passed through to the host file system. Each simulator owns its
+///descriptor table, so parallel simulations do not share host descriptors;
+///the guest standard output and error are buffered and written to the host
+///in large chunks. All methods return -1 and set errno on error, as the
+///corresponding host calls do
+class VirtualFS{
+  private:
+    std::map<std::string, boost::shared_ptr<MemoryFile> > files;
+    std::vector<boost::shared_ptr<OpenFile> > fdTable;
+    ///Buffered file holding output not yet written to the host; output is
+    ///flushed when switching to another buffered file, so that the host
+    ///receives it in the same order the application produced it
+    OpenFile * pendingFile;
+    unsigned int bufferSize;
+    bool memoryOnly;
+
+    boost::shared_ptr<OpenFile> getFile(int fd);
+    int allocateFd(boost::shared_ptr<OpenFile> file, unsigned int minFd = 0);
+    void flushFile(OpenFile & file);
+    int releaseFile(boost::shared_ptr<OpenFile> & file);
+    void initStdFiles();
+    void closeAll();
+  public:
+    VirtualFS();
+    ~VirtualFS();
+    ///Reads the manifest, where each line is "guestPath [hostPath]" (the host
+    ///path defaults to the guest one and lines starting with # are skipped),
+    ///and loads the content of the listed files in the in-memory tree
+    void loadManifest(const std::string & manifest);
+    ///Adds a file with the given content to the in-memory tree
+    void addFile(const std::string & path, const std::string & content);
+    ///When set, the files created by the application are kept in memory
+    ///instead of being created on the host
+    void setMemoryOnly(bool memoryOnly);
+    ///Sets the number of bytes accumulated for the guest standard output and
+    ///error before they are written to the host; 0 disables the buffering
+    void setBufferSize(unsigned int bufferSize);
+
+    int open(const std::string & pathname, int flags, int mode);
+    int close(int fd);
+    int read(int fd, unsigned char * buffer, unsigned int count);
+    int write(int fd, const unsigned char * buffer, unsigned int count);
+    int lseek(int fd, int offset, int whence);
+    int isatty(int fd);
+    int fstat(int fd, HostStat & buf);
+    int stat(const std::string & pathname, HostStat & buf);
+    int lstat(const std::string & pathname, HostStat & buf);
+    int unlink(const std::string & pathname);
+    int dup(int fd);
+    int dup2(int fd, int newfd);
+
+    ///Writes to the host all the buffered output
+    void flush();
+    ///Closes all the descriptors and empties the in-memory tree
+    void reset();
+};
+
+};
+
+#endif
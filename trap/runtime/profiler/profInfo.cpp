@@ -77,6 +77,24 @@ trap::ProfInstruction::ProfInstruction(){
     this->time = SC_ZERO_TIME;
 }
 
+///dump these information to a string, in the command separated values (CVS) format
+std::string trap::ProfInstructionPair::printCsv(){
+    std::string csvLine(this->first + ";" + this->second + ";");
+    csvLine += boost::lexical_cast<std::string>(this->numCalls) + ";";
+    double percCalls = ((double)this->numCalls*100)/ProfInstruction::numTotalCalls;
+    if(percCalls < 10e-3)
+        percCalls = 0;
+    csvLine += boost::lexical_cast<std::string>(percCalls);
+    return csvLine;
+}
+///Prints the description of the informations which describe a pair, in the command separated values (CVS) format
+std::string trap::ProfInstructionPair::printCsvHeader(){
+    return "first;second;numCalls;numCalls %";
+}
+///Empty constructor, performs the initialization of the statistics
+trap::ProfInstructionPair::ProfInstructionPair(){
+    this->numCalls = 1;
+}
 
 ///Total number of function calls
 unsigned long long trap::ProfFunction::numTotalCalls = 0;
@@ -69,6 +69,25 @@ struct ProfInstruction{
     ProfInstruction();
 };
 
+///Represents the number of times an assembly instruction
+///is immediately followed, at the next sequential address,
+///by another one; these statistics are used to choose the
+///sequences of instructions which are fused together
+struct ProfInstructionPair{
+    ///Name of the first assembly instruction of the pair
+    std::string first;
+    ///Name of the second assembly instruction of the pair
+    std::string second;
+    ///Number of times the pair is executed
+    unsigned long long numCalls;
+    ///dump these information to a string, in the command separated values (CVS) format
+    std::string printCsv();
+    ///Prints the description of the informations which describe a pair, in the command separated values (CVS) format
+    static std::string printCsvHeader();
+    ///Empty constructor, performs the initialization of the statistics
+    ProfInstructionPair();
+};
+
 ///Represents all the profiling data which can be
 ///associated with a single function
 struct ProfFunction{
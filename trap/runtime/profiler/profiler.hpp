@@ -84,6 +84,8 @@ namespace trap{
 
 /// Profiler: it keeps track of many runtime statistics on:
 /// - number and percentage of instructions executed of each type.
+/// - number of times each instruction is followed by another one at
+///   the next sequential address (used to select the superinstructions)
 /// - function stats: time and percentage in each function
 /// - call graph: time of each call.
 template<class issueWidth> class Profiler : public ToolsIf<issueWidth>{
@@ -98,6 +100,13 @@ template<class issueWidth> class Profiler : public ToolsIf<issueWidth>{
     ProfInstruction *oldInstruction;
     sc_time oldInstrTime;
     template_map<unsigned int, ProfInstruction>::iterator instructionsEnd;
+    //Statistic on the pairs of instructions executed one after the other,
+    //indexed by the id of the first and of the second instruction
+    template_map<unsigned int, template_map<unsigned int, ProfInstructionPair> > pairs;
+    unsigned int oldInstrId;
+    issueWidth oldInstrPC;
+    //size in bytes of the instructions, used to detect consecutive ones
+    unsigned int instrSize;
     //Statistic on the functions
     typename template_map<issueWidth, ProfFunction> functions;
     std::vector<ProfFunction *> currentStack;
@@ -136,6 +145,22 @@ template<class issueWidth> class Profiler : public ToolsIf<issueWidth>{
             this->oldInstruction = &(this->instructions[instrId]);
             this->instructionsEnd = this->instructions.end();
         }
+        //Update the statistics on the pair formed with the previous instruction,
+        //in case the two were executed at consecutive addresses
+        if(this->oldInstrId != (unsigned int)-1 && curPC == this->oldInstrPC + this->instrSize){
+            template_map<unsigned int, ProfInstructionPair> &successors = this->pairs[this->oldInstrId];
+            template_map<unsigned int, ProfInstructionPair>::iterator foundPair = successors.find(instrId);
+            if(foundPair != successors.end()){
+                foundPair->second.numCalls++;
+            }
+            else{
+                ProfInstructionPair &newPair = successors[instrId];
+                newPair.first = this->instructions[this->oldInstrId].name;
+                newPair.second = this->instructions[instrId].name;
+            }
+        }
+        this->oldInstrId = instrId;
+        this->oldInstrPC = curPC;
     }
     ///Based on the new instruction just issued, the statistics on the functions
     ///are updated
@@ -265,12 +290,15 @@ template<class issueWidth> class Profiler : public ToolsIf<issueWidth>{
         //this->prevPC = curPC;
     }
   public:
-    Profiler(ABIIf<issueWidth> &processorInstance, std::string execName, bool disableFunctionProfiling) :
+    Profiler(ABIIf<issueWidth> &processorInstance, std::string execName, bool disableFunctionProfiling, unsigned int instrSize = sizeof(issueWidth)) :
                 processorInstance(processorInstance), disableFunctionProfiling(disableFunctionProfiling),
                                                             elfInstance(ELFFrontend::getInstance(execName)){
         this->oldInstruction = NULL;
         this->oldInstrTime = SC_ZERO_TIME;
         this->instructionsEnd = this->instructions.end();
+        this->oldInstrId = (unsigned int)-1;
+        this->oldInstrPC = 0;
+        this->instrSize = instrSize;
         this->oldFunTime = SC_ZERO_TIME;
         this->functionsEnd = this->functions.end();
         this->oldFunInstructions = 0;
@@ -287,7 +315,8 @@ template<class issueWidth> class Profiler : public ToolsIf<issueWidth>{
     void printCsvStats(std::string fileName){
         //I simply have to iterate over the encountered functions and instructions
         //and print the relative statistics.
-        //two files will be created: fileName_fun.csv and fileName_instr.csv
+        //three files will be created: fileName_fun.csv, fileName_instr.csv
+        //and fileName_pairs.csv
         std::ofstream instructionFile((fileName + "_instr.csv").c_str());
         instructionFile << ProfInstruction::printCsvHeader() << std::endl;
         template_map<unsigned int, ProfInstruction>::iterator instrIter, instrEnd;
@@ -297,6 +326,17 @@ template<class issueWidth> class Profiler : public ToolsIf<issueWidth>{
         instructionFile << ProfInstruction::printCsvSummary() << std::endl;
         instructionFile.close();
 
+        std::ofstream pairFile((fileName + "_pairs.csv").c_str());
+        pairFile << ProfInstructionPair::printCsvHeader() << std::endl;
+        template_map<unsigned int, template_map<unsigned int, ProfInstructionPair> >::iterator firstIter, firstEnd;
+        for(firstIter = this->pairs.begin(), firstEnd = this->pairs.end(); firstIter != firstEnd; firstIter++){
+            template_map<unsigned int, ProfInstructionPair>::iterator pairIter, pairEnd;
+            for(pairIter = firstIter->second.begin(), pairEnd = firstIter->second.end(); pairIter != pairEnd; pairIter++){
+                pairFile << pairIter->second.printCsv() << std::endl;
+            }
+        }
+        pairFile.close();
+
         if(!this->disableFunctionProfiling){
             std::ofstream functionFile((fileName + "_fun.csv").c_str());
             functionFile << ProfFunction::printCsvHeader() << std::endl;
@@ -0,0 +1,153 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "codePages.hpp"
+#include "pendingEvents.hpp"
+
+using namespace trap;
+
+void codePagesNotify(){
+    CodePages<unsigned int> codePages;
+    unsigned int pendingEvents = 0;
+    codePages.setPendingEvents(&pendingEvents);
+    // Writes to pages without cached instructions are ignored
+    codePages.notifyWrite(0x1000, 4);
+    BOOST_CHECK(!codePages.isModified(0x1000));
+    BOOST_CHECK(codePages.getModifiedPages().empty());
+    BOOST_CHECK_EQUAL(pendingEvents, 0u);
+    codePages.markCode(0x1004);
+    codePages.notifyWrite(0x1ffc, 4);
+    BOOST_CHECK(codePages.isModified(0x1000));
+    BOOST_CHECK(!codePages.isModified(0x2000));
+    BOOST_REQUIRE_EQUAL(codePages.getModifiedPages().size(), 1u);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages()[0], 0x1u);
+    BOOST_CHECK(pendingEvents & PENDING_CODE_WRITE);
+    // A page is reported once, however many times it is written
+    codePages.notifyWrite(0x1000, 1);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages().size(), 1u);
+}
+
+void codePagesMarkRange(){
+    CodePages<unsigned int> codePages;
+    // [start, end) covers the pages from the one of start to the one of end - 1
+    codePages.markCode(0x1ffc, 0x3000);
+    codePages.notifyWrite(0x0ffc, 4);
+    codePages.notifyWrite(0x3000, 4);
+    BOOST_CHECK(codePages.getModifiedPages().empty());
+    codePages.notifyWrite(0x2000, 4);
+    codePages.notifyWrite(0x1000, 4);
+    BOOST_REQUIRE_EQUAL(codePages.getModifiedPages().size(), 2u);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages()[0], 0x2u);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages()[1], 0x1u);
+    // An empty range marks nothing
+    codePages.markCode(0x5000, 0x5000);
+    codePages.notifyWrite(0x5000, 4);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages().size(), 2u);
+}
+
+void codePagesClear(){
+    CodePages<unsigned int> codePages;
+    unsigned int pendingEvents = PENDING_CODE_WRITE | PENDING_IRQ;
+    codePages.setPendingEvents(&pendingEvents);
+    codePages.markCode(0x1000);
+    codePages.notifyWrite(0x1000, 4);
+    BOOST_CHECK(codePages.isModified(0x1000));
+    codePages.clearModified();
+    BOOST_CHECK(!codePages.isModified(0x1000));
+    BOOST_CHECK(codePages.getModifiedPages().empty());
+    BOOST_CHECK_EQUAL(pendingEvents, (unsigned int)PENDING_IRQ);
+    // The page does not hold cached instructions any more until it is marked again
+    codePages.notifyWrite(0x1000, 4);
+    BOOST_CHECK(codePages.getModifiedPages().empty());
+    codePages.markCode(0x1000);
+    codePages.notifyWrite(0x1000, 4);
+    BOOST_CHECK(codePages.isModified(0x1000));
+}
+
+void codePagesWrap(){
+    CodePages<unsigned int> codePages;
+    // Ranges and writes crossing the end of the address space continue from page 0
+    codePages.markCode(0xfffff000u, 0x1000u);
+    codePages.notifyWrite(0xfffffffeu, 4);
+    BOOST_CHECK(codePages.isModified(0xfffff000u));
+    BOOST_CHECK(codePages.isModified(0x0));
+    BOOST_CHECK(!codePages.isModified(0x1000));
+    BOOST_REQUIRE_EQUAL(codePages.getModifiedPages().size(), 2u);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages()[0], 0xfffffu);
+    BOOST_CHECK_EQUAL(codePages.getModifiedPages()[1], 0x0u);
+}
+
+void codePagesCachedInstrs(){
+    CodePages<unsigned int> codePages;
+    BOOST_CHECK(codePages.getCachedInstrs(0x1) == NULL);
+    codePages.addCachedInstr(0x1000);
+    codePages.addCachedInstr(0x1004);
+    // A superinstruction at 0x1ffc whose components reach the next page
+    codePages.addCachedInstr(0x1ffc);
+    codePages.addCachedInstr(0x1ffc, 0x2000, 0x2008);
+    const std::vector<unsigned int> * cachedInstrs = codePages.getCachedInstrs(0x1);
+    BOOST_REQUIRE(cachedInstrs != NULL);
+    BOOST_REQUIRE_EQUAL(cachedInstrs->size(), 3u);
+    BOOST_CHECK_EQUAL((*cachedInstrs)[0], 0x1000u);
+    BOOST_CHECK_EQUAL((*cachedInstrs)[2], 0x1ffcu);
+    cachedInstrs = codePages.getCachedInstrs(0x2);
+    BOOST_REQUIRE(cachedInstrs != NULL);
+    BOOST_REQUIRE_EQUAL(cachedInstrs->size(), 1u);
+    BOOST_CHECK_EQUAL((*cachedInstrs)[0], 0x1ffcu);
+    // The instructions of the page holding the superinstruction components are tracked
+    codePages.notifyWrite(0x2004, 4);
+    BOOST_CHECK(codePages.isModified(0x2000));
+    // Only the lists of the modified pages are dropped once they are cleared
+    codePages.clearModified();
+    BOOST_CHECK(codePages.getCachedInstrs(0x2) == NULL);
+    BOOST_CHECK(codePages.getCachedInstrs(0x1) != NULL);
+    codePages.clearCachedInstrs();
+    BOOST_CHECK(codePages.getCachedInstrs(0x1) == NULL);
+    // The pages keep holding code after the lists are dropped
+    codePages.notifyWrite(0x1000, 4);
+    BOOST_CHECK(codePages.isModified(0x1000));
+}
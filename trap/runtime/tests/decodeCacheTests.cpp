@@ -0,0 +1,109 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "decodeCache.hpp"
+
+using namespace trap;
+
+static const char * decodeCacheFile = "decodeCacheTests.dec";
+
+static DecodeCache makeDecodeCache(){
+    DecodeCache cache;
+    // Values of different lengths, up to the maximum stored by a varint
+    unsigned long long keys[] = {0x0, 0x7f, 0x80, 0x12345678, 0xffffffffffffffffULL};
+    for(unsigned int i = 0; i < sizeof(keys)/sizeof(keys[0]); i++){
+        DecodeCacheEntry entry;
+        entry.key = keys[i];
+        entry.instrId = i*100;
+        entry.word = ~keys[i];
+        cache.entries.push_back(entry);
+    }
+    return cache;
+}
+
+void decodeCacheRoundTrip(){
+    DecodeCache saved = makeDecodeCache();
+    saved.save(decodeCacheFile, "model_signature");
+    DecodeCache loaded;
+    BOOST_CHECK(loaded.load(decodeCacheFile, "model_signature"));
+    BOOST_REQUIRE_EQUAL(loaded.entries.size(), saved.entries.size());
+    for(unsigned int i = 0; i < saved.entries.size(); i++){
+        BOOST_CHECK_EQUAL(loaded.entries[i].key, saved.entries[i].key);
+        BOOST_CHECK_EQUAL(loaded.entries[i].instrId, saved.entries[i].instrId);
+        BOOST_CHECK_EQUAL(loaded.entries[i].word, saved.entries[i].word);
+    }
+    // The instructions decoded by another model are not restored
+    BOOST_CHECK(!loaded.load(decodeCacheFile, "other_signature"));
+    BOOST_CHECK(loaded.entries.empty());
+    BOOST_CHECK(!loaded.load("missingDecodeCache.dec", "model_signature"));
+    std::remove(decodeCacheFile);
+}
+
+void decodeCacheTruncated(){
+    makeDecodeCache().save(decodeCacheFile, "model_signature");
+    std::string content;
+    {
+        std::ifstream file(decodeCacheFile, std::ios::in | std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    BOOST_REQUIRE(!content.empty());
+    // Whatever the point where the file is cut, nothing is loaded
+    for(unsigned int length = 0; length < content.size(); length++){
+        {
+            std::ofstream file(decodeCacheFile, std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(content.c_str(), length);
+        }
+        DecodeCache loaded;
+        BOOST_CHECK_MESSAGE(!loaded.load(decodeCacheFile, "model_signature"), "file truncated at " << length << " bytes loaded");
+        BOOST_CHECK(loaded.entries.empty());
+    }
+    std::remove(decodeCacheFile);
+}
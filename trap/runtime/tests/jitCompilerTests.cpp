@@ -0,0 +1,77 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+
+#include <boost/test/unit_test.hpp>
+
+#include "jitCompiler.hpp"
+
+using namespace trap;
+
+namespace{
+    struct JitTestProcessor{};
+};
+
+void jitRequestAfterInvalidate(){
+    JitCompiler<JitTestProcessor, unsigned int> jit;
+    jit.setCompiler("false", ".");
+    jit.setRegionSize(0x100);
+    jit.setThreshold(3);
+    // The region is requested once, when it becomes hot
+    BOOST_CHECK(!jit.profile(0x1000));
+    BOOST_CHECK(!jit.profile(0x1004));
+    BOOST_CHECK(jit.profile(0x1008));
+    for(unsigned int i = 0; i < 10; i++){
+        BOOST_CHECK(!jit.profile(0x100c));
+    }
+    // Invalidating another region changes nothing
+    jit.invalidate(0x2000, 0x3000);
+    for(unsigned int i = 0; i < 10; i++){
+        BOOST_CHECK(!jit.profile(0x1010));
+    }
+    // Once its code is modified the region is requested again when it becomes hot
+    jit.invalidate(0x1000, 0x2000);
+    BOOST_CHECK(!jit.profile(0x1000));
+    BOOST_CHECK(!jit.profile(0x1004));
+    BOOST_CHECK(jit.profile(0x1008));
+    BOOST_CHECK(!jit.profile(0x100c));
+}
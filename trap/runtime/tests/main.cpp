@@ -0,0 +1,75 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+// Unit tests of the components of the TRAP runtime library: each file of
+// this folder contains the tests of one component, which are registered
+// in the test suite here; the main routine is the one of the boost
+// unit test framework
+
+#include <boost/test/included/unit_test.hpp>
+
+void vfsOpenReadClose();
+void vfsFdReuse();
+void vfsStdRedirect();
+void codePagesNotify();
+void codePagesMarkRange();
+void codePagesClear();
+void codePagesWrap();
+void codePagesCachedInstrs();
+void decodeCacheRoundTrip();
+void decodeCacheTruncated();
+void jitRequestAfterInvalidate();
+
+boost::unit_test::test_suite * init_unit_test_suite(int argc, char * argv[]){
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&vfsOpenReadClose));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&vfsFdReuse));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&vfsStdRedirect));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&codePagesNotify));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&codePagesMarkRange));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&codePagesClear));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&codePagesWrap));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&codePagesCachedInstrs));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&decodeCacheRoundTrip));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&decodeCacheTruncated));
+    boost::unit_test::framework::master_test_suite().add(BOOST_TEST_CASE(&jitRequestAfterInvalidate));
+    return 0;
+}
@@ -0,0 +1,105 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <cerrno>
+#include <fcntl.h>
+
+#include "vfs.hpp"
+
+using namespace trap;
+
+void vfsOpenReadClose(){
+    VirtualFS vfs;
+    vfs.addFile("/input.txt", "hello world");
+    int fd = vfs.open("/input.txt", O_RDONLY, 0);
+    BOOST_REQUIRE(fd > 2);
+    unsigned char buffer[16];
+    BOOST_CHECK_EQUAL(vfs.read(fd, buffer, 5), 5);
+    BOOST_CHECK_EQUAL(std::string((char *)buffer, 5), "hello");
+    BOOST_CHECK_EQUAL(vfs.read(fd, buffer, sizeof(buffer)), 6);
+    BOOST_CHECK_EQUAL(std::string((char *)buffer, 6), " world");
+    BOOST_CHECK_EQUAL(vfs.read(fd, buffer, sizeof(buffer)), 0);
+    BOOST_CHECK_EQUAL(vfs.close(fd), 0);
+    BOOST_CHECK_EQUAL(vfs.close(fd), -1);
+    BOOST_CHECK_EQUAL(errno, EBADF);
+    BOOST_CHECK_EQUAL(vfs.read(fd, buffer, 1), -1);
+}
+
+void vfsFdReuse(){
+    VirtualFS vfs;
+    vfs.addFile("/a", "a");
+    vfs.addFile("/b", "b");
+    int fdA = vfs.open("/a", O_RDONLY, 0);
+    int fdB = vfs.open("/b", O_RDONLY, 0);
+    BOOST_REQUIRE(fdA >= 0 && fdB >= 0);
+    BOOST_CHECK(fdA != fdB);
+    BOOST_CHECK_EQUAL(vfs.close(fdA), 0);
+    // The lowest free descriptor is returned, as on the host
+    BOOST_CHECK_EQUAL(vfs.open("/b", O_RDONLY, 0), fdA);
+    // A duplicated descriptor keeps the file open after closing the original one
+    int fdDup = vfs.dup(fdB);
+    BOOST_REQUIRE(fdDup >= 0);
+    BOOST_CHECK_EQUAL(vfs.close(fdB), 0);
+    unsigned char datum = 0;
+    BOOST_CHECK_EQUAL(vfs.read(fdDup, &datum, 1), 1);
+    BOOST_CHECK_EQUAL(datum, 'b');
+    BOOST_CHECK_EQUAL(vfs.open("/missing", O_RDONLY, 0), -1);
+}
+
+void vfsStdRedirect(){
+    VirtualFS vfs;
+    vfs.setMemoryOnly(true);
+    // close(1); open(...) redirects the standard output
+    BOOST_CHECK_EQUAL(vfs.close(1), 0);
+    BOOST_CHECK_EQUAL(vfs.open("/output.txt", O_CREAT | O_WRONLY | O_TRUNC, 0644), 1);
+    const unsigned char message[] = "redirected";
+    BOOST_CHECK_EQUAL(vfs.write(1, message, 10), 10);
+    BOOST_CHECK_EQUAL(vfs.close(1), 0);
+    int fd = vfs.open("/output.txt", O_RDONLY, 0);
+    BOOST_REQUIRE(fd >= 0);
+    unsigned char buffer[16];
+    BOOST_CHECK_EQUAL(vfs.read(fd, buffer, sizeof(buffer)), 10);
+    BOOST_CHECK_EQUAL(std::string((char *)buffer, 10), "redirected");
+}
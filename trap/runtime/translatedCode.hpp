@@ -0,0 +1,191 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef TRANSLATEDCODE_HPP
+#define TRANSLATEDCODE_HPP
+
+#ifdef __GNUC__
+#ifdef __GNUC_MINOR__
+#if (__GNUC__ >= 4 && __GNUC_MINOR__ >= 3)
+#include <tr1/unordered_map>
+#define template_map std::tr1::unordered_map
+#else
+#include <ext/hash_map>
+#define  template_map __gnu_cxx::hash_map
+#endif
+#else
+#include <ext/hash_map>
+#define  template_map __gnu_cxx::hash_map
+#endif
+#else
+#ifdef _WIN32
+#include <hash_map>
+#define  template_map stdext::hash_map
+#else
+#include <map>
+#define  template_map std::map
+#endif
+#endif
+
+#include <cstdlib>
+
+#include "trap_utils.hpp"
+#include "codePages.hpp"
+#include "ToolsIf.hpp"
+
+namespace trap{
+
+///Native code translated ahead of time from the application being simulated.
+///The code is split in regions of consecutive instructions, all of the same
+///size and aligned to it: each region is a function which executes the
+///instructions starting from the current PC for as long as the control flow
+///remains inside the region, returning to the interpreter as soon as it
+///leaves it. Regions containing instructions watched by a tool are
+///interpreted, so that the tools are called as usual
+template<class issueWidth> class TranslatedCode{
+  public:
+    ///Executes the instructions of a region starting from the current PC,
+    ///until the control flow leaves the region or maxInstructions instructions
+    ///are executed; numInstructions is incremented for each executed instruction.
+    ///Returns the number of cycles spent by the instructions
+    typedef unsigned int (*RegionFunction)(unsigned int & numInstructions, unsigned int maxInstructions);
+
+  private:
+    struct Region{
+        RegionFunction function;
+        ///Number of tools present when the region was last checked against them
+        int checkedTools;
+        bool enabled;
+    };
+    template_map<issueWidth, Region> regions;
+    typename template_map<issueWidth, Region>::iterator regionsEnd;
+    issueWidth regionSize;
+    const ToolsManager<issueWidth> * toolManager;
+    CodePages<issueWidth> * codePages;
+    unsigned int maxInstructions;
+
+  public:
+    TranslatedCode() : regionSize(0), toolManager(NULL), codePages(NULL), maxInstructions(256){
+        this->regionsEnd = this->regions.end();
+    }
+    void setToolsManager(const ToolsManager<issueWidth> & toolManager){
+        this->toolManager = &toolManager;
+    }
+    ///Sets the pages tracker which is told about the pages holding translated
+    ///regions, so that the processor invalidates them when they are overwritten
+    void setCodePages(CodePages<issueWidth> & codePages){
+        this->codePages = &codePages;
+    }
+    ///Sets the maximum number of instructions executed by a region before
+    ///giving control back to the processor (e.g. for interrupts to be checked)
+    void setMaxInstructions(unsigned int maxInstructions){
+        this->maxInstructions = maxInstructions;
+    }
+    ///Adds a region of translated code; the size of the regions has to be a
+    ///power of two, the same for all of them, and regions have to be aligned to it
+    void addRegion(const issueWidth & start, const issueWidth & size, RegionFunction function){
+        if(size == 0 || (size & (size - 1)) != 0 || (start & (size - 1)) != 0){
+            THROW_EXCEPTION("Error, translated region at address " << std::hex << std::showbase << start << " of size " << size << " is not aligned to a power of two");
+        }
+        if(this->regionSize != 0 && this->regionSize != size){
+            THROW_EXCEPTION("Error, translated regions of different sizes " << std::hex << std::showbase << this->regionSize << " and " << size);
+        }
+        this->regionSize = size;
+        Region region;
+        region.function = function;
+        region.checkedTools = -1;
+        region.enabled = true;
+        this->regions[start] = region;
+        this->regionsEnd = this->regions.end();
+        if(this->codePages != NULL){
+            this->codePages->markCode(start, start + size);
+        }
+    }
+    ///Removes the regions overlapping [start, end), whose instructions are
+    ///interpreted from now on (e.g. since they were modified)
+    void invalidate(const issueWidth & start, const issueWidth & end){
+        if(this->regions.empty()){
+            return;
+        }
+        for(issueWidth curRegion = start & ~(this->regionSize - 1); curRegion < end; curRegion += this->regionSize){
+            this->regions.erase(curRegion);
+            if(curRegion + this->regionSize < curRegion){
+                break;
+            }
+        }
+        this->regionsEnd = this->regions.end();
+    }
+    unsigned int getNumRegions() const{
+        return this->regions.size();
+    }
+    ///Returns the size of the regions, 0 if no region was added yet
+    issueWidth getRegionSize() const{
+        return this->regionSize;
+    }
+
+    ///Executes the translated code starting from curPC, if any. numInstructions
+    ///is set to the number of executed instructions, 0 if the instruction at
+    ///curPC has to be interpreted; returns the number of cycles spent
+    inline unsigned int execute(const issueWidth & curPC, unsigned int & numInstructions){
+        numInstructions = 0;
+        if(this->regionSize == 0){
+            return 0;
+        }
+        typename template_map<issueWidth, Region>::iterator foundRegion = this->regions.find(curPC & ~(this->regionSize - 1));
+        if(foundRegion == this->regionsEnd){
+            return 0;
+        }
+        Region & region = foundRegion->second;
+        if(this->toolManager != NULL && region.checkedTools != this->toolManager->getNumTools()){
+            region.enabled = !this->toolManager->watchesRange(foundRegion->first, foundRegion->first + this->regionSize);
+            region.checkedTools = this->toolManager->getNumTools();
+        }
+        if(!region.enabled){
+            return 0;
+        }
+        return region.function(numInstructions, this->maxInstructions);
+    }
+};
+
+};
+
+#endif
@@ -0,0 +1,256 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#include "trap_utils.hpp"
+#include "perfCounters.hpp"
+#include "hostCounters.hpp"
+
+namespace trap{
+
+///Result of a single benchmark
+struct BenchmarkResult{
+    std::string name;
+    double value;
+    std::string unit;
+    ///True for throughputs (e.g. MIPS), false for times
+    bool higherIsBetter;
+    ///False for the figures which only help explaining the other ones (e.g. the host
+    ///miss rates): their changes are shown, but never reported as regressions
+    bool checked;
+    BenchmarkResult(const std::string & name = "", double value = 0, const std::string & unit = "", bool higherIsBetter = false, bool checked = true) :
+                        name(name), value(value), unit(unit), higherIsBetter(higherIsBetter), checked(checked){}
+};
+
+///Collection of the results of the benchmarks; results are saved into, and compared
+///with, baseline files containing one "name;value;unit;higher|lower;checked|unchecked"
+///line per benchmark; the lines lacking the last field, written by older versions,
+///are read as checked
+class BenchmarkSuite{
+  private:
+    std::vector<BenchmarkResult> results;
+    ///Minimum host time, in seconds, over which each microbenchmark is measured
+    double minTime;
+    ///Accumulator which the microbenchmarks update so that the compiler
+    ///does not optimize away the measured code
+    volatile unsigned int sinkValue;
+
+  public:
+    BenchmarkSuite(double minTime = 0.2) : minTime(minTime), sinkValue(0){}
+    double getMinTime() const{
+        return this->minTime;
+    }
+    inline void sink(unsigned int value){
+        this->sinkValue += value;
+    }
+    void addResult(const BenchmarkResult & result){
+        this->results.push_back(result);
+        std::cout << result.name << ": " << result.value << " " << result.unit << std::endl;
+    }
+    const std::vector<BenchmarkResult> & getResults() const{
+        return this->results;
+    }
+
+    ///Runs the simulator on the given application and records its execution speed,
+    ///as printed by the simulator itself; returns false if the application fails.
+    ///When the host counters are given, the IPC of the host and its misses per
+    ///thousand instructions during the run are recorded too
+    bool runSimulator(const std::string & simulator, const std::string & application, HostCounters * hostCounters = NULL){
+        std::string command = simulator + " -a " + application + " 2>&1";
+        if(hostCounters != NULL){
+            hostCounters->start();
+        }
+        FILE * simOut = popen(command.c_str(), "r");
+        if(simOut == NULL){
+            std::cerr << "Unable to execute the simulator " << simulator << std::endl;
+            return false;
+        }
+        double speed = -1;
+        bool exitOk = false;
+        char line[512];
+        while(fgets(line, sizeof(line), simOut) != NULL){
+            std::string curLine(line);
+            if(curLine.find("Program exited with value 0") != std::string::npos){
+                exitOk = true;
+            }
+            std::string::size_type speedPos = curLine.find("Execution Speed: ");
+            if(speedPos != std::string::npos){
+                std::istringstream speedStream(curLine.substr(speedPos + 17));
+                speedStream >> speed;
+            }
+        }
+        pclose(simOut);
+        if(hostCounters != NULL){
+            hostCounters->stop();
+        }
+        if(!exitOk || speed < 0){
+            std::cerr << "Application " << application << " failed" << std::endl;
+            return false;
+        }
+        std::string name = application.substr(application.find_last_of("/\\") + 1);
+        this->addResult(BenchmarkResult("e2e_" + name, speed, "MIPS", true));
+        if(hostCounters != NULL && hostCounters->isSupported()){
+            double instructions = hostCounters->read(HOST_INSTRUCTIONS);
+            double cycles = hostCounters->read(HOST_CYCLES);
+            if(instructions > 0 && cycles > 0){
+                this->addResult(BenchmarkResult("e2e_" + name + "_ipc", instructions/cycles, "IPC", true, false));
+                static const HostEvent missEvents[] = {HOST_BRANCH_MISSES, HOST_L1I_MISSES, HOST_L1D_MISSES, HOST_LLC_MISSES};
+                static const char * missNames[] = {"branch", "l1i", "l1d", "llc"};
+                for(unsigned int i = 0; i < sizeof(missEvents)/sizeof(missEvents[0]); i++){
+                    if(hostCounters->isAvailable(missEvents[i])){
+                        this->addResult(BenchmarkResult("e2e_" + name + "_" + missNames[i] + "_mpki", hostCounters->read(missEvents[i])*1000/instructions, "MPKI", false, false));
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    void writeBaseline(const std::string & fileName) const{
+        std::ofstream baselineFile(fileName.c_str());
+        if(!baselineFile.good()){
+            THROW_EXCEPTION("Unable to open the baseline file " << fileName);
+        }
+        std::vector<BenchmarkResult>::const_iterator resIter, resEnd;
+        for(resIter = this->results.begin(), resEnd = this->results.end(); resIter != resEnd; resIter++){
+            baselineFile << resIter->name << ";" << resIter->value << ";" << resIter->unit << ";" << (resIter->higherIsBetter ? "higher" : "lower") << ";" << (resIter->checked ? "checked" : "unchecked") << std::endl;
+        }
+    }
+    static std::map<std::string, BenchmarkResult> readBaseline(const std::string & fileName){
+        std::ifstream baselineFile(fileName.c_str());
+        if(!baselineFile.good()){
+            THROW_EXCEPTION("Unable to open the baseline file " << fileName);
+        }
+        std::map<std::string, BenchmarkResult> baseline;
+        std::string line;
+        while(std::getline(baselineFile, line)){
+            std::vector<std::string> fields;
+            std::string::size_type start = 0, end;
+            while((end = line.find(';', start)) != std::string::npos){
+                fields.push_back(line.substr(start, end - start));
+                start = end + 1;
+            }
+            fields.push_back(line.substr(start));
+            if(fields.size() != 4 && fields.size() != 5){
+                continue;
+            }
+            std::istringstream valueStream(fields[1]);
+            double value = 0;
+            valueStream >> value;
+            baseline[fields[0]] = BenchmarkResult(fields[0], value, fields[2], fields[3] == "higher", fields.size() == 4 || fields[4] != "unchecked");
+        }
+        return baseline;
+    }
+    ///Compares the results with the ones of the baseline, printing the differences;
+    ///returns the number of benchmarks which are worse than the baseline by more
+    ///than threshold percent; only the benchmarks checked both in the baseline and
+    ///in this run are reported as regressions
+    unsigned int compare(const std::string & fileName, double threshold, std::ostream & stream = std::cout) const{
+        std::map<std::string, BenchmarkResult> baseline = BenchmarkSuite::readBaseline(fileName);
+        unsigned int numRegressions = 0;
+        std::vector<BenchmarkResult>::const_iterator resIter, resEnd;
+        for(resIter = this->results.begin(), resEnd = this->results.end(); resIter != resEnd; resIter++){
+            std::map<std::string, BenchmarkResult>::const_iterator baseIter = baseline.find(resIter->name);
+            if(baseIter == baseline.end() || baseIter->second.value == 0){
+                stream << resIter->name << ": not in the baseline" << std::endl;
+                continue;
+            }
+            // Positive changes are improvements, negative ones regressions
+            double change = (resIter->value - baseIter->second.value)*100/baseIter->second.value;
+            if(!resIter->higherIsBetter){
+                change = -change;
+            }
+            stream << resIter->name << ": " << baseIter->second.value << " -> " << resIter->value << " " << resIter->unit << " (" << (change >= 0 ? "+" : "") << change << "%)";
+            if(resIter->checked && baseIter->second.checked && change < -threshold){
+                stream << " REGRESSION";
+                numRegressions++;
+            }
+            stream << std::endl;
+        }
+        return numRegressions;
+    }
+};
+
+///Measures a microbenchmark, executing batches of doubling size until a batch lasts
+///at least the minimum time of the suite; the time per iteration of the last batch is
+///recorded. It is used as:
+///for(unsigned int n = loop.next(); n > 0; n = loop.next()){ ... n iterations ... }
+class BenchmarkLoop{
+  private:
+    BenchmarkSuite & suite;
+    std::string name;
+    unsigned int iterations;
+    double startTime;
+
+  public:
+    BenchmarkLoop(BenchmarkSuite & suite, const std::string & name) : suite(suite), name(name), iterations(0), startTime(0){}
+    ///Returns the number of iterations of the next batch, 0 when the measure is complete
+    unsigned int next(){
+        if(this->iterations > 0){
+            double elapsed = PerfCounters::hostTime() - this->startTime;
+            if(elapsed >= this->suite.getMinTime() || this->iterations >= 0x80000000U){
+                this->suite.addResult(BenchmarkResult(this->name, elapsed*1e9/this->iterations, "ns/op", false));
+                return 0;
+            }
+            this->iterations *= 2;
+        }
+        else{
+            this->iterations = 16;
+        }
+        this->startTime = PerfCounters::hostTime();
+        return this->iterations;
+    }
+};
+
+};
+
+#endif
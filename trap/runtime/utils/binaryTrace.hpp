@@ -0,0 +1,392 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef BINARYTRACE_HPP
+#define BINARYTRACE_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <cstring>
+
+#include <boost/lexical_cast.hpp>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "trap_utils.hpp"
+
+///Binary format of the instruction traces. The file starts with the magic
+///string, followed by the format version and by the tables of the register
+///and instruction names (all the numbers are stored as LEB128 varints).
+///The rest of the file is a sequence of blocks, each one made of a byte with
+///the block encoding, the raw and the stored size (4 little endian bytes each)
+///and of the stored data, compressed with zlib when available.
+///Once decompressed, each block contains a sequence of records:
+/// - zigzag encoded difference between the PC and the PC of the previous record
+/// - instruction id, shifted left by one; the lowest bit is set for annulled instructions
+/// - number of registers whose value changed since the previous record
+/// - for each changed register, in increasing order, the difference with the
+///   previous register index and the new value XOR the old one
+///Registers start from 0, so the first record contains all the non-zero registers.
+///Records never span two blocks.
+
+namespace trap{
+
+static const char BINARY_TRACE_MAGIC[8] = {'T', 'R', 'A', 'P', 'T', 'R', 'C', '\0'};
+static const unsigned int BINARY_TRACE_VERSION = 1;
+
+enum TraceBlockEncoding{TRACE_BLOCK_RAW = 0, TRACE_BLOCK_ZLIB};
+
+///A decoded trace record
+struct TraceRecord{
+    unsigned long long pc;
+    unsigned int instrId;
+    ///True if the instruction was annulled
+    bool skipped;
+    ///Registers whose value was changed by the instruction, with their new value
+    std::vector<std::pair<unsigned int, unsigned long long> > regs;
+};
+
+class BinaryTraceWriter{
+  private:
+    std::ofstream traceFile;
+    ///Encoded records of the current block
+    std::vector<unsigned char> buffer;
+    std::vector<unsigned char> compressed;
+    ///Register values as of the last record
+    std::vector<unsigned long long> lastValues;
+    ///Registers changed by the current record: index and value XOR the old one
+    std::vector<std::pair<unsigned int, unsigned long long> > changedRegs;
+    unsigned long long lastPC;
+    unsigned long long curPC;
+    unsigned int curInstrId;
+    unsigned int blockSize;
+    unsigned long long numRecords;
+
+    inline void putVarint(std::vector<unsigned char> & data, unsigned long long value){
+        while(value >= 0x80){
+            data.push_back((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        data.push_back((unsigned char)value);
+    }
+    void putWord(unsigned int value){
+        for(int i = 0; i < 4; i++){
+            this->traceFile.put((char)((value >> (8*i)) & 0xFF));
+        }
+    }
+    void writeBlock(){
+        if(this->buffer.empty()){
+            return;
+        }
+        unsigned char encoding = TRACE_BLOCK_RAW;
+        const unsigned char * data = &this->buffer[0];
+        unsigned int storedSize = this->buffer.size();
+        #ifdef HAVE_ZLIB
+        uLongf compressedSize = compressBound(this->buffer.size());
+        this->compressed.resize(compressedSize);
+        if(compress2(&this->compressed[0], &compressedSize, &this->buffer[0], this->buffer.size(), Z_BEST_SPEED) == Z_OK && compressedSize < this->buffer.size()){
+            encoding = TRACE_BLOCK_ZLIB;
+            data = &this->compressed[0];
+            storedSize = compressedSize;
+        }
+        #endif
+        this->traceFile.put((char)encoding);
+        this->putWord(this->buffer.size());
+        this->putWord(storedSize);
+        this->traceFile.write((const char *)data, storedSize);
+        this->buffer.clear();
+    }
+
+  public:
+    BinaryTraceWriter(unsigned int blockSize = 256*1024) : lastPC(0), curPC(0), curInstrId(0), blockSize(blockSize), numRecords(0){}
+    ~BinaryTraceWriter(){
+        this->close();
+    }
+
+    ///Opens the trace file and writes the header containing the names of the
+    ///traced registers and of the instructions
+    void open(const std::string & fileName, const std::vector<std::string> & regNames, const std::vector<std::string> & instrNames){
+        this->close();
+        this->traceFile.open(fileName.c_str(), std::ios::out | std::ios::binary);
+        if(!this->traceFile.good()){
+            THROW_EXCEPTION("Error in opening binary trace file " << fileName);
+        }
+        std::vector<unsigned char> header(BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC + sizeof(BINARY_TRACE_MAGIC));
+        this->putVarint(header, BINARY_TRACE_VERSION);
+        this->putVarint(header, regNames.size());
+        for(unsigned int i = 0; i < regNames.size(); i++){
+            this->putVarint(header, regNames[i].size());
+            header.insert(header.end(), regNames[i].begin(), regNames[i].end());
+        }
+        this->putVarint(header, instrNames.size());
+        for(unsigned int i = 0; i < instrNames.size(); i++){
+            this->putVarint(header, instrNames[i].size());
+            header.insert(header.end(), instrNames[i].begin(), instrNames[i].end());
+        }
+        this->traceFile.write((const char *)&header[0], header.size());
+        this->lastValues.assign(regNames.size(), 0);
+        this->buffer.reserve(this->blockSize + 1024);
+        this->lastPC = 0;
+        this->numRecords = 0;
+    }
+    inline bool isOpen() const{
+        return this->traceFile.is_open();
+    }
+
+    ///Starts the record of an executed instruction
+    inline void beginRecord(unsigned long long pc, unsigned int instrId, bool skipped = false){
+        this->curPC = pc;
+        this->curInstrId = (instrId << 1) | (skipped ? 1 : 0);
+        this->changedRegs.clear();
+    }
+    ///Adds a register to the current record if its value changed; registers
+    ///have to be traced in increasing index order
+    inline void traceRegister(unsigned int index, unsigned long long value){
+        if(this->lastValues[index] != value){
+            this->changedRegs.push_back(std::pair<unsigned int, unsigned long long>(index, value ^ this->lastValues[index]));
+            this->lastValues[index] = value;
+        }
+    }
+    inline void endRecord(){
+        long long pcDelta = (long long)(this->curPC - this->lastPC);
+        this->putVarint(this->buffer, ((unsigned long long)pcDelta << 1) ^ (unsigned long long)(pcDelta >> 63));
+        this->putVarint(this->buffer, this->curInstrId);
+        this->putVarint(this->buffer, this->changedRegs.size());
+        unsigned int prevIndex = 0;
+        std::vector<std::pair<unsigned int, unsigned long long> >::const_iterator regIter, regEnd;
+        for(regIter = this->changedRegs.begin(), regEnd = this->changedRegs.end(); regIter != regEnd; regIter++){
+            this->putVarint(this->buffer, regIter->first - prevIndex);
+            this->putVarint(this->buffer, regIter->second);
+            prevIndex = regIter->first;
+        }
+        this->lastPC = this->curPC;
+        this->numRecords++;
+        if(this->buffer.size() >= this->blockSize){
+            this->writeBlock();
+        }
+    }
+
+    unsigned long long getNumRecords() const{
+        return this->numRecords;
+    }
+    ///Writes the pending records to the file
+    void flush(){
+        if(this->isOpen()){
+            this->writeBlock();
+            this->traceFile.flush();
+        }
+    }
+    void close(){
+        if(this->isOpen()){
+            this->writeBlock();
+            this->traceFile.close();
+        }
+    }
+};
+
+class BinaryTraceReader{
+  private:
+    std::ifstream traceFile;
+    std::string fileName;
+    std::vector<std::string> regNames;
+    std::vector<std::string> instrNames;
+    ///Decoded content of the current block
+    std::vector<unsigned char> block;
+    std::vector<unsigned char> stored;
+    unsigned int blockPos;
+    std::vector<unsigned long long> regValues;
+    unsigned long long lastPC;
+
+    unsigned long long getFileVarint(){
+        unsigned long long value = 0;
+        int curByte = 0;
+        for(unsigned int shift = 0; shift == 0 || (curByte & 0x80) != 0; shift += 7){
+            curByte = this->traceFile.get();
+            if(curByte == EOF || shift >= 64){
+                THROW_EXCEPTION("Error, malformed header in binary trace file " << this->fileName);
+            }
+            value |= ((unsigned long long)(curByte & 0x7F)) << shift;
+        }
+        return value;
+    }
+    std::string getFileString(){
+        std::string value(this->getFileVarint(), '\0');
+        if(!value.empty()){
+            this->traceFile.read(&value[0], value.size());
+        }
+        return value;
+    }
+    inline unsigned long long getVarint(){
+        unsigned long long value = 0;
+        unsigned char curByte = 0;
+        for(unsigned int shift = 0; shift == 0 || (curByte & 0x80) != 0; shift += 7){
+            if(this->blockPos >= this->block.size() || shift >= 64){
+                THROW_EXCEPTION("Error, malformed record in binary trace file " << this->fileName);
+            }
+            curByte = this->block[this->blockPos++];
+            value |= ((unsigned long long)(curByte & 0x7F)) << shift;
+        }
+        return value;
+    }
+    unsigned int getWord(){
+        unsigned int value = 0;
+        for(int i = 0; i < 4; i++){
+            value |= ((unsigned int)(this->traceFile.get() & 0xFF)) << (8*i);
+        }
+        return value;
+    }
+    ///Reads the next block of the file; returns false when the end of the file is reached
+    bool readBlock(){
+        int encoding = this->traceFile.get();
+        if(encoding == EOF){
+            return false;
+        }
+        unsigned int rawSize = this->getWord();
+        unsigned int storedSize = this->getWord();
+        this->stored.resize(storedSize);
+        if(storedSize > 0){
+            this->traceFile.read((char *)&this->stored[0], storedSize);
+        }
+        if(!this->traceFile.good()){
+            THROW_EXCEPTION("Error, truncated block in binary trace file " << this->fileName);
+        }
+        this->blockPos = 0;
+        if(encoding == TRACE_BLOCK_RAW && rawSize == storedSize){
+            this->block.swap(this->stored);
+        }
+        else if(encoding == TRACE_BLOCK_ZLIB){
+            #ifdef HAVE_ZLIB
+            this->block.resize(rawSize);
+            uLongf destSize = rawSize;
+            if(uncompress(&this->block[0], &destSize, &this->stored[0], storedSize) != Z_OK || destSize != rawSize){
+                THROW_EXCEPTION("Error, corrupted compressed block in binary trace file " << this->fileName);
+            }
+            #else
+            THROW_EXCEPTION("Error, binary trace file " << this->fileName << " is compressed but zlib support is not available");
+            #endif
+        }
+        else{
+            THROW_EXCEPTION("Error, malformed block with encoding " << encoding << " in binary trace file " << this->fileName);
+        }
+        return true;
+    }
+
+  public:
+    BinaryTraceReader(const std::string & fileName) : fileName(fileName), blockPos(0), lastPC(0){
+        this->traceFile.open(fileName.c_str(), std::ios::in | std::ios::binary);
+        if(!this->traceFile.good()){
+            THROW_EXCEPTION("Error in opening binary trace file " << fileName);
+        }
+        char magic[sizeof(BINARY_TRACE_MAGIC)];
+        this->traceFile.read(magic, sizeof(magic));
+        if(!this->traceFile.good() || std::memcmp(magic, BINARY_TRACE_MAGIC, sizeof(magic)) != 0){
+            THROW_EXCEPTION("Error, file " << fileName << " is not a binary trace");
+        }
+        unsigned long long version = this->getFileVarint();
+        if(version != BINARY_TRACE_VERSION){
+            THROW_EXCEPTION("Error, unsupported version " << version << " of binary trace file " << fileName);
+        }
+        unsigned long long numRegs = this->getFileVarint();
+        for(unsigned long long i = 0; i < numRegs; i++){
+            this->regNames.push_back(this->getFileString());
+        }
+        unsigned long long numInstrs = this->getFileVarint();
+        for(unsigned long long i = 0; i < numInstrs; i++){
+            this->instrNames.push_back(this->getFileString());
+        }
+        this->regValues.assign(this->regNames.size(), 0);
+    }
+
+    const std::vector<std::string> & getRegNames() const{
+        return this->regNames;
+    }
+    const std::vector<std::string> & getInstrNames() const{
+        return this->instrNames;
+    }
+    ///Returns the name of instruction instrId, or its number if it is not in the table
+    std::string getInstrName(unsigned int instrId) const{
+        if(instrId < this->instrNames.size()){
+            return this->instrNames[instrId];
+        }
+        return "instruction " + boost::lexical_cast<std::string>(instrId);
+    }
+    ///Values of all the registers after the last record read
+    const std::vector<unsigned long long> & getRegValues() const{
+        return this->regValues;
+    }
+
+    ///Reads the next record of the trace, updating the register values; returns
+    ///false when the end of the trace is reached
+    bool next(TraceRecord & record){
+        while(this->blockPos >= this->block.size()){
+            if(!this->readBlock()){
+                return false;
+            }
+        }
+        unsigned long long zigzagDelta = this->getVarint();
+        this->lastPC += (unsigned long long)((long long)(zigzagDelta >> 1) ^ -(long long)(zigzagDelta & 1));
+        record.pc = this->lastPC;
+        unsigned long long instrField = this->getVarint();
+        record.instrId = (unsigned int)(instrField >> 1);
+        record.skipped = (instrField & 1) != 0;
+        unsigned long long numChanged = this->getVarint();
+        record.regs.clear();
+        unsigned int regIndex = 0;
+        for(unsigned long long i = 0; i < numChanged; i++){
+            regIndex += this->getVarint();
+            if(regIndex >= this->regValues.size()){
+                THROW_EXCEPTION("Error, register index " << regIndex << " out of range in binary trace file " << this->fileName);
+            }
+            this->regValues[regIndex] ^= this->getVarint();
+            record.regs.push_back(std::pair<unsigned int, unsigned long long>(regIndex, this->regValues[regIndex]));
+        }
+        return true;
+    }
+};
+
+};
+
+#endif
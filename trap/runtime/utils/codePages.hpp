@@ -0,0 +1,223 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef CODEPAGES_HPP
+#define CODEPAGES_HPP
+
+#ifdef __GNUC__
+#ifdef __GNUC_MINOR__
+#if (__GNUC__ >= 4 && __GNUC_MINOR__ >= 3)
+#include <tr1/unordered_map>
+#define template_map std::tr1::unordered_map
+#else
+#include <ext/hash_map>
+#define  template_map __gnu_cxx::hash_map
+#endif
+#else
+#include <ext/hash_map>
+#define  template_map __gnu_cxx::hash_map
+#endif
+#else
+#ifdef _WIN32
+#include <hash_map>
+#define  template_map stdext::hash_map
+#else
+#include <map>
+#define  template_map std::map
+#endif
+#endif
+
+#include <cstring>
+#include <vector>
+
+#include "pendingEvents.hpp"
+
+namespace trap{
+
+///Keeps track of the memory pages holding instructions which the processor
+///caches in decoded (or translated) form, in order to detect self modifying
+///code. The memories notify every write: a write to a page holding cached
+///instructions marks the page as modified and raises PENDING_CODE_WRITE; the
+///processor then drops, before fetching the next instruction, the cached
+///instructions of the modified pages, which are recorded for each page so
+///that the rest of the cache is not visited.
+///One flag is kept for each page of the address space, which therefore
+///must be of at most 32 bits
+template<class issueWidth> class CodePages{
+  public:
+    ///Size, as a power of two, of the tracked pages
+    static const unsigned int pageBits = 12;
+
+  private:
+    enum PageState{
+        PAGE_EMPTY = 0,
+        PAGE_CODE = 1,
+        PAGE_MODIFIED = 2
+    };
+    unsigned char * pages;
+    std::vector<issueWidth> modifiedPages;
+    ///Keys in the instruction cache of the instructions cached from each page
+    template_map<issueWidth, std::vector<issueWidth> > cachedInstrs;
+    unsigned int * pendingEvents;
+
+    inline void notifyPage(const issueWidth & page){
+        if(this->pages[page] == PAGE_CODE){
+            this->pages[page] = PAGE_MODIFIED;
+            this->modifiedPages.push_back(page);
+            if(this->pendingEvents != NULL){
+                *(this->pendingEvents) |= PENDING_CODE_WRITE;
+            }
+        }
+    }
+
+    ///A modified page keeps its state until the processor drops its
+    ///cached instructions, including the ones cached in the meanwhile
+    inline void markPage(const issueWidth & page){
+        if(this->pages[page] == PAGE_EMPTY){
+            this->pages[page] = PAGE_CODE;
+        }
+    }
+
+  public:
+    CodePages() : pendingEvents(NULL){
+        unsigned long numPages = (((unsigned long)((issueWidth)-1)) >> pageBits) + 1;
+        this->pages = new unsigned char[numPages];
+        memset(this->pages, PAGE_EMPTY, numPages);
+    }
+    ~CodePages(){
+        delete [] this->pages;
+    }
+    void setPendingEvents(unsigned int * pendingEvents){
+        this->pendingEvents = pendingEvents;
+    }
+    ///Marks the page containing address as holding cached instructions
+    inline void markCode(const issueWidth & address){
+        this->markPage(address >> pageBits);
+    }
+    ///Marks the pages overlapping [start, end) as holding cached instructions
+    void markCode(const issueWidth & start, const issueWidth & end){
+        if(end == start){
+            return;
+        }
+        issueWidth page = start >> pageBits;
+        issueWidth lastPage = (issueWidth)(end - 1) >> pageBits;
+        this->markPage(page);
+        while(page != lastPage){
+            page = (page + 1) & (((issueWidth)-1) >> pageBits);
+            this->markPage(page);
+        }
+    }
+    ///Marks the page containing address as holding the instruction cached
+    ///with address as key
+    inline void addCachedInstr(const issueWidth & address){
+        issueWidth page = address >> pageBits;
+        this->markPage(page);
+        this->cachedInstrs[page].push_back(address);
+    }
+    ///Marks the pages overlapping [start, end) as holding part of the
+    ///instruction cached with key (e.g. the components of a superinstruction)
+    void addCachedInstr(const issueWidth & key, const issueWidth & start, const issueWidth & end){
+        if(end == start){
+            return;
+        }
+        issueWidth page = start >> pageBits;
+        issueWidth lastPage = (issueWidth)(end - 1) >> pageBits;
+        this->markPage(page);
+        this->cachedInstrs[page].push_back(key);
+        while(page != lastPage){
+            page = (page + 1) & (((issueWidth)-1) >> pageBits);
+            this->markPage(page);
+            this->cachedInstrs[page].push_back(key);
+        }
+    }
+    ///Returns the keys of the instructions cached from page (a page number)
+    ///since the page was last cleared, NULL if there are none; some of them
+    ///may have been dropped from the cache in the meantime
+    const std::vector<issueWidth> * getCachedInstrs(const issueWidth & page) const{
+        typename template_map<issueWidth, std::vector<issueWidth> >::const_iterator foundPage = this->cachedInstrs.find(page);
+        if(foundPage == this->cachedInstrs.end()){
+            return NULL;
+        }
+        return &(foundPage->second);
+    }
+    ///Forgets the cached instructions, e.g. since the whole cache was dropped;
+    ///the pages keep holding code
+    void clearCachedInstrs(){
+        this->cachedInstrs.clear();
+    }
+    ///Called by the memories for each write of length bytes starting at address
+    inline void notifyWrite(const issueWidth & address, unsigned int length){
+        issueWidth page = address >> pageBits;
+        issueWidth lastPage = (issueWidth)(address + length - 1) >> pageBits;
+        this->notifyPage(page);
+        while(page != lastPage){
+            page = (page + 1) & (((issueWidth)-1) >> pageBits);
+            this->notifyPage(page);
+        }
+    }
+    ///Returns true if the address lies in a page modified since the last
+    ///call to clearModified
+    inline bool isModified(const issueWidth & address) const{
+        return this->pages[address >> pageBits] == PAGE_MODIFIED;
+    }
+    ///Returns the pages (as page numbers) modified since the last call to clearModified
+    const std::vector<issueWidth> & getModifiedPages() const{
+        return this->modifiedPages;
+    }
+    ///Called by the processor once the cached instructions of the modified
+    ///pages were dropped: the pages do not hold cached instructions any more
+    void clearModified(){
+        typename std::vector<issueWidth>::const_iterator pageIter, pageEnd;
+        for(pageIter = this->modifiedPages.begin(), pageEnd = this->modifiedPages.end(); pageIter != pageEnd; pageIter++){
+            this->pages[*pageIter] = PAGE_EMPTY;
+            this->cachedInstrs.erase(*pageIter);
+        }
+        this->modifiedPages.clear();
+        if(this->pendingEvents != NULL){
+            *(this->pendingEvents) &= ~PENDING_CODE_WRITE;
+        }
+    }
+};
+
+};
+
+#endif
@@ -0,0 +1,245 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef CODETRANSLATOR_HPP
+#define CODETRANSLATOR_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <sstream>
+
+#include "trap_utils.hpp"
+
+namespace trap{
+
+///Description of the processor model for which C++ code is emitted
+struct TranslatorTarget{
+    ///Namespace and name of the processor class
+    std::string nameSpace;
+    std::string processorClass;
+    ///Type of the instruction words and of the addresses
+    std::string fetchType;
+    ///Expression reading the current program counter through the
+    ///processor pointer
+    std::string pcExpression;
+    ///Name of the processor member (memory or port) the instructions are fetched from
+    std::string instrMemory;
+    ///Size of the instruction words in bytes
+    unsigned int wordSize;
+    ///Name of the class of each instruction, indexed by instruction id
+    std::vector<std::string> instrClasses;
+};
+
+///Emits the C++ code which executes a set of decoded instructions natively.
+///The instructions are grouped in regions of regionSize bytes, aligned to their
+///size; each region becomes a function entered at any of its instructions
+///through a switch on the program counter. Each instruction calls the
+///behavior of its instruction class directly, on an instance whose fields
+///were decoded once when the code is registered in the processor. After each
+///instruction the program counter is compared with the address of the next
+///one: when the control flow leaves the straight-line sequence the switch
+///dispatches it again, and when it leaves the region the control goes back to
+///the processor (see TranslatedCode). The emitted file defines a function
+///(trapRegisterTranslatedCode by default) which registers in the processor the
+///regions whose instructions match the content of its memory, returning their number
+class CodeTranslator{
+  private:
+    TranslatorTarget target;
+    unsigned long long regionSize;
+    ///Instructions of each region: address and word, indexed by the region start address
+    std::map<unsigned long long, std::map<unsigned long long, std::pair<unsigned long long, unsigned int> > > regions;
+    unsigned int numInstructions;
+
+    static std::string toHex(unsigned long long value){
+        std::ostringstream hexStream;
+        hexStream << std::hex << std::showbase << value;
+        return hexStream.str();
+    }
+    static std::string regionName(unsigned long long regionStart){
+        std::ostringstream nameStream;
+        nameStream << std::hex << regionStart;
+        return nameStream.str();
+    }
+
+  public:
+    CodeTranslator(const TranslatorTarget & target, unsigned long long regionSize = 1024) : target(target), regionSize(regionSize), numInstructions(0){
+        if(regionSize < target.wordSize || (regionSize & (regionSize - 1)) != 0){
+            THROW_EXCEPTION("Error, the size of the translated regions has to be a power of two, at least as big as an instruction");
+        }
+    }
+    ///Adds the instruction at the specified address, decoded from word;
+    ///instructions whose id has no class (e.g. invalid ones) are left to the interpreter
+    void addInstruction(unsigned long long address, unsigned long long word, int instrId){
+        if(instrId < 0 || (unsigned int)instrId >= this->target.instrClasses.size() || this->target.instrClasses[instrId].empty()){
+            return;
+        }
+        this->regions[address & ~(this->regionSize - 1)][address] = std::pair<unsigned long long, unsigned int>(word, instrId);
+        this->numInstructions++;
+    }
+    unsigned int getNumRegions() const{
+        return this->regions.size();
+    }
+    unsigned int getNumInstructions() const{
+        return this->numInstructions;
+    }
+
+    ///Writes the translated code on stream; description is printed as a
+    ///comment at the beginning of the file and entryName is the name of the
+    ///function registering the code in the processor
+    void write(std::ostream & stream, const std::string & description, const std::string & entryName = "trapRegisterTranslatedCode") const{
+        const std::string & fetchType = this->target.fetchType;
+        unsigned int slotsPerRegion = this->regionSize/this->target.wordSize;
+        stream << "// " << description << std::endl << std::endl;
+        stream << "#include \"processor.hpp\"" << std::endl;
+        stream << "#include \"instructions.hpp\"" << std::endl;
+        stream << "#include \"translatedCode.hpp\"" << std::endl;
+        stream << "#include \"customExceptions.hpp\"" << std::endl << std::endl;
+        stream << "using namespace " << this->target.nameSpace << ";" << std::endl;
+        stream << "using namespace trap;" << std::endl << std::endl;
+        stream << "namespace{" << std::endl << std::endl;
+        stream << this->target.processorClass << " * processor = NULL;" << std::endl << std::endl;
+
+        // Helper which checks that the translated instructions are the ones in memory and
+        // decodes them once
+        stream << "bool registerRegion(" << fetchType << " start, unsigned int numInstrs, const unsigned int * slots, const " << fetchType << " * words, Instruction ** instrs, TranslatedCode<" << fetchType << ">::RegionFunction function){" << std::endl;
+        stream << "    for(unsigned int i = 0; i < numInstrs; i++){" << std::endl;
+        stream << "        if(processor->" << this->target.instrMemory << ".read_word_dbg(start + slots[i]*" << this->target.wordSize << ") != words[i]){" << std::endl;
+        stream << "            return false;" << std::endl;
+        stream << "        }" << std::endl;
+        stream << "    }" << std::endl;
+        stream << "    for(unsigned int i = 0; i < numInstrs; i++){" << std::endl;
+        stream << "        instrs[slots[i]] = processor->decode(words[i])->replicate();" << std::endl;
+        stream << "        instrs[slots[i]]->setParams(words[i]);" << std::endl;
+        stream << "    }" << std::endl;
+        stream << "    processor->translatedCode.addRegion(start, " << this->regionSize << ", function);" << std::endl;
+        stream << "    return true;" << std::endl;
+        stream << "}" << std::endl << std::endl;
+
+        std::map<unsigned long long, std::map<unsigned long long, std::pair<unsigned long long, unsigned int> > >::const_iterator regionIter, regionEnd;
+        for(regionIter = this->regions.begin(), regionEnd = this->regions.end(); regionIter != regionEnd; regionIter++){
+            std::string name = regionName(regionIter->first);
+            const std::map<unsigned long long, std::pair<unsigned long long, unsigned int> > & instrs = regionIter->second;
+            std::map<unsigned long long, std::pair<unsigned long long, unsigned int> >::const_iterator instrIter, instrEnd;
+
+            stream << "// Instructions between " << toHex(regionIter->first) << " and " << toHex(regionIter->first + this->regionSize) << std::endl;
+            stream << "Instruction * instrs_" << name << "[" << slotsPerRegion << "];" << std::endl;
+            stream << "const unsigned int slots_" << name << "[] = {";
+            for(instrIter = instrs.begin(), instrEnd = instrs.end(); instrIter != instrEnd; instrIter++){
+                stream << (instrIter == instrs.begin() ? "" : ", ") << (instrIter->first - regionIter->first)/this->target.wordSize;
+            }
+            stream << "};" << std::endl;
+            stream << "const " << fetchType << " words_" << name << "[] = {";
+            for(instrIter = instrs.begin(), instrEnd = instrs.end(); instrIter != instrEnd; instrIter++){
+                stream << (instrIter == instrs.begin() ? "" : ", ") << toHex(instrIter->second.first);
+            }
+            stream << "};" << std::endl;
+            // The instructions are called through pointers to their own class, so that
+            // their behavior is not dispatched through the virtual table
+            for(instrIter = instrs.begin(), instrEnd = instrs.end(); instrIter != instrEnd; instrIter++){
+                stream << this->target.instrClasses[instrIter->second.second] << " * instr_" << name << "_" << (instrIter->first - regionIter->first)/this->target.wordSize << " = NULL;" << std::endl;
+            }
+            stream << std::endl;
+
+            stream << "unsigned int region_" << name << "(unsigned int & numInstructions, unsigned int maxInstructions){" << std::endl;
+            stream << "    unsigned int numCycles = 0;" << std::endl;
+            stream << "    " << fetchType << " curPC = " << this->target.pcExpression << ";" << std::endl;
+            stream << "    while(numInstructions < maxInstructions){" << std::endl;
+            stream << "        switch(curPC){" << std::endl;
+            for(instrIter = instrs.begin(), instrEnd = instrs.end(); instrIter != instrEnd; instrIter++){
+                const std::string & instrClass = this->target.instrClasses[instrIter->second.second];
+                unsigned long long nextAddress = instrIter->first + this->target.wordSize;
+                std::map<unsigned long long, std::pair<unsigned long long, unsigned int> >::const_iterator nextInstr = instrIter;
+                nextInstr++;
+                stream << "            case " << toHex(instrIter->first) << ":" << std::endl;
+                stream << "                try{" << std::endl;
+                stream << "                    numCycles += instr_" << name << "_" << (instrIter->first - regionIter->first)/this->target.wordSize << "->" << instrClass << "::behavior();" << std::endl;
+                stream << "                }" << std::endl;
+                stream << "                catch(annull_exception &etc){" << std::endl;
+                stream << "                }" << std::endl;
+                stream << "                numInstructions++;" << std::endl;
+                stream << "                curPC = " << this->target.pcExpression << ";" << std::endl;
+                if(nextInstr != instrEnd && nextInstr->first == nextAddress){
+                    // The next instruction is translated as well: the execution can continue
+                    // with it without going through the switch
+                    stream << "                if(curPC != " << toHex(nextAddress) << "){" << std::endl;
+                    stream << "                    continue;" << std::endl;
+                    stream << "                }" << std::endl;
+                }
+                else{
+                    stream << "                continue;" << std::endl;
+                }
+            }
+            stream << "            default:" << std::endl;
+            stream << "                return numCycles;" << std::endl;
+            stream << "        }" << std::endl;
+            stream << "    }" << std::endl;
+            stream << "    return numCycles;" << std::endl;
+            stream << "}" << std::endl << std::endl;
+        }
+        stream << "};" << std::endl << std::endl;
+
+        stream << "extern \"C\" unsigned int " << entryName << "(" << this->target.processorClass << " & translatedProcessor){" << std::endl;
+        stream << "    processor = &translatedProcessor;" << std::endl;
+        stream << "    unsigned int numRegions = 0;" << std::endl;
+        for(regionIter = this->regions.begin(), regionEnd = this->regions.end(); regionIter != regionEnd; regionIter++){
+            std::string name = regionName(regionIter->first);
+            stream << "    if(registerRegion(" << toHex(regionIter->first) << ", " << regionIter->second.size() << ", slots_" << name << ", words_" << name << ", instrs_" << name << ", region_" << name << ")){" << std::endl;
+            stream << "        numRegions++;" << std::endl;
+            std::map<unsigned long long, std::pair<unsigned long long, unsigned int> >::const_iterator instrIter, instrEnd;
+            for(instrIter = regionIter->second.begin(), instrEnd = regionIter->second.end(); instrIter != instrEnd; instrIter++){
+                const std::string & instrClass = this->target.instrClasses[instrIter->second.second];
+                unsigned long long slot = (instrIter->first - regionIter->first)/this->target.wordSize;
+                stream << "        instr_" << name << "_" << slot << " = dynamic_cast<" << instrClass << " *>(instrs_" << name << "[" << slot << "]);" << std::endl;
+            }
+            stream << "    }" << std::endl;
+        }
+        stream << "    return numRegions;" << std::endl;
+        stream << "}" << std::endl;
+    }
+};
+
+};
+
+#endif
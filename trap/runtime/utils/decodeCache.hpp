@@ -0,0 +1,182 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef DECODECACHE_HPP
+#define DECODECACHE_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "trap_utils.hpp"
+
+///Decoded instructions saved at the end of a simulation and restored at the
+///beginning of the following simulation of the same application, so that the
+///instruction cache does not have to be filled again. The file starts with
+///the magic string, the format version and the signature of the processor
+///model which wrote it; then the number of entries follows, each entry being
+///the key of the instruction in the cache (its address, or the instruction
+///word when the cache is indexed by it), the instruction id and the
+///instruction word. All the numbers are stored as LEB128 varints.
+///The files are named after a hash of the content of the application, so
+///that a modified application never finds the instructions of the old one;
+///anyway the processor checks each instruction against the memory and the
+///decoder before restoring it.
+
+namespace trap{
+
+static const char DECODE_CACHE_MAGIC[8] = {'T', 'R', 'A', 'P', 'D', 'E', 'C', '\0'};
+static const unsigned int DECODE_CACHE_VERSION = 1;
+
+struct DecodeCacheEntry{
+    unsigned long long key;
+    unsigned int instrId;
+    unsigned long long word;
+};
+
+class DecodeCache{
+  private:
+    static void putVarint(std::ostream & stream, unsigned long long value){
+        while(value >= 0x80){
+            stream.put((char)(value | 0x80));
+            value >>= 7;
+        }
+        stream.put((char)value);
+    }
+    static bool getVarint(std::istream & stream, unsigned long long & value){
+        value = 0;
+        for(unsigned int shift = 0; shift < 64; shift += 7){
+            int curByte = stream.get();
+            if(curByte == EOF){
+                return false;
+            }
+            value |= ((unsigned long long)(curByte & 0x7F)) << shift;
+            if((curByte & 0x80) == 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+  public:
+    std::vector<DecodeCacheEntry> entries;
+
+    ///Returns the FNV-1a hash of the content of the file
+    static unsigned long long hashFile(const std::string & fileName){
+        std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+        if(!file.good()){
+            THROW_EXCEPTION("Error in opening file " << fileName << " for hashing it");
+        }
+        unsigned long long hash = 0xcbf29ce484222325ULL;
+        char buffer[4096];
+        while(file.good()){
+            file.read(buffer, sizeof(buffer));
+            for(std::streamsize i = 0; i < file.gcount(); i++){
+                hash = (hash ^ (unsigned char)buffer[i])*0x100000001b3ULL;
+            }
+        }
+        return hash;
+    }
+    ///Returns the name of the file, inside directory, holding the instructions
+    ///decoded by the given processor model for the given application
+    static std::string getFileName(const std::string & directory, const std::string & application, const std::string & modelName){
+        std::ostringstream fileName;
+        fileName << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << DecodeCache::hashFile(application) << "_" << modelName << ".dec";
+        return fileName.str();
+    }
+    ///Reads the entries of the file; returns false, leaving the entries empty,
+    ///if the file does not exist or it was written by a different model
+    bool load(const std::string & fileName, const std::string & signature){
+        this->entries.clear();
+        std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+        if(!file.good()){
+            return false;
+        }
+        char magic[sizeof(DECODE_CACHE_MAGIC)];
+        file.read(magic, sizeof(magic));
+        unsigned long long version = 0, signatureLen = 0, numEntries = 0;
+        if(!file.good() || std::string(magic, sizeof(magic)) != std::string(DECODE_CACHE_MAGIC, sizeof(DECODE_CACHE_MAGIC)) ||
+                    !getVarint(file, version) || version != DECODE_CACHE_VERSION || !getVarint(file, signatureLen) ||
+                    signatureLen != signature.size()){
+            return false;
+        }
+        std::string fileSignature(signature.size(), '\0');
+        file.read(&fileSignature[0], signature.size());
+        if(!file.good() || fileSignature != signature || !getVarint(file, numEntries)){
+            return false;
+        }
+        for(unsigned long long i = 0; i < numEntries; i++){
+            DecodeCacheEntry entry;
+            unsigned long long instrId = 0;
+            if(!getVarint(file, entry.key) || !getVarint(file, instrId) || !getVarint(file, entry.word)){
+                this->entries.clear();
+                return false;
+            }
+            entry.instrId = (unsigned int)instrId;
+            this->entries.push_back(entry);
+        }
+        return true;
+    }
+    void save(const std::string & fileName, const std::string & signature) const{
+        std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!file.good()){
+            THROW_EXCEPTION("Error in opening file " << fileName << " for saving the decoded instructions");
+        }
+        file.write(DECODE_CACHE_MAGIC, sizeof(DECODE_CACHE_MAGIC));
+        putVarint(file, DECODE_CACHE_VERSION);
+        putVarint(file, signature.size());
+        file.write(signature.c_str(), signature.size());
+        putVarint(file, this->entries.size());
+        std::vector<DecodeCacheEntry>::const_iterator entriesIter, entriesEnd;
+        for(entriesIter = this->entries.begin(), entriesEnd = this->entries.end(); entriesIter != entriesEnd; entriesIter++){
+            putVarint(file, entriesIter->key);
+            putVarint(file, entriesIter->instrId);
+            putVarint(file, entriesIter->word);
+        }
+    }
+};
+
+};
+
+#endif
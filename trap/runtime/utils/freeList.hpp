@@ -0,0 +1,124 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef FREELIST_HPP
+#define FREELIST_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace trap{
+
+///Allocation counters, cumulative for all the free lists
+struct FreeListStats{
+    ///Number of allocations requested
+    unsigned long long numAllocs;
+    ///Number of allocations served with a recycled block
+    unsigned long long numRecycled;
+    ///Number of blocks released
+    unsigned long long numFrees;
+
+    FreeListStats() : numAllocs(0), numRecycled(0), numFrees(0){}
+};
+
+inline FreeListStats & getFreeListStats() throw(){
+    static FreeListStats stats;
+    return stats;
+}
+
+///Recycles the memory used by the objects of class T, which are frequently
+///created and destroyed: released blocks are kept in a list and returned by the
+///following allocations instead of going through the global heap. It is meant
+///to be used by the operator new and delete of T
+template<class T> class FreeList{
+    private:
+    std::vector<void *> freeBlocks;
+
+    public:
+    FreeListStats stats;
+
+    ~FreeList(){
+        std::vector<void *>::iterator blocksIter, blocksEnd;
+        for(blocksIter = this->freeBlocks.begin(), blocksEnd = this->freeBlocks.end(); blocksIter != blocksEnd; blocksIter++){
+            ::operator delete(*blocksIter);
+        }
+    }
+
+    inline void * allocate(std::size_t size){
+        this->stats.numAllocs++;
+        getFreeListStats().numAllocs++;
+        // Derived classes not redefining operator new have a different size:
+        // their objects are simply allocated on the heap
+        if(size == sizeof(T) && !this->freeBlocks.empty()){
+            this->stats.numRecycled++;
+            getFreeListStats().numRecycled++;
+            void * block = this->freeBlocks.back();
+            this->freeBlocks.pop_back();
+            return block;
+        }
+        return ::operator new(size);
+    }
+
+    ///Called by the operator delete of the instructions, so no exception
+    ///escapes it: when the list cannot grow the block goes back to the heap
+    inline void release(void * block, std::size_t size){
+        if(block == NULL){
+            return;
+        }
+        this->stats.numFrees++;
+        getFreeListStats().numFrees++;
+        if(size == sizeof(T)){
+            try{
+                this->freeBlocks.push_back(block);
+                return;
+            }
+            catch(std::bad_alloc &){
+            }
+        }
+        ::operator delete(block);
+    }
+};
+
+};
+
+#endif
@@ -0,0 +1,156 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef HOSTCOUNTERS_HPP
+#define HOSTCOUNTERS_HPP
+
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace trap{
+
+///Hardware events of the host processor
+enum HostEvent{HOST_CYCLES = 0, HOST_INSTRUCTIONS, HOST_BRANCH_MISSES, HOST_L1I_MISSES, HOST_L1D_MISSES, HOST_LLC_MISSES, HOST_NUM_EVENTS};
+
+///Hardware counters of the host, read through the Linux perf_event_open
+///interface. They count the current process and the processes it creates while
+///they are enabled, so they can be used around the execution of a simulator.
+///Events which the host (or its permissions) does not support are not available;
+///on other operating systems no event is available
+class HostCounters{
+  private:
+    int fds[HOST_NUM_EVENTS];
+
+    #ifdef __linux__
+    static int openEvent(unsigned int type, unsigned long long config){
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // The times are used to scale the counts when events are multiplexed
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    static unsigned long long cacheMiss(unsigned long long cache){
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+    #endif
+
+  public:
+    HostCounters(){
+        for(int i = 0; i < HOST_NUM_EVENTS; i++){
+            this->fds[i] = -1;
+        }
+        #ifdef __linux__
+        this->fds[HOST_CYCLES] = HostCounters::openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        this->fds[HOST_INSTRUCTIONS] = HostCounters::openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        this->fds[HOST_BRANCH_MISSES] = HostCounters::openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        this->fds[HOST_L1I_MISSES] = HostCounters::openEvent(PERF_TYPE_HW_CACHE, HostCounters::cacheMiss(PERF_COUNT_HW_CACHE_L1I));
+        this->fds[HOST_L1D_MISSES] = HostCounters::openEvent(PERF_TYPE_HW_CACHE, HostCounters::cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+        this->fds[HOST_LLC_MISSES] = HostCounters::openEvent(PERF_TYPE_HW_CACHE, HostCounters::cacheMiss(PERF_COUNT_HW_CACHE_LL));
+        #endif
+    }
+    ~HostCounters(){
+        #ifdef __linux__
+        for(int i = 0; i < HOST_NUM_EVENTS; i++){
+            if(this->fds[i] >= 0){
+                close(this->fds[i]);
+            }
+        }
+        #endif
+    }
+    bool isAvailable(HostEvent event) const{
+        return this->fds[event] >= 0;
+    }
+    ///Both cycles and instructions are needed for computing any meaningful figure
+    bool isSupported() const{
+        return this->isAvailable(HOST_CYCLES) && this->isAvailable(HOST_INSTRUCTIONS);
+    }
+    ///Resets and enables the counters
+    void start(){
+        #ifdef __linux__
+        for(int i = 0; i < HOST_NUM_EVENTS; i++){
+            if(this->fds[i] >= 0){
+                ioctl(this->fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(this->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+        #endif
+    }
+    void stop(){
+        #ifdef __linux__
+        for(int i = 0; i < HOST_NUM_EVENTS; i++){
+            if(this->fds[i] >= 0){
+                ioctl(this->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        #endif
+    }
+    ///Returns the count of the event, scaled in case the event
+    ///was not always scheduled on the hardware counters
+    double read(HostEvent event) const{
+        #ifdef __linux__
+        unsigned long long values[3];
+        if(this->fds[event] < 0 || ::read(this->fds[event], values, sizeof(values)) != sizeof(values) || values[2] == 0){
+            return 0;
+        }
+        return (double)values[0]*values[1]/values[2];
+        #else
+        return 0;
+        #endif
+    }
+};
+
+};
+
+#endif
@@ -0,0 +1,169 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef INSTRUCTIONARENA_HPP
+#define INSTRUCTIONARENA_HPP
+
+#include <cstddef>
+#include <new>
+
+#include "trap_utils.hpp"
+
+namespace trap{
+
+///Contiguous memory holding the instructions kept in the instruction cache
+///of the functional processors: allocating an instruction is a pointer
+///increment and the instructions are never freed one by one, as the whole
+///arena is reset when the processor flushes its cache. When the arena is
+///full the instructions are allocated on the heap, and isFull tells the
+///processor to flush its cache.
+///The instructions are allocated through the operators new and delete of
+///the instruction base class, which call allocate and release: each
+///instruction is preceded by a header telling where it was allocated, so
+///that it can be deleted as usual
+class InstructionArena{
+  private:
+    union Header{
+        ///NULL for the instructions allocated on the heap
+        InstructionArena * arena;
+        long double alignment;
+    };
+    char * memory;
+    std::size_t capacity;
+    std::size_t used;
+    bool full;
+    ///Instructions allocated in the arena and not released yet
+    unsigned int numObjects;
+    ///Number of times the arena was reset
+    unsigned int numResets;
+
+    void * allocateBlock(std::size_t size){
+        size = ((size + sizeof(Header) - 1)/sizeof(Header))*sizeof(Header);
+        if(this->used + size > this->capacity){
+            this->full = true;
+            return NULL;
+        }
+        if(this->memory == NULL){
+            this->memory = (char *)::operator new(this->capacity);
+        }
+        void * block = this->memory + this->used;
+        this->used += size;
+        this->numObjects++;
+        return block;
+    }
+
+  public:
+    ///The memory of the arena is allocated at its first use
+    InstructionArena(std::size_t capacity = 64*1024*1024) : memory(NULL), capacity(capacity), used(0),
+                                                          full(false), numObjects(0), numResets(0){}
+    ~InstructionArena(){
+        ::operator delete(this->memory);
+    }
+    ///Sets the maximum amount of memory, in bytes, used by the arena; it can
+    ///be changed only while the arena is empty
+    void setCapacity(std::size_t capacity){
+        if(this->used != 0){
+            THROW_EXCEPTION("Error, the capacity of the instruction arena cannot be changed once it is used");
+        }
+        ::operator delete(this->memory);
+        this->memory = NULL;
+        this->capacity = capacity;
+    }
+    ///Allocates size bytes in the arena, or on the heap if arena is NULL or full
+    static void * allocate(std::size_t size, InstructionArena * arena){
+        void * block = NULL;
+        if(arena != NULL){
+            block = arena->allocateBlock(size + sizeof(Header));
+        }
+        if(block == NULL){
+            arena = NULL;
+            block = ::operator new(size + sizeof(Header));
+        }
+        ((Header *)block)->arena = arena;
+        return (char *)block + sizeof(Header);
+    }
+    ///Releases memory returned by allocate: the memory of the arena is
+    ///reclaimed only when the arena is reset
+    static void release(void * object) throw(){
+        if(object == NULL){
+            return;
+        }
+        Header * header = (Header *)((char *)object - sizeof(Header));
+        if(header->arena == NULL){
+            ::operator delete(header);
+        }
+        else{
+            header->arena->numObjects--;
+        }
+    }
+    ///Returns true if an allocation did not fit in the arena since the last reset
+    inline bool isFull() const{
+        return this->full;
+    }
+    ///Makes all the memory of the arena available again: all the instructions
+    ///allocated in it must have been released
+    void reset(){
+        if(this->numObjects != 0){
+            THROW_EXCEPTION("Error, resetting the instruction arena while " << this->numObjects << " instructions are still allocated in it");
+        }
+        this->used = 0;
+        this->full = false;
+        this->numResets++;
+    }
+    std::size_t getCapacity() const{
+        return this->capacity;
+    }
+    ///Bytes used since the last reset, including the ones of the released instructions
+    std::size_t getUsed() const{
+        return this->used;
+    }
+    unsigned int getNumObjects() const{
+        return this->numObjects;
+    }
+    unsigned int getNumResets() const{
+        return this->numResets;
+    }
+};
+
+};
+
+#endif
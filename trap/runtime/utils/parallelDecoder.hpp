@@ -0,0 +1,102 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef PARALLELDECODER_HPP
+#define PARALLELDECODER_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+namespace trap{
+
+///Decodes a slice of the words assigned to one of the threads
+template<class DecoderType, class WordType> class DecodeSlice{
+  private:
+    const DecoderType & decoder;
+    const WordType * words;
+    int * instrIds;
+    unsigned int numWords;
+  public:
+    DecodeSlice(const DecoderType & decoder, const WordType * words, int * instrIds, unsigned int numWords) :
+                    decoder(decoder), words(words), instrIds(instrIds), numWords(numWords){}
+    void operator()() const{
+        for(unsigned int i = 0; i < this->numWords; i++){
+            this->instrIds[i] = this->decoder.decode(this->words[i]);
+        }
+    }
+};
+
+///Decodes words, writing in instrIds the id of the corresponding
+///instructions; the words are split among numThreads threads. The
+///decoder is not modified by decode, so it is shared among the threads
+template<class DecoderType, class WordType> void parallelDecode(const DecoderType & decoder,
+                            const std::vector<WordType> & words, std::vector<int> & instrIds, unsigned int numThreads){
+    instrIds.resize(words.size());
+    if(words.empty()){
+        return;
+    }
+    if(numThreads == 0){
+        numThreads = boost::thread::hardware_concurrency();
+    }
+    if(numThreads == 0){
+        numThreads = 1;
+    }
+    // Each thread decodes at least one word
+    if(numThreads > words.size()){
+        numThreads = words.size();
+    }
+    unsigned int sliceSize = (words.size() + numThreads - 1)/numThreads;
+    boost::thread_group threads;
+    for(unsigned int start = sliceSize; start < words.size(); start += sliceSize){
+        unsigned int numWords = std::min(sliceSize, (unsigned int)words.size() - start);
+        threads.create_thread(DecodeSlice<DecoderType, WordType>(decoder, &words[start], &instrIds[start], numWords));
+    }
+    // The first slice is decoded by the calling thread
+    DecodeSlice<DecoderType, WordType>(decoder, &words[0], &instrIds[0], std::min(sliceSize, (unsigned int)words.size()))();
+    threads.join_all();
+}
+
+};
+
+#endif
@@ -0,0 +1,69 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef PENDINGEVENTS_HPP
+#define PENDINGEVENTS_HPP
+
+namespace trap{
+
+///Bits of the word which the main loop of the functional processors tests
+///before every instruction: the interrupt lines and the tools are consulted
+///only when the corresponding bit is set, so that when nothing is pending
+///the issue of an instruction costs a single test.
+///Note that the bits are set by SystemC processes (interrupt ports), by
+///the simulator set-up (tools) or by the memories written by the processor
+///(code writes), which are never run concurrently with the processor thread:
+///no atomic operation is needed.
+enum PendingEvent{
+    ///At least one interrupt line was raised since the last time the
+    ///processor found all of them lowered
+    PENDING_IRQ = 0x1,
+    ///At least one tool is registered with the tool manager
+    PENDING_TOOLS = 0x2,
+    ///Some instructions cached by the processor were overwritten
+    ///(see CodePages)
+    PENDING_CODE_WRITE = 0x4
+};
+
+};
+
+#endif
@@ -0,0 +1,224 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <sstream>
+#include <ostream>
+#include <algorithm>
+
+#ifdef __GNUC__
+#include <time.h>
+#include <sys/time.h>
+#else
+#include <ctime>
+#endif
+
+namespace trap{
+
+///Phases among which the host time spent by the simulator is split
+enum PerfPhase{PHASE_FETCH_DECODE = 0, PHASE_BEHAVIOR, PHASE_TOOLS, PHASE_SYSCALLS, PHASE_OTHER, PHASE_NUM};
+
+///Counters kept by each TLM port of a processor
+struct PortCounters{
+    ///Accesses served through the DMI pointer
+    unsigned long long dmiHits;
+    ///Accesses which required a transport call
+    unsigned long long transportCalls;
+    unsigned long long quantumSyncs;
+    PortCounters() : dmiHits(0), transportCalls(0), quantumSyncs(0){}
+};
+
+///Performance counters of a processor. The generated simulators update them
+///only when compiled with ENABLE_PERF_COUNTERS defined. Host time is measured
+///on one instruction every samplePeriod, so that timing does not dominate
+///the simulation; the time reported for each phase is scaled accordingly
+class PerfCounters{
+  private:
+    std::string name;
+    std::vector<std::pair<std::string, const PortCounters *> > ports;
+    unsigned long long sampleMask;
+    bool sampling;
+    PerfPhase curPhase;
+    double phaseStart;
+
+    ///All the existing counters, exported together by dumpAll
+    static std::vector<PerfCounters *> & getRegistry(){
+        static std::vector<PerfCounters *> registry;
+        return registry;
+    }
+
+  public:
+    ///Returns the current host time, in seconds, from a monotonic clock when available
+    static double hostTime(){
+        #if defined(__GNUC__) && defined(CLOCK_MONOTONIC)
+        struct timespec curTime;
+        clock_gettime(CLOCK_MONOTONIC, &curTime);
+        return curTime.tv_sec + curTime.tv_nsec*1e-9;
+        #elif defined(__GNUC__)
+        struct timeval curTime;
+        gettimeofday(&curTime, NULL);
+        return curTime.tv_sec + curTime.tv_usec*1e-6;
+        #else
+        return (double)std::clock()/CLOCKS_PER_SEC;
+        #endif
+    }
+
+    unsigned long long instructions;
+    unsigned long long cacheHits;
+    unsigned long long cacheMisses;
+    ///Instructions which reached the cache threshold and were stored in the decoded cache
+    unsigned long long cachePromotions;
+    unsigned long long quantumSyncs;
+    unsigned long long syscalls;
+    unsigned long long interrupts;
+    ///Host time, in seconds, measured in each phase for the sampled instructions
+    double phaseTime[PHASE_NUM];
+
+    PerfCounters(const std::string & name = "processor", unsigned int samplePeriodLog2 = 10) : name(name),
+                    sampleMask((1ULL << samplePeriodLog2) - 1), sampling(false), curPhase(PHASE_OTHER), phaseStart(0){
+        this->reset();
+        PerfCounters::getRegistry().push_back(this);
+    }
+    ~PerfCounters(){
+        std::vector<PerfCounters *> & registry = PerfCounters::getRegistry();
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    }
+    void setName(const std::string & name){
+        this->name = name;
+    }
+    ///Registers the counters of a port, so that they are exported together with the processor ones
+    void addPort(const std::string & name, const PortCounters & counters){
+        this->ports.push_back(std::pair<std::string, const PortCounters *>(name, &counters));
+    }
+    void reset(){
+        this->instructions = 0;
+        this->cacheHits = 0;
+        this->cacheMisses = 0;
+        this->cachePromotions = 0;
+        this->quantumSyncs = 0;
+        this->syscalls = 0;
+        this->interrupts = 0;
+        for(int i = 0; i < PHASE_NUM; i++){
+            this->phaseTime[i] = 0;
+        }
+        this->sampling = false;
+    }
+
+    ///Called at the beginning of each instruction: it counts the instruction
+    ///and decides whether its host time is measured
+    inline void startInstruction(){
+        this->instructions++;
+        this->sampling = (this->instructions & this->sampleMask) == 0;
+        this->curPhase = PHASE_FETCH_DECODE;
+        if(this->sampling){
+            this->phaseStart = PerfCounters::hostTime();
+        }
+    }
+    ///Switches to a new phase, returning the previous one
+    inline PerfPhase enterPhase(PerfPhase phase){
+        PerfPhase prevPhase = this->curPhase;
+        if(this->sampling){
+            double curTime = PerfCounters::hostTime();
+            this->phaseTime[this->curPhase] += curTime - this->phaseStart;
+            this->phaseStart = curTime;
+        }
+        this->curPhase = phase;
+        return prevPhase;
+    }
+    inline void endInstruction(){
+        this->enterPhase(PHASE_OTHER);
+        this->sampling = false;
+    }
+
+    void writeJSON(std::ostream & stream) const{
+        static const char * phaseNames[PHASE_NUM] = {"fetch_decode", "behavior", "tools", "syscalls", "other"};
+        double samplePeriod = (double)(this->sampleMask + 1);
+        stream << "{\"name\": \"" << this->name << "\", ";
+        stream << "\"instructions\": " << this->instructions << ", ";
+        stream << "\"decode_cache\": {\"hits\": " << this->cacheHits << ", \"misses\": " << this->cacheMisses << ", \"promotions\": " << this->cachePromotions << "}, ";
+        stream << "\"quantum_syncs\": " << this->quantumSyncs << ", ";
+        stream << "\"syscalls\": " << this->syscalls << ", ";
+        stream << "\"interrupts\": " << this->interrupts << ", ";
+        stream << "\"ports\": {";
+        std::vector<std::pair<std::string, const PortCounters *> >::const_iterator portIter, portEnd;
+        for(portIter = this->ports.begin(), portEnd = this->ports.end(); portIter != portEnd; portIter++){
+            if(portIter != this->ports.begin()){
+                stream << ", ";
+            }
+            stream << "\"" << portIter->first << "\": {\"dmi_hits\": " << portIter->second->dmiHits << ", \"transport_calls\": " << portIter->second->transportCalls << ", \"quantum_syncs\": " << portIter->second->quantumSyncs << "}";
+        }
+        stream << "}, ";
+        stream << "\"host_time\": {\"sample_period\": " << this->sampleMask + 1;
+        for(int i = 0; i < PHASE_NUM; i++){
+            stream << ", \"" << phaseNames[i] << "\": " << this->phaseTime[i]*samplePeriod;
+        }
+        stream << "}}";
+    }
+    std::string toJSON() const{
+        std::ostringstream stream;
+        this->writeJSON(stream);
+        return stream.str();
+    }
+    ///Returns the JSON document containing the counters of all the processors
+    static std::string dumpAll(){
+        std::ostringstream stream;
+        stream << "{\"processors\": [";
+        std::vector<PerfCounters *> & registry = PerfCounters::getRegistry();
+        for(unsigned int i = 0; i < registry.size(); i++){
+            if(i > 0){
+                stream << ", ";
+            }
+            registry[i]->writeJSON(stream);
+        }
+        stream << "]}\n";
+        return stream.str();
+    }
+};
+
+};
+
+#endif
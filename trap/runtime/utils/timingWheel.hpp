@@ -0,0 +1,101 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#ifndef TIMINGWHEEL_HPP
+#define TIMINGWHEEL_HPP
+
+#include <vector>
+
+#include "trap_utils.hpp"
+
+namespace trap{
+
+///Fixed size queue of elements scheduled a given number of cycles in the
+///future: slot i contains the elements due i cycles from now. The wheel is
+///advanced once per cycle; N must be a power of 2, greater than the maximum
+///delay. Since the slots are only cleared, after the first cycles no memory
+///allocation is performed any more.
+template<class T, unsigned int N> class TimingWheel{
+    private:
+    std::vector<T> slots[N];
+    unsigned int current;
+
+    public:
+    TimingWheel() : current(0){
+        if((N & (N - 1)) != 0){
+            THROW_ERROR("The size " << N << " of the timing wheel is not a power of 2");
+        }
+    }
+
+    ///Returns the elements scheduled delay cycles from now
+    inline std::vector<T> & operator[](const unsigned int & delay){
+        #ifndef NDEBUG
+        if(delay >= N){
+            THROW_ERROR("Delay " << delay << " exceeds the size " << N << " of the timing wheel");
+        }
+        #endif
+        return this->slots[(this->current + delay) & (N - 1)];
+    }
+
+    ///Returns the elements due in the current cycle
+    inline std::vector<T> & front() throw(){
+        return this->slots[this->current];
+    }
+
+    ///Discards the elements due in the current cycle and moves to the next one
+    inline void advance() throw(){
+        this->slots[this->current].clear();
+        this->current = (this->current + 1) & (N - 1);
+    }
+
+    ///Empties all the slots of the wheel
+    void clear() throw(){
+        for(unsigned int i = 0; i < N; i++){
+            this->slots[i].clear();
+        }
+        this->current = 0;
+    }
+};
+
+};
+
+#endif
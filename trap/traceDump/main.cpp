@@ -0,0 +1,252 @@
+/***************************************************************************\
+ *
+ *
+ *            ___        ___           ___           ___
+ *           /  /\      /  /\         /  /\         /  /\
+ *          /  /:/     /  /::\       /  /::\       /  /::\
+ *         /  /:/     /  /:/\:\     /  /:/\:\     /  /:/\:\
+ *        /  /:/     /  /:/~/:/    /  /:/~/::\   /  /:/~/:/
+ *       /  /::\    /__/:/ /:/___ /__/:/ /:/\:\ /__/:/ /:/
+ *      /__/:/\:\   \  \:\/:::::/ \  \:\/:/__\/ \  \:\/:/
+ *      \__\/  \:\   \  \::/~~~~   \  \::/       \  \::/
+ *           \  \:\   \  \:\        \  \:\        \  \:\
+ *            \  \ \   \  \:\        \  \:\        \  \:\
+ *             \__\/    \__\/         \__\/         \__\/
+ *
+ *
+ *
+ *
+ *   This file is part of TRAP.
+ *
+ *   TRAP is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation; either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *   or see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *   (c) Luca Fossati, fossati@elet.polimi.it, fossati.l@gmail.com
+ *
+\***************************************************************************/
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/program_options.hpp>
+
+#include "trap_utils.hpp"
+#include "binaryTrace.hpp"
+
+using namespace trap;
+
+///Converts a number, either in hex (0x prefix) or in decimal form
+unsigned long long toNum(const std::string & numStr){
+    char * endPtr = NULL;
+    unsigned long long value = strtoull(numStr.c_str(), &endPtr, 0);
+    if(numStr.empty() || *endPtr != '\0'){
+        THROW_EXCEPTION("Error, " << numStr << " is not a valid number");
+    }
+    return value;
+}
+
+///Computes, for each register of the trace, whether it has to be shown: a
+///register is selected when its name or the name of its bank
+///(e.g. REGS for REGS[3]) is among the requested ones
+std::vector<bool> selectRegisters(const std::vector<std::string> & regNames, const std::vector<std::string> & filter){
+    std::vector<bool> selected(regNames.size(), filter.empty());
+    std::set<std::string> filterSet(filter.begin(), filter.end());
+    for(unsigned int i = 0; i < regNames.size(); i++){
+        if(filterSet.find(regNames[i]) != filterSet.end() || filterSet.find(regNames[i].substr(0, regNames[i].find('['))) != filterSet.end()){
+            selected[i] = true;
+        }
+    }
+    return selected;
+}
+
+///Prints the traced instructions in the same format of the textual trace
+void dumpTrace(BinaryTraceReader & reader, unsigned long long startPC, unsigned long long endPC, const std::vector<bool> & selected, bool filterRegs, bool allRegs){
+    const std::vector<std::string> & regNames = reader.getRegNames();
+    const std::vector<unsigned long long> & regValues = reader.getRegValues();
+    TraceRecord record;
+    while(reader.next(record)){
+        if(record.pc < startPC || record.pc > endPC){
+            continue;
+        }
+        bool writesSelected = false;
+        std::vector<std::pair<unsigned int, unsigned long long> >::const_iterator regIter, regEnd;
+        for(regIter = record.regs.begin(), regEnd = record.regs.end(); regIter != regEnd && !writesSelected; regIter++){
+            writesSelected = selected[regIter->first];
+        }
+        if(filterRegs && !writesSelected){
+            continue;
+        }
+        std::cout << "PC: " << std::hex << std::showbase << record.pc << std::endl;
+        std::cout << "Instruction: " << reader.getInstrName(record.instrId) << std::endl;
+        if(allRegs){
+            for(unsigned int i = 0; i < regNames.size(); i++){
+                if(selected[i]){
+                    std::cout << regNames[i] << " = " << std::hex << std::showbase << regValues[i] << std::endl;
+                }
+            }
+        }
+        else{
+            for(regIter = record.regs.begin(), regEnd = record.regs.end(); regIter != regEnd; regIter++){
+                if(selected[regIter->first]){
+                    std::cout << regNames[regIter->first] << " = " << std::hex << std::showbase << regIter->second << std::endl;
+                }
+            }
+        }
+        if(record.skipped){
+            std::cout << "Skipped Instruction " << reader.getInstrName(record.instrId) << std::endl;
+        }
+        std::cout << std::endl;
+    }
+}
+
+///Compares two traces instruction by instruction, reporting the PCs,
+///instructions and values of the selected registers which differ; registers
+///are matched by name, so that the two traces can come from different
+///simulators. Returns the number of differences found
+unsigned int diffTraces(BinaryTraceReader & reader, BinaryTraceReader & refReader, unsigned long long startPC, unsigned long long endPC, const std::vector<bool> & selected, unsigned int maxDiffs){
+    const std::vector<std::string> & regNames = reader.getRegNames();
+    std::map<std::string, unsigned int> refRegIndex;
+    for(unsigned int i = 0; i < refReader.getRegNames().size(); i++){
+        refRegIndex[refReader.getRegNames()[i]] = i;
+    }
+    std::vector<std::pair<unsigned int, unsigned int> > comparedRegs;
+    for(unsigned int i = 0; i < regNames.size(); i++){
+        std::map<std::string, unsigned int>::const_iterator refFound = refRegIndex.find(regNames[i]);
+        if(selected[i] && refFound != refRegIndex.end()){
+            comparedRegs.push_back(std::pair<unsigned int, unsigned int>(i, refFound->second));
+        }
+    }
+
+    unsigned int numDiffs = 0;
+    unsigned long long recordNum = 0;
+    TraceRecord record, refRecord;
+    while(numDiffs < maxDiffs){
+        bool hasRecord = reader.next(record);
+        bool hasRefRecord = refReader.next(refRecord);
+        if(!hasRecord || !hasRefRecord){
+            if(hasRecord != hasRefRecord){
+                std::cout << "Record " << std::dec << recordNum << ": trace " << (hasRecord ? "2" : "1") << " ended" << std::endl;
+                numDiffs++;
+            }
+            break;
+        }
+        recordNum++;
+        if(record.pc < startPC || record.pc > endPC){
+            continue;
+        }
+        bool differs = false;
+        if(record.pc != refRecord.pc){
+            std::cout << "Record " << std::dec << recordNum << ": PC " << std::hex << std::showbase << record.pc << " != " << refRecord.pc << std::endl;
+            differs = true;
+        }
+        std::string instrName = reader.getInstrName(record.instrId);
+        std::string refInstrName = refReader.getInstrName(refRecord.instrId);
+        if(instrName != refInstrName || record.skipped != refRecord.skipped){
+            std::cout << "Record " << std::dec << recordNum << ": instruction " << instrName << (record.skipped ? " (skipped)" : "") << " != " << refInstrName << (refRecord.skipped ? " (skipped)" : "") << std::endl;
+            differs = true;
+        }
+        std::vector<std::pair<unsigned int, unsigned int> >::const_iterator regIter, regEnd;
+        for(regIter = comparedRegs.begin(), regEnd = comparedRegs.end(); regIter != regEnd; regIter++){
+            unsigned long long value = reader.getRegValues()[regIter->first];
+            unsigned long long refValue = refReader.getRegValues()[regIter->second];
+            if(value != refValue){
+                std::cout << "Record " << std::dec << recordNum << " (PC " << std::hex << std::showbase << record.pc << "): " << regNames[regIter->first] << " = " << value << " != " << refValue << std::endl;
+                differs = true;
+            }
+        }
+        if(differs){
+            numDiffs++;
+        }
+    }
+    return numDiffs;
+}
+
+int main(int argc, char *argv[]){
+    boost::program_options::options_description desc("Binary Trace Dump");
+    desc.add_options()
+    ("help,h", "produces the help message")
+    ("trace,t", boost::program_options::value<std::string>(), "the binary trace file produced by the simulator")
+    ("diff,d", boost::program_options::value<std::string>(), "a second binary trace file to be compared with the first one")
+    ("pc_range,p", boost::program_options::value<std::string>(), "only considers the instructions whose PC is in the range start-end (e.g. 0x40000000-0x40001000)")
+    ("register,r", boost::program_options::value<std::vector<std::string> >()->multitoken(), "only considers the specified registers (either a single register, e.g. REGS[3], or a whole bank, e.g. REGS); when dumping, only the instructions which modify them are shown")
+    ("all_registers,a", "prints the value of all the (selected) registers for each instruction instead of the modified ones")
+    ("max_diffs,m", boost::program_options::value<unsigned int>(), "the number of differences after which the comparison stops [default 1]")
+    ;
+
+    boost::program_options::variables_map vm;
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    boost::program_options::notify(vm);
+
+    // Checking that the parameters are correctly specified
+    if(vm.count("help") != 0){
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    if(vm.count("trace") == 0){
+        std::cerr << "Error, it is necessary to specify the name of the trace file" << std::endl;
+        std::cerr << desc << std::endl;
+        return -1;
+    }
+    unsigned long long startPC = 0;
+    unsigned long long endPC = (unsigned long long)-1;
+    if(vm.count("pc_range") > 0){
+        std::string pcRange = vm["pc_range"].as<std::string>();
+        std::string::size_type separator = pcRange.find('-');
+        if(separator == std::string::npos){
+            std::cerr << "Error, the PC range has to be specified as start-end" << std::endl;
+            return -1;
+        }
+        startPC = toNum(pcRange.substr(0, separator));
+        endPC = toNum(pcRange.substr(separator + 1));
+    }
+    std::vector<std::string> regFilter;
+    if(vm.count("register") > 0){
+        regFilter = vm["register"].as<std::vector<std::string> >();
+    }
+    unsigned int maxDiffs = 1;
+    if(vm.count("max_diffs") > 0){
+        maxDiffs = vm["max_diffs"].as<unsigned int>();
+    }
+
+    // The readers throw an exception when a trace cannot be opened or is corrupted
+    try{
+        BinaryTraceReader reader(vm["trace"].as<std::string>());
+        std::vector<bool> selected = selectRegisters(reader.getRegNames(), regFilter);
+        if(vm.count("diff") == 0){
+            dumpTrace(reader, startPC, endPC, selected, !regFilter.empty(), vm.count("all_registers") > 0);
+            return 0;
+        }
+        BinaryTraceReader refReader(vm["diff"].as<std::string>());
+        unsigned int numDiffs = diffTraces(reader, refReader, startPC, endPC, selected, maxDiffs);
+        if(numDiffs == 0){
+            std::cout << "The traces are identical" << std::endl;
+            return 0;
+        }
+    }
+    catch(std::exception & e){
+        std::cout << std::flush;
+        std::cerr << "Error in reading the trace: " << e.what() << std::endl;
+        return -1;
+    }
+    return 1;
+}